@@ -27,9 +27,22 @@
 
 #include "vulkan/vk_layer.h"
 #include "vk_layer_table.h"
+#include "api_dump_record_queue.h"
+#include "api_dump_binary.h"
+#include "api_dump_clock.h"
+#include "api_dump_command_buffers.h"
+#include "api_dump_compressed_stream.h"
+#include "api_dump_flight_recorder.h"
+#include "api_dump_format_buffer.h"
+#include "api_dump_mapped_file.h"
+#include "api_dump_object_names.h"
+#include "api_dump_pipeline_profile.h"
+#include "api_dump_spirv.h"
+#include "api_dump_statistics.h"
 #include <vulkan/utility/vk_dispatch_table.h>
 
 #include <vulkan/layer/vk_layer_settings.hpp>
+#include <vulkan/vk_enum_string_helper.h>
 
 // Include the video headers so we can print types that come from them
 #include "vk_video/vulkan_video_codecs_common.h"
@@ -42,26 +55,31 @@
 #include "vk_video/vulkan_video_codec_av1std.h"
 #include "vk_video/vulkan_video_codec_av1std_decode.h"
 
+#include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 
 #include <algorithm>
+#include <charconv>
+#include <atomic>
 #include <cassert>
+#include <cmath>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <mutex>
-#include <iomanip>
 #include <iostream>
 #include <ostream>
-#include <sstream>
 #include <string>
 #include <type_traits>
 #include <map>
-#include <set>
+#include <iterator>
 #include <thread>
 #include <unordered_map>
 #include <vector>
-#include <unordered_set>
 #include <utility>
 
 #if defined(_WIN32) && !defined(NDEBUG)
@@ -107,16 +125,46 @@ EXPORT_FUNCTION VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkD
 #define kSettingsKeyDetailedOutput "detailed"
 #define kSettingsKeyNoAddr "no_addr"
 #define kSettingsKeyFlush "flush"
+#define kSettingsKeyFlushInterval "flush_interval"
+#define kSettingsKeyCompression "compression"
+#define kSettingsKeyMemoryMapped "memory_mapped"
+#define kSettingsKeyRotateSize "rotate_size"
+#define kSettingsKeyRotateFrames "rotate_frames"
+#define kSettingsKeyRotateMaxFiles "rotate_max_files"
 #define kSettingsKeyPreDump "pre_dump"
 #define kSettingsKeyOutputRange "output_range"
 #define kSettingsKeyTimestamp "timestamp"
+#define kSettingsKeyTimestampClock "timestamp_clock"
 #define kSettingsKeyIndentSize "indent_size"
 #define kSettingsKeyShowTypes "show_types"
 #define kSettingsKeyNameSize "name_size"
 #define kSettingsKeyTypeSize "type_size"
 #define kSettingsKeyUseSpaces "use_spaces"
 #define kSettingsKeyShowShader "show_shader"
+#define kSettingsKeySaveShaders "save_shaders"
+#define kSettingsKeyPipelineProfile "pipeline_profile"
+#define kSettingsKeyPipelineProfileFile "pipeline_profile_file"
+#define kSettingsKeyPipelineProfileCount "pipeline_profile_count"
 #define kSettingsKeyShowThreadAndFrame "show_thread_and_frame"
+#define kSettingsKeyBufferRecords "buffer_records"
+#define kSettingsKeyAsyncOutput "async_output"
+#define kSettingsKeyAsyncQueueSize "async_queue_size"
+#define kSettingsKeyAsyncQueueFullPolicy "async_queue_full_policy"
+#define kSettingsKeyIncludeFunctions "include_functions"
+#define kSettingsKeyExcludeFunctions "exclude_functions"
+#define kSettingsKeySamplingInterval "sampling_interval"
+#define kSettingsKeySamplingMaxCallsPerFrame "sampling_max_calls_per_frame"
+#define kSettingsKeySamplingFrameBudget "sampling_frame_budget"
+#define kSettingsKeyStatistics "statistics"
+#define kSettingsKeyStatisticsInterval "statistics_interval"
+#define kSettingsKeyFlightRecorder "flight_recorder"
+#define kSettingsKeyFlightRecorderSize "flight_recorder_size"
+#define kSettingsKeyFlightRecorderCalls "flight_recorder_calls"
+#define kSettingsKeyFlightRecorderFrames "flight_recorder_frames"
+#define kSettingsKeyFlightRecorderResults "flight_recorder_results"
+#define kSettingsKeyFlightRecorderSignal "flight_recorder_signal"
+#define kSettingsKeyFlightRecorderTriggerFile "flight_recorder_trigger_file"
+#define kSettingsKeyFlightRecorderDumpOnExit "flight_recorder_dump_on_exit"
 
 // We want to dump all extensions even beta extensions.
 #ifndef VK_ENABLE_BETA_EXTENSIONS
@@ -161,8 +209,49 @@ enum class ApiDumpFormat {
     Text,
     Html,
     Json,
+    Binary,
+    Trace,
 };
 
+// The settings that every dumped call and every dumped parameter test, as bits. The generated functions take them as a template
+// parameter, next to the format, so that a combination of them can get functions of their own where the tests are constants the
+// compiler folds away. kApiDumpFeaturesRuntime gets the functions that read the settings, which the layer uses for all of them.
+using ApiDumpFeatures = uint32_t;
+static const ApiDumpFeatures kApiDumpFeatureShowType = 1u << 0;        // show_type
+static const ApiDumpFeatures kApiDumpFeatureShowAddress = 1u << 1;     // !no_addr
+static const ApiDumpFeatures kApiDumpFeatureDetailed = 1u << 2;        // detailed
+static const ApiDumpFeatures kApiDumpFeatureThreadAndFrame = 1u << 3;  // show_thread_and_frame
+static const ApiDumpFeatures kApiDumpFeatureTimestamp = 1u << 4;       // timestamp
+static const ApiDumpFeatures kApiDumpFeaturePreDump = 1u << 5;         // pre_dump
+static const ApiDumpFeatures kApiDumpFeaturesRuntime = 1u << 31;
+static const ApiDumpFeatures kApiDumpFeaturesDefault =
+    kApiDumpFeatureShowType | kApiDumpFeatureShowAddress | kApiDumpFeatureDetailed | kApiDumpFeatureThreadAndFrame;
+
+// The value of a setting in the functions specialized for Features: the feature bit, or the setting itself for the functions
+// that read the settings.
+template <ApiDumpFeatures Features, ApiDumpFeatures Feature>
+constexpr bool api_dump_feature(bool setting) {
+    if constexpr ((Features & kApiDumpFeaturesRuntime) != 0) {
+        return setting;
+    } else {
+        return (Features & Feature) != 0;
+    }
+}
+
+// Process id of the events of the trace output format, which only holds the calls of one process.
+static const int kTraceProcessId = 1;
+
+// What an application thread does when the asynchronous output queue is full.
+enum class QueueFullPolicy {
+    Block,  // Wait for the writer thread to make room.
+    Drop,   // Discard the record and count it.
+};
+
+// Identifies an API function. Defined in the generated api_dump_capture.h, along with these helpers.
+enum class ApiDumpFunctionId : uint32_t;
+inline uint32_t api_dump_function_count();
+inline const char *api_dump_function_name(ApiDumpFunctionId function);
+
 static const uint64_t OUTPUT_RANGE_UNLIMITED = 0;
 static const uint64_t OUTPUT_RANGE_INTERVAL_DEFAULT = 1;
 
@@ -174,9 +263,22 @@ struct FrameRange {
 
 class ConditionalFrameOutput {
     bool use_conditional_output = false;
-    std::set<uint64_t> frames;
+    std::vector<uint64_t> frames;
     std::vector<FrameRange> ranges;
 
+    // Matcher compiled from frames and ranges once parsing succeeded, so that isFrameInRange() is cheap however long the
+    // application runs. Consecutive frames are merged into sorted, disjoint spans, and only ranges with an interval are
+    // tested one by one.
+    struct FrameSpan {
+        uint64_t begin;     // First frame of the span
+        uint64_t end;       // Frame after the last one of the span, UINT64_MAX if unlimited
+        uint64_t interval;  // Rate at which frames of the span are dumped
+    };
+    std::vector<FrameSpan> spans;
+    std::vector<FrameSpan> interval_spans;
+    uint64_t first_frame = UINT64_MAX;  // No frame before this one is in range
+    uint64_t end_frame = 0;             // No frame from this one on is in range
+
     struct NumberToken {
         uint64_t value;
         uint32_t length;
@@ -203,14 +305,41 @@ class ConditionalFrameOutput {
 #endif
     }
 
-   public:
-    /* Parses a string for a comma seperated list of frames & frame ranges
-     * where frames are singular integers and frame ranges are of the following
-     * format: "S-C-I" with S is the start frame, C is the count of frames to dump,
-     * and I the interval between dumped frames.
-     * Valid range strings: "2,3,5", "4-4-2", "3-6, 10-2"
-     */
-    bool parseConditionalFrameRange(std::string range_str) {
+    static uint64_t saturatingAdd(uint64_t a, uint64_t b) { return a > UINT64_MAX - b ? UINT64_MAX : a + b; }
+
+    void compileMatcher() {
+        std::vector<FrameSpan> consecutive;
+        for (uint64_t frame : frames) {
+            consecutive.push_back(FrameSpan{frame, saturatingAdd(frame, 1), OUTPUT_RANGE_INTERVAL_DEFAULT});
+        }
+        for (const auto &range : ranges) {
+            const uint64_t end =
+                range.frame_count == OUTPUT_RANGE_UNLIMITED ? UINT64_MAX : saturatingAdd(range.start_frame, range.frame_count);
+            if (range.interval <= OUTPUT_RANGE_INTERVAL_DEFAULT) {
+                consecutive.push_back(FrameSpan{range.start_frame, end, OUTPUT_RANGE_INTERVAL_DEFAULT});
+            } else {
+                interval_spans.push_back(FrameSpan{range.start_frame, end, range.interval});
+            }
+            first_frame = std::min(first_frame, range.start_frame);
+            end_frame = std::max(end_frame, end);
+        }
+
+        std::sort(consecutive.begin(), consecutive.end(),
+                  [](const FrameSpan &a, const FrameSpan &b) { return a.begin < b.begin; });
+        for (const auto &span : consecutive) {
+            if (!spans.empty() && span.begin <= spans.back().end) {
+                spans.back().end = std::max(spans.back().end, span.end);
+            } else {
+                spans.push_back(span);
+            }
+        }
+        if (!spans.empty()) {
+            first_frame = std::min(first_frame, spans.front().begin);
+            end_frame = std::max(end_frame, spans.back().end);
+        }
+    }
+
+    bool parseRanges(const std::string &range_str) {
         uint32_t current_char = 0;
 
         if (range_str.empty()) {
@@ -274,7 +403,7 @@ class ConditionalFrameOutput {
                 }
             } else {
                 // Single frame capture
-                frames.insert(frame_number.value);
+                frames.push_back(frame_number.value);
             }
             if (range_str[current_char] == ',') {
                 current_char++;
@@ -284,35 +413,143 @@ class ConditionalFrameOutput {
         return true;
     }
 
-    // Return true if either use_conditional_output is false or if frame_count is within
+   public:
+    /* Parses a string for a comma seperated list of frames & frame ranges
+     * where frames are singular integers and frame ranges are of the following
+     * format: "S-C-I" with S is the start frame, C is the count of frames to dump,
+     * and I the interval between dumped frames.
+     * Valid range strings: "2,3,5", "4-4-2", "3-6, 10-2"
+     */
+    bool parseConditionalFrameRange(const std::string &range_str) {
+        if (!parseRanges(range_str)) {
+            return false;
+        }
+        compileMatcher();
+        return true;
+    }
+
+    // Return true if either use_conditional_output is false or if frame_number is within
     // the provided frame ranges
     bool isFrameInRange(uint64_t frame_number) const {
         if (!use_conditional_output) return true;
-        for (auto &range : ranges) {
-            if (range.start_frame <= frame_number) {
-                if (range.frame_count == OUTPUT_RANGE_UNLIMITED) {
-                    if (range.interval == OUTPUT_RANGE_INTERVAL_DEFAULT) {
-                        return true;
-                    } else {
-                        return (frame_number - range.start_frame) % range.interval == 0;
-                    }
+        if (frame_number < first_frame || frame_number >= end_frame) return false;
 
-                } else if (range.start_frame + range.frame_count > frame_number) {
-                    if (range.interval == OUTPUT_RANGE_INTERVAL_DEFAULT) {
-                        return true;
-                    } else {
-                        return (frame_number - range.start_frame) % range.interval == 0;
-                    }
-                }
-            }
-        }
-        if (frames.count(frame_number) > 0) {
+        auto span = std::upper_bound(spans.begin(), spans.end(), frame_number,
+                                     [](uint64_t frame, const FrameSpan &s) { return frame < s.begin; });
+        if (span != spans.begin() && frame_number < std::prev(span)->end) {
             return true;
         }
+        for (const auto &interval_span : interval_spans) {
+            if (interval_span.begin <= frame_number && frame_number < interval_span.end &&
+                (frame_number - interval_span.begin) % interval_span.interval == 0) {
+                return true;
+            }
+        }
         return false;
     }
 };
 
+// Selects the functions that are dumped from the include_functions and exclude_functions settings. Entries are function names,
+// globs where '*' matches any run of characters and '?' any single character, or one of the categories below. When
+// include_functions is empty, every function is included.
+class FunctionFilter {
+    struct Category {
+        const char *name;
+        std::vector<const char *> patterns;
+    };
+
+    static const std::vector<Category> &categories() {
+        static const std::vector<Category> list = {
+            {"command_recording", {"vkCmd*", "vkBeginCommandBuffer", "vkEndCommandBuffer", "vkResetCommandBuffer"}},
+            {"queue", {"vkQueue*"}},
+            {"sync", {"*Fence*", "*Semaphore*", "*Event*", "vkCmdPipelineBarrier*", "vkDeviceWaitIdle", "vkQueueWaitIdle"}},
+            {"memory", {"*Memory*"}},
+            {"descriptor", {"*Descriptor*"}},
+            {"pipeline", {"vkCreate*Pipeline*", "vkDestroyPipeline*", "vkGetPipeline*", "vkMergePipelineCaches", "*Shader*"}},
+            {"wsi",
+             {"*Surface*", "*Swapchain*", "*Display*", "vkQueuePresentKHR", "vkAcquireNextImage*", "vkWaitForPresent*",
+              "vkGetPastPresentationTimingGOOGLE", "vkGetRefreshCycleDurationGOOGLE"}},
+        };
+        return list;
+    }
+
+    static bool globMatch(const char *pattern, const char *name) {
+        const char *star = nullptr;
+        const char *star_name = nullptr;
+        while (*name != '\0') {
+            if (*pattern == '*') {
+                star = pattern++;
+                star_name = name;
+            } else if (*pattern == '?' || *pattern == *name) {
+                ++pattern;
+                ++name;
+            } else if (star != nullptr) {
+                // Let the last '*' match one more character
+                pattern = star + 1;
+                name = ++star_name;
+            } else {
+                return false;
+            }
+        }
+        while (*pattern == '*') {
+            ++pattern;
+        }
+        return *pattern == '\0';
+    }
+
+    static std::vector<std::string> compile(const std::vector<std::string> &entries) {
+        std::vector<std::string> patterns;
+        for (const auto &entry : entries) {
+            const size_t begin = entry.find_first_not_of(" \t");
+            if (begin == std::string::npos) continue;
+            const std::string trimmed = entry.substr(begin, entry.find_last_not_of(" \t") - begin + 1);
+
+            auto category = std::find_if(categories().begin(), categories().end(),
+                                         [&](const Category &c) { return trimmed == c.name; });
+            if (category != categories().end()) {
+                patterns.insert(patterns.end(), category->patterns.begin(), category->patterns.end());
+            } else {
+                patterns.push_back(trimmed);
+            }
+        }
+        return patterns;
+    }
+
+    static bool matchesAny(const std::vector<std::string> &patterns, const char *name) {
+        return std::any_of(patterns.begin(), patterns.end(), [&](const std::string &p) { return globMatch(p.c_str(), name); });
+    }
+
+    std::vector<std::string> include_patterns;
+    std::vector<std::string> exclude_patterns;
+
+   public:
+    void init(const std::vector<std::string> &include_functions, const std::vector<std::string> &exclude_functions) {
+        include_patterns = compile(include_functions);
+        exclude_patterns = compile(exclude_functions);
+    }
+
+    bool isFunctionDumped(const char *name) const {
+        if (!include_patterns.empty() && !matchesAny(include_patterns, name)) return false;
+        return !matchesAny(exclude_patterns, name);
+    }
+};
+
+// Limits on the calls of each function that are dumped in the frames output_range selects, for applications that make too
+// many calls to dump them all. A call is dumped only if none of the limits leaves it out.
+struct SamplingSettings {
+    uint32_t interval = 1;             // Dump one in every interval calls of each function.
+    uint32_t max_calls_per_frame = 0;  // Dump at most this many calls of each function per frame, 0 for no limit.
+    uint64_t frame_budget_ns = 0;      // Stop dumping for the rest of the frame once dumped calls took this long, 0 for no limit.
+
+    bool enabled() const { return interval > 1 || max_calls_per_frame > 0 || frame_budget_ns > 0; }
+};
+
+// Number of calls of a function that sampling left out of a frame.
+struct SuppressedCalls {
+    ApiDumpFunctionId function;
+    uint64_t count;
+};
+
 #ifdef __ANDROID__
 template <class char_type = char, class traits = std::char_traits<char_type>>
 class AndroidLogcatBuf final : public std::basic_streambuf<char_type, traits> {
@@ -414,50 +651,39 @@ class ApiDumpSettings {
     }
 
     ~ApiDumpSettings() {
-        if (output_format == ApiDumpFormat::Html) {
-            // Close off html
-            output_stream << "</details></div></body></html>";
-        } else if (output_format == ApiDumpFormat::Json) {
-            // Close off json
-            output_stream << "\n]" << std::endl;
-        }
+        // The last frame was closed off by ApiDumpInstance
+        writeFileTrailer();
+        flushOutput(true);
     }
 
-    void setupInterFrameOutputFormatting(uint64_t frame_count) const /*name change? */
-    {
-        static bool hasPrintedAFrame = false;
+    // Starts the output of a frame in the output range.
+    void openFrameOutput(uint64_t frame_count) const {
         switch (format()) {
             case (ApiDumpFormat::Html):
-                if (frame_count > 0) {
-                    if (condFrameOutput.isFrameInRange(frame_count - 1)) output_stream << "</details>";
-                }
-                if (condFrameOutput.isFrameInRange(frame_count)) {
-                    output_stream << "<details class='frm'><summary>Frame ";
-                    if (show_thread_and_frame) {
-                        output_stream << frame_count;
-                    }
-                    output_stream << "</summary>";
+                output_buffer << "<details class='frm'><summary>Frame ";
+                if (show_thread_and_frame) {
+                    output_buffer << frame_count;
                 }
+                output_buffer << "</summary>";
                 break;
 
             case (ApiDumpFormat::Json):
-
-                if (frame_count > 0) {
-                    if (condFrameOutput.isFrameInRange(frame_count - 1)) output_stream << "\n" << indentation(1) << "]\n}";
+                // Every JSON Lines call has the frame it was made in
+                if (json_lines) {
+                    open_frame = frame_count;
+                    break;
                 }
-                if (condFrameOutput.isFrameInRange(frame_count)) {
-                    if (!hasPrintedAFrame) {
-                        hasPrintedAFrame = true;
-                    } else {
-                        output_stream << ",\n";
-                    }
-                    output_stream << "{\n";
-                    if (show_thread_and_frame) {
-                        output_stream << indentation(1) << "\"frameNumber\" : \"" << frame_count << "\",\n";
-                    }
-                    output_stream << indentation(1) << "\"apiCalls\" :\n";
-                    output_stream << indentation(1) << "[\n";
+                if (!frame_output_written) {
+                    frame_output_written = true;
+                } else {
+                    output_buffer << ",\n";
                 }
+                output_buffer << "{\n";
+                if (show_thread_and_frame) {
+                    output_buffer << indentation(1) << "\"frameNumber\" : \"" << frame_count << "\",\n";
+                }
+                output_buffer << indentation(1) << "\"apiCalls\" :\n";
+                output_buffer << indentation(1) << "[\n";
                 break;
             case (ApiDumpFormat::Text):
                 break;
@@ -466,69 +692,343 @@ class ApiDumpSettings {
         }
     }
 
-    void closeFrameOutput() const {
+    // Ends the output of a frame opened by openFrameOutput(), with the calls sampling left out of it.
+    void closeFrameOutput(const std::vector<SuppressedCalls> &suppressed) const {
         switch (format()) {
             case (ApiDumpFormat::Html):
-                output_stream << "</details>";
+                if (!suppressed.empty()) {
+                    output_buffer << "<details class='fn'><summary><div class='var'>Suppressed calls</div></summary>";
+                    for (const SuppressedCalls &calls : suppressed) {
+                        output_buffer << "<div class='var'>" << api_dump_function_name(calls.function) << ": " << calls.count
+                                      << "</div>";
+                    }
+                    output_buffer << "</details>";
+                }
+                output_buffer << "</details>";
                 break;
             case (ApiDumpFormat::Json):
-                output_stream << "\n" << indentation(1) << "]\n}";
+                if (json_lines) {
+                    if (!suppressed.empty()) {
+                        output_buffer << "{\"frame\":" << open_frame << ",\"suppressedCalls\":{";
+                        for (size_t i = 0; i < suppressed.size(); ++i) {
+                            if (i > 0) output_buffer << ',';
+                            output_buffer << '"' << api_dump_function_name(suppressed[i].function) << "\":" << suppressed[i].count;
+                        }
+                        output_buffer << "}}\n";
+                    }
+                    break;
+                }
+                output_buffer << "\n" << indentation(1) << "]";
+                if (!suppressed.empty()) {
+                    output_buffer << ",\n" << indentation(1) << "\"suppressedCalls\" :\n" << indentation(1) << "{\n";
+                    for (size_t i = 0; i < suppressed.size(); ++i) {
+                        if (i > 0) output_buffer << ",\n";
+                        output_buffer << indentation(2) << "\"" << api_dump_function_name(suppressed[i].function) << "\" : \""
+                                      << suppressed[i].count << "\"";
+                    }
+                    output_buffer << "\n" << indentation(1) << "}";
+                }
+                output_buffer << "\n}";
                 break;
             case (ApiDumpFormat::Text):
+                if (!suppressed.empty()) {
+                    output_buffer << "Suppressed calls:\n";
+                    for (const SuppressedCalls &calls : suppressed) {
+                        output_buffer << indentation(1) << api_dump_function_name(calls.function) << ": " << calls.count << "\n";
+                    }
+                    output_buffer << "\n";
+                }
                 break;
             default:
                 break;
         }
     }
 
+    // Writes the statistics of the calls made in frames first_frame to last_frame.
+    void writeStatistics(uint64_t first_frame, uint64_t last_frame, const std::vector<ApiDumpFunctionStatistics> &summary) const {
+        if (format() == ApiDumpFormat::Json && json_lines) {
+            output_buffer << "{\"firstFrame\":" << first_frame << ",\"lastFrame\":" << last_frame << ",\"functions\":[";
+            for (size_t i = 0; i < summary.size(); ++i) {
+                const ApiDumpFunctionStatistics &stats = summary[i];
+                if (i > 0) output_buffer << ',';
+                output_buffer << "{\"name\":\"" << api_dump_function_name(static_cast<ApiDumpFunctionId>(stats.function))
+                              << "\",\"calls\":" << stats.calls << ",\"totalUs\":" << ApiDumpMicroseconds(stats.total_ns).text
+                              << ",\"minUs\":" << ApiDumpMicroseconds(stats.min_ns).text
+                              << ",\"p50Us\":" << ApiDumpMicroseconds(stats.p50_ns).text
+                              << ",\"p99Us\":" << ApiDumpMicroseconds(stats.p99_ns).text
+                              << ",\"maxUs\":" << ApiDumpMicroseconds(stats.max_ns).text << '}';
+            }
+            output_buffer << "]}\n";
+        } else if (format() == ApiDumpFormat::Json) {
+            if (statistics_written) {
+                output_buffer << ",\n";
+            }
+            output_buffer << "{\n";
+            output_buffer << indentation(1) << "\"firstFrame\" : \"" << first_frame << "\",\n";
+            output_buffer << indentation(1) << "\"lastFrame\" : \"" << last_frame << "\",\n";
+            output_buffer << indentation(1) << "\"functions\" :\n";
+            output_buffer << indentation(1) << "[\n";
+            for (size_t i = 0; i < summary.size(); ++i) {
+                const ApiDumpFunctionStatistics &stats = summary[i];
+                if (i > 0) output_buffer << ",\n";
+                output_buffer << indentation(2) << "{\n";
+                output_buffer << indentation(3) << "\"name\" : \""
+                              << api_dump_function_name(static_cast<ApiDumpFunctionId>(stats.function)) << "\",\n";
+                output_buffer << indentation(3) << "\"calls\" : \"" << stats.calls << "\",\n";
+                output_buffer << indentation(3) << "\"totalUs\" : \"" << ApiDumpMicroseconds(stats.total_ns).text << "\",\n";
+                output_buffer << indentation(3) << "\"minUs\" : \"" << ApiDumpMicroseconds(stats.min_ns).text << "\",\n";
+                output_buffer << indentation(3) << "\"p50Us\" : \"" << ApiDumpMicroseconds(stats.p50_ns).text << "\",\n";
+                output_buffer << indentation(3) << "\"p99Us\" : \"" << ApiDumpMicroseconds(stats.p99_ns).text << "\",\n";
+                output_buffer << indentation(3) << "\"maxUs\" : \"" << ApiDumpMicroseconds(stats.max_ns).text << "\"\n";
+                output_buffer << indentation(2) << "}";
+            }
+            output_buffer << "\n" << indentation(1) << "]\n}";
+        } else {
+            int name_width = 8;
+            for (const ApiDumpFunctionStatistics &stats : summary) {
+                const char *name = api_dump_function_name(static_cast<ApiDumpFunctionId>(stats.function));
+                name_width = std::max(name_width, static_cast<int>(strlen(name)));
+            }
+            char line[256];
+            output_buffer << "Statistics of frames " << first_frame << " to " << last_frame << ":\n";
+            snprintf(line, sizeof(line), "%-*s %10s %12s %10s %10s %10s %10s\n", name_width, "Function", "Calls", "Total (us)",
+                     "Min (us)", "p50 (us)", "p99 (us)", "Max (us)");
+            output_buffer << line;
+            for (const ApiDumpFunctionStatistics &stats : summary) {
+                snprintf(line, sizeof(line), "%-*s %10" PRIu64 " %12s %10s %10s %10s %10s\n", name_width,
+                         api_dump_function_name(static_cast<ApiDumpFunctionId>(stats.function)), stats.calls,
+                         ApiDumpMicroseconds(stats.total_ns).text, ApiDumpMicroseconds(stats.min_ns).text,
+                         ApiDumpMicroseconds(stats.p50_ns).text, ApiDumpMicroseconds(stats.p99_ns).text,
+                         ApiDumpMicroseconds(stats.max_ns).text);
+                output_buffer << line;
+            }
+            output_buffer << "\n";
+        }
+        statistics_written = true;
+    }
+
     ApiDumpFormat format() const { return output_format; }
 
+    // JSON Lines output is the json format with one minified object per line for each call, and numbers written as numbers.
+    bool jsonLines() const { return json_lines; }
+
+    template <ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
     void formatNameType(int indents, const char *name, const char *type) const {
-        output_stream << indentation(indents) << name << ": ";
-        // We have to 'print' an empty string for the setw to actually add the desired padding.
+        FormatBuffer &out = stream();
+        out << indentation(indents) << name << ": ";
+        const int name_length = static_cast<int>(strlen(name));
         if (use_spaces)
-            output_stream << std::setw(name_size - (int)strlen(name) - 2) << "";
+            out << FormatPadding{name_size - name_length - 2, padding_fill};
         else
-            output_stream << std::setw((name_size - (int)strlen(name) - 3 + tab_size) / tab_size) << "";
+            out << FormatPadding{(name_size - name_length - 3 + tab_size) / tab_size, padding_fill};
 
-        if (show_type) {
+        if (showType<Features>()) {
+            const int type_length = static_cast<int>(strlen(type));
             if (use_spaces)
-                output_stream << std::left << std::setw(type_size) << type << " = ";
+                out << type << FormatPadding{type_size - type_length, padding_fill} << " = ";
             else
-                output_stream << type << std::setw((type_size - (int)strlen(type) - 1 + tab_size) / tab_size) << "" << " = ";
+                out << type << FormatPadding{(type_size - type_length - 1 + tab_size) / tab_size, padding_fill} << " = ";
         } else {
-            output_stream << " = ";
+            out << " = ";
         }
     }
 
-    inline const char *indentation(int indents) const {
-        // We have to 'print' an empty string for the setw to actually add the desired padding.
-        output_stream << std::setw(indents * indent_size) << "";
-        return "";
-    }
+    FormatPadding indentation(int indents) const { return {indents * indent_size, padding_fill}; }
 
     bool shouldFlush() const { return should_flush; }
 
+    // Milliseconds between flushes of the output stream, 0 to flush after every call when flushing is enabled.
+    uint32_t flushInterval() const { return flush_interval; }
+
+    OutputCompression compression() const { return output_compression; }
+
     bool shouldPreDump() const { return should_pre_dump; }
+    template <ApiDumpFeatures Features>
+    bool shouldPreDump() const { return api_dump_feature<Features, kApiDumpFeaturePreDump>(should_pre_dump); }
 
     bool showAddress() const { return show_address; }
+    template <ApiDumpFeatures Features>
+    bool showAddress() const { return api_dump_feature<Features, kApiDumpFeatureShowAddress>(show_address); }
 
     bool showParams() const { return show_params; }
+    template <ApiDumpFeatures Features>
+    bool showParams() const { return api_dump_feature<Features, kApiDumpFeatureDetailed>(show_params); }
 
     bool showShader() const { return show_shader; }
 
+    // Whether the code of shader modules is saved to files of their own, which the output names instead of showing the code.
+    bool saveShaders() const { return save_shaders; }
+    ApiDumpShaderStore &shaderStore() const { return shader_store; }
+
+    // Whether the creation of pipelines is profiled, and where the report ranking the pipeline_profile_count slowest ones goes.
+    bool pipelineProfile() const { return pipeline_profile; }
+    const std::string &pipelineProfileFile() const { return pipeline_profile_file; }
+    uint32_t pipelineProfileCount() const { return pipeline_profile_count; }
+
     bool showType() const { return show_type; }
+    template <ApiDumpFeatures Features>
+    bool showType() const { return api_dump_feature<Features, kApiDumpFeatureShowType>(show_type); }
 
     bool showTimestamp() const { return show_timestamp; }
+    template <ApiDumpFeatures Features>
+    bool showTimestamp() const { return api_dump_feature<Features, kApiDumpFeatureTimestamp>(show_timestamp); }
+
+    TimestampClock timestampClock() const { return timestamp_clock; }
+
+    // Timestamps are taken in nanoseconds, but the system clock shows them in microseconds as it always did.
+    uint64_t timestampValue(uint64_t ns) const { return timestamp_clock == TimestampClock::System ? ns / 1000 : ns; }
+    const char *timestampUnit() const { return timestamp_clock == TimestampClock::System ? " us" : " ns"; }
 
     bool showThreadAndFrame() const { return show_thread_and_frame; }
+    template <ApiDumpFeatures Features>
+    bool showThreadAndFrame() const { return api_dump_feature<Features, kApiDumpFeatureThreadAndFrame>(show_thread_and_frame); }
 
-    // The const cast is necessary because everyone who 'writes' to the stream necessarily must be able to modify it.
-    // Since basically every function in this struct is const, we have to work around that.
-    std::ostream &stream() const { return output_stream; }
+    // The settings above as ApiDumpFeatures bits, which select the generated functions vkGetInstanceProcAddr and
+    // vkGetDeviceProcAddr return. Until the settings are read, the functions that read them.
+    ApiDumpFeatures features() const { return feature_bits; }
+
+    bool bufferRecords() const { return buffer_records; }
+
+    bool asyncOutput() const { return async_output; }
+
+    uint32_t asyncQueueSize() const { return async_queue_size; }
+
+    QueueFullPolicy asyncQueueFullPolicy() const { return async_queue_full_policy; }
+
+    // Whether include_functions and exclude_functions select the function. Checked once by vkGetInstanceProcAddr and
+    // vkGetDeviceProcAddr, which return the next layer's function for the others.
+    bool isFunctionDumped(const char *name) const { return function_filter.isFunctionDumped(name); }
+
+    // Same as above, looked up in a table built once the settings are read, for the calls the layer intercepts. Until then,
+    // which is only for vkCreateInstance, every function is dumped.
+    bool isFunctionDumped(ApiDumpFunctionId function) const {
+        const uint32_t index = static_cast<uint32_t>(function);
+        return dumped_functions.empty() || (index < dumped_functions.size() && dumped_functions[index]);
+    }
+
+    const SamplingSettings &sampling() const { return sampling_settings; }
+
+    // In statistics mode, calls are counted and timed instead of dumped.
+    bool statisticsMode() const { return statistics_mode; }
+
+    // Number of frames each statistics summary covers, 0 for a single summary at shutdown.
+    uint32_t statisticsInterval() const { return statistics_interval; }
+
+    // In flight recorder mode, the binary records of the most recent calls are kept in memory, and only written to a file
+    // when a trigger fires.
+    bool flightRecorderMode() const { return flight_recorder.isEnabled(); }
+
+    // Whether a call returning result triggers a dump of the flight recorder.
+    bool isFlightRecorderTrigger(VkResult result) const {
+        if (!flight_recorder.isEnabled() || result == VK_SUCCESS) {
+            return false;
+        }
+        const char *name = string_VkResult(result);
+        for (const std::string &trigger : flight_recorder_results) {
+            if (trigger == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int flightRecorderSignal() const { return flight_recorder_signal; }
+
+    const std::string &flightRecorderTriggerFile() const { return flight_recorder_trigger_file; }
+
+    bool flightRecorderDumpOnExit() const { return flight_recorder_dump_on_exit; }
+
+    // Must be called with the output mutex held. Writes the records kept by the flight recorder to a file of their own, if
+    // it kept any.
+    void dumpFlightRecorder() const {
+        flushOutput(false);
+        if (!flight_recorder.empty()) {
+            flight_recorder.dump();
+        }
+    }
+
+    // Output is formatted into a buffer and written to the output stream by flushOutput(). While the calling thread is
+    // formatting a buffered record, this is the thread's record buffer instead.
+    FormatBuffer &stream() const {
+        FormatBuffer *record_stream = threadRecordStream();
+        return record_stream != nullptr ? *record_stream : output_buffer;
+    }
+
+    // Redirect stream() on the calling thread to record_stream, or back to the output buffer when record_stream is null.
+    void setThreadRecordStream(FormatBuffer *record_stream) const { threadRecordStream() = record_stream; }
+
+    // Must be called with the output mutex held. Writes the formatted output to the output stream, and flushes the output stream
+    // when flush_stream is set. Does nothing while the calling thread is formatting a buffered record, the record is written
+    // once it is complete.
+    void flushOutput(bool flush_stream) const {
+        if (isThreadBufferingRecord()) {
+            return;
+        }
+        if (!output_buffer.empty()) {
+            writeToOutput(output_buffer.str().data(), output_buffer.size());
+            output_buffer.clear();
+        }
+        if (flight_recorder.isEnabled()) {
+            flight_recorder.dumpIfRequested();
+            return;
+        }
+        if (flush_stream) {
+            if (flush_interval > 0) {
+                const auto now = std::chrono::steady_clock::now();
+                if (now - last_flush_time < std::chrono::milliseconds(flush_interval)) {
+                    return;
+                }
+                last_flush_time = now;
+            }
+            output_stream.flush();
+        }
+    }
+
+    // Must be called with the output mutex held. Writes text to the output stream, after the output formatted so far.
+    void writeOutput(const std::string &text) const {
+        flushOutput(false);
+        writeToOutput(text.data(), text.size());
+    }
+
+    // Must be called with the output mutex held, between frames. Starts a new output file when the current one reached
+    // rotate_size or holds rotate_frames frames, and deletes the oldest files beyond rotate_max_files. Each file is closed off
+    // like the output is when the layer is unloaded, so that it can be read on its own.
+    void rotateOutputFile(uint64_t frame) {
+        if (rotation_stem.empty() || segment_size + output_buffer.size() <= segment_header_size) {
+            // Not rotating, or nothing was written to the file yet
+            return;
+        }
+        const bool size_reached = rotate_size > 0 && segment_size + output_buffer.size() >= rotate_size;
+        const bool frames_reached = rotate_frames > 0 && frame - segment_first_frame >= rotate_frames;
+        if (!size_reached && !frames_reached) {
+            return;
+        }
+
+        writeFileTrailer();
+        flushOutput(false);
+        ++segment_index;
+        segment_first_frame = frame;
+        segment_size = 0;
+        openOutputFile(segmentFilename(segment_index));
+        segment_files.push_back(segmentFilename(segment_index));
+        while (rotate_max_files > 0 && segment_files.size() > rotate_max_files) {
+            remove(segment_files.front().c_str());
+            segment_files.pop_front();
+        }
+        writeFileHeader();
+    }
+
+    bool isThreadBufferingRecord() const { return threadRecordStream() != nullptr; }
 
     bool isFrameInRange(uint64_t frame) const { return condFrameOutput.isFrameInRange(frame); }
 
+    // Set by the binary capture decoder, so that the addresses of the objects it rebuilt are shown as the application's.
+    void setAddressMap(const ApiDumpAddressMap *map) { address_map = map; }
+
+    const void *displayAddress(const void *address) const {
+        return address_map != nullptr ? address_map->originalAddress(address) : address;
+    }
+
     void init(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator) {
         VkuLayerSettingSet layerSettingSet = VK_NULL_HANDLE;
         vkuCreateLayerSettingSet("VK_LAYER_LUNARG_api_dump", vkuFindLayerSettingsCreateInfo(pCreateInfo), pAllocator, nullptr,
@@ -538,6 +1038,7 @@ class ApiDumpSettings {
 
         // Read the format type first as it may be used in the output file extension
         output_format = ApiDumpFormat::Text;
+        json_lines = false;
         if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyOutputFormat)) {
             std::string value;
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyOutputFormat, value);
@@ -546,11 +1047,44 @@ class ApiDumpSettings {
                 output_format = ApiDumpFormat::Html;
             } else if (value == "json") {
                 output_format = ApiDumpFormat::Json;
+            } else if (value == "jsonl") {
+                output_format = ApiDumpFormat::Json;
+                json_lines = true;
+            } else if (value == "binary") {
+                output_format = ApiDumpFormat::Binary;
+            } else if (value == "trace") {
+                output_format = ApiDumpFormat::Trace;
             } else {
                 output_format = ApiDumpFormat::Text;
             }
         }
 
+        statistics_mode = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyStatistics)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyStatistics, statistics_mode);
+        }
+        if (statistics_mode && output_format != ApiDumpFormat::Json) {
+            // Statistics are written as json, or as text for every other format
+            output_format = ApiDumpFormat::Text;
+            json_lines = false;
+        }
+
+        bool flight_recorder_mode = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorder)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorder, flight_recorder_mode);
+        }
+        // The flight recorder keeps binary records, and can't be combined with statistics
+        flight_recorder_mode = flight_recorder_mode && !statistics_mode;
+        if (flight_recorder_mode) {
+            output_format = ApiDumpFormat::Binary;
+            json_lines = false;
+        }
+
+        statistics_interval = 1;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyStatisticsInterval)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyStatisticsInterval, statistics_interval);
+        }
+
         // If the layer settings file has a flag indicating to output to a file,
         // do so, to the appropriate default filename.
         std::string filename_string = "";
@@ -561,8 +1095,12 @@ class ApiDumpSettings {
             if (file) {
                 if (output_format == ApiDumpFormat::Html) {
                     filename_string = "vk_apidump.html";
-                } else if (output_format == ApiDumpFormat::Json) {
+                } else if (json_lines) {
+                    filename_string = "vk_apidump.jsonl";
+                } else if (output_format == ApiDumpFormat::Json || output_format == ApiDumpFormat::Trace) {
                     filename_string = "vk_apidump.json";
+                } else if (output_format == ApiDumpFormat::Binary) {
+                    filename_string = "vk_apidump.bin";
                 } else {
                     filename_string = "vk_apidump.txt";
                 }
@@ -574,31 +1112,121 @@ class ApiDumpSettings {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyLogFilename, filename_string);
         }
 
+        // Binary captures can't go to stdout or logcat
+        if (output_format == ApiDumpFormat::Binary && filename_string.empty()) {
+            filename_string = "vk_apidump.bin";
+        }
+
+        // A .gz extension selects gzip compression, unless the compression setting says otherwise. The extension is put back
+        // after the one of the format.
+        bool gz_extension = false;
+        if (filename_string.size() > 3 && filename_string.compare(filename_string.size() - 3, 3, ".gz") == 0) {
+            filename_string.erase(filename_string.size() - 3);
+            gz_extension = true;
+        }
+        output_compression = gz_extension ? OutputCompression::Gzip : OutputCompression::None;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyCompression)) {
+            std::string value;
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyCompression, value);
+            value = ToLowerString(value);
+            if (value == "gzip") {
+                output_compression = OutputCompression::Gzip;
+            } else if (value == "none") {
+                output_compression = OutputCompression::None;
+            }
+        }
+        if (output_compression == OutputCompression::Gzip && !IsGzipOutputSupported()) {
+            std::cerr << "api_dump: this build of the layer can't compress its output, writing it uncompressed" << std::endl;
+            output_compression = OutputCompression::None;
+        }
+
         // Append file extension if one doesn't exist or is the wrong extension. Make sure the found extension is at the end
         if (!filename_string.empty()) {
             size_t txt_pos = filename_string.find(".txt", filename_string.size() - 4);
             size_t html_pos = filename_string.find(".html", filename_string.size() - 5);
             size_t json_pos = filename_string.find(".json", filename_string.size() - 5);
+            size_t jsonl_pos = filename_string.find(".jsonl", filename_string.size() - 6);
+            size_t bin_pos = filename_string.find(".bin", filename_string.size() - 4);
 
             if (output_format == ApiDumpFormat::Html) {
                 if (json_pos != std::string::npos) filename_string.erase(json_pos);
                 if (txt_pos != std::string::npos) filename_string.erase(txt_pos);
+                if (bin_pos != std::string::npos) filename_string.erase(bin_pos);
                 if (html_pos == std::string::npos) filename_string.append(".html");
-            } else if (output_format == ApiDumpFormat::Json) {
+            } else if (json_lines) {
+                if (html_pos != std::string::npos) filename_string.erase(html_pos);
+                if (json_pos != std::string::npos) filename_string.erase(json_pos);
+                if (txt_pos != std::string::npos) filename_string.erase(txt_pos);
+                if (bin_pos != std::string::npos) filename_string.erase(bin_pos);
+                if (jsonl_pos == std::string::npos) filename_string.append(".jsonl");
+            } else if (output_format == ApiDumpFormat::Json || output_format == ApiDumpFormat::Trace) {
                 if (html_pos != std::string::npos) filename_string.erase(html_pos);
                 if (txt_pos != std::string::npos) filename_string.erase(txt_pos);
+                if (bin_pos != std::string::npos) filename_string.erase(bin_pos);
                 if (json_pos == std::string::npos) filename_string.append(".json");
+            } else if (output_format == ApiDumpFormat::Binary) {
+                if (html_pos != std::string::npos) filename_string.erase(html_pos);
+                if (json_pos != std::string::npos) filename_string.erase(json_pos);
+                if (txt_pos != std::string::npos) filename_string.erase(txt_pos);
+                if (bin_pos == std::string::npos) filename_string.append(".bin");
             } else {
                 if (html_pos != std::string::npos) filename_string.erase(html_pos);
                 if (json_pos != std::string::npos) filename_string.erase(json_pos);
+                if (bin_pos != std::string::npos) filename_string.erase(bin_pos);
                 if (txt_pos == std::string::npos) filename_string.append(".txt");
             }
+            if (output_compression == OutputCompression::Gzip) {
+                filename_string.append(".gz");
+            }
+        } else {
+            // Only files are compressed
+            output_compression = OutputCompression::None;
         }
 
-        // If one of the above has set a filename, open the file as an output stream.
-        if (!filename_string.empty()) {
-            output_file_stream.open(filename_string, std::ofstream::out | std::ostream::trunc);
-            output_stream.rdbuf(output_file_stream.rdbuf());
+        // Compressed files are written by the compression thread, which gains nothing from a mapping
+        memory_mapped = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyMemoryMapped)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyMemoryMapped, memory_mapped);
+        }
+        if (memory_mapped && !IsMappedFileOutputSupported()) {
+            std::cerr << "api_dump: memory mapped output isn't supported on this platform, writing the file as a stream"
+                      << std::endl;
+            memory_mapped = false;
+        }
+        if (filename_string.empty() || output_compression != OutputCompression::None) {
+            memory_mapped = false;
+        }
+
+        // Rotated files are numbered between the name and the extension, as in vk_apidump.000003.json
+        uint32_t rotate_size_mb = 0;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyRotateSize)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyRotateSize, rotate_size_mb);
+        }
+        rotate_size = static_cast<uint64_t>(rotate_size_mb) * 1024 * 1024;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyRotateFrames)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyRotateFrames, rotate_frames);
+        }
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyRotateMaxFiles)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyRotateMaxFiles, rotate_max_files);
+        }
+
+        // If one of the above has set a filename, open the file as an output stream. Only the first instance opens it. The
+        // flight recorder opens a file of its own each time it is dumped instead, numbered like rotated files are.
+        if (!filename_string.empty() && !output_file_open) {
+            const size_t gz_size = output_compression == OutputCompression::Gzip ? 3 : 0;
+            const size_t extension_pos = filename_string.rfind('.', filename_string.size() - gz_size - 1);
+            if (flight_recorder_mode) {
+                initFlightRecorder(layerSettingSet, filename_string.substr(0, extension_pos),
+                                   filename_string.substr(extension_pos));
+            } else {
+                if (rotate_size > 0 || rotate_frames > 0) {
+                    rotation_stem = filename_string.substr(0, extension_pos);
+                    rotation_extension = filename_string.substr(extension_pos);
+                    filename_string = segmentFilename(0);
+                    segment_files.push_back(filename_string);
+                }
+                openOutputFile(filename_string);
+            }
         }
 
         show_params = true;
@@ -619,6 +1247,12 @@ class ApiDumpSettings {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlush, should_flush);
         }
 
+        // Flushing a compressed stream after every call would leave little to compress
+        flush_interval = output_compression == OutputCompression::None ? 0 : 1000;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlushInterval)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlushInterval, flush_interval);
+        }
+
         should_pre_dump = false;
         if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyPreDump)) {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyPreDump, should_pre_dump);
@@ -629,6 +1263,18 @@ class ApiDumpSettings {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyTimestamp, show_timestamp);
         }
 
+        timestamp_clock = TimestampClock::System;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyTimestampClock)) {
+            std::string value;
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyTimestampClock, value);
+            value = ToLowerString(value);
+            if (value == "steady") {
+                timestamp_clock = TimestampClock::Steady;
+            } else if (value == "raw") {
+                timestamp_clock = TimestampClock::Raw;
+            }
+        }
+
         indent_size = 4;
         if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyIndentSize)) {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyIndentSize, indent_size);
@@ -663,11 +1309,102 @@ class ApiDumpSettings {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyShowShader, show_shader);
         }
 
+        save_shaders = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeySaveShaders)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeySaveShaders, save_shaders);
+        }
+        if (save_shaders) {
+            shader_store.setDirectory(std::filesystem::path(filename_string).parent_path().string());
+        }
+
+        pipeline_profile = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyPipelineProfile)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyPipelineProfile, pipeline_profile);
+        }
+        // The report goes next to the output file by default, as json when the output is json
+        pipeline_profile_file =
+            (std::filesystem::path(filename_string).parent_path() /
+             (output_format == ApiDumpFormat::Json ? "vk_apidump_pipelines.json" : "vk_apidump_pipelines.txt"))
+                .string();
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyPipelineProfileFile)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyPipelineProfileFile, pipeline_profile_file);
+        }
+        pipeline_profile_count = 50;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyPipelineProfileCount)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyPipelineProfileCount, pipeline_profile_count);
+        }
+
         show_thread_and_frame = true;
         if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyShowThreadAndFrame)) {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyShowThreadAndFrame, show_thread_and_frame);
         }
 
+        feature_bits = (show_type ? kApiDumpFeatureShowType : 0) | (show_address ? kApiDumpFeatureShowAddress : 0) |
+                       (show_params ? kApiDumpFeatureDetailed : 0) | (show_thread_and_frame ? kApiDumpFeatureThreadAndFrame : 0) |
+                       (show_timestamp ? kApiDumpFeatureTimestamp : 0) | (should_pre_dump ? kApiDumpFeaturePreDump : 0);
+
+        buffer_records = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyBufferRecords)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyBufferRecords, buffer_records);
+        }
+
+        async_output = false;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyAsyncOutput)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyAsyncOutput, async_output);
+        }
+        // The writer thread consumes finished records, so asynchronous output implies buffered records. So does the flight
+        // recorder, which keeps whole records and is dumped while calls are made, possibly one that hangs.
+        if (async_output || flight_recorder_mode) {
+            buffer_records = true;
+        }
+
+        async_queue_size = 4096;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyAsyncQueueSize)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyAsyncQueueSize, async_queue_size);
+            async_queue_size = std::max(async_queue_size, 2u);
+        }
+
+        async_queue_full_policy = QueueFullPolicy::Block;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyAsyncQueueFullPolicy)) {
+            std::string value;
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyAsyncQueueFullPolicy, value);
+            if (ToLowerString(value) == "drop") {
+                async_queue_full_policy = QueueFullPolicy::Drop;
+            }
+        }
+
+        std::vector<std::string> include_functions;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyIncludeFunctions)) {
+            vkuGetLayerSettingValues(layerSettingSet, kSettingsKeyIncludeFunctions, include_functions);
+        }
+        std::vector<std::string> exclude_functions;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyExcludeFunctions)) {
+            vkuGetLayerSettingValues(layerSettingSet, kSettingsKeyExcludeFunctions, exclude_functions);
+        }
+        function_filter.init(include_functions, exclude_functions);
+        dumped_functions.assign(api_dump_function_count(), false);
+        for (uint32_t index = 0; index < api_dump_function_count(); ++index) {
+            const ApiDumpFunctionId function = static_cast<ApiDumpFunctionId>(index);
+            dumped_functions[index] = function_filter.isFunctionDumped(api_dump_function_name(function));
+        }
+
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeySamplingInterval)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeySamplingInterval, sampling_settings.interval);
+            if (sampling_settings.interval == 0) {
+                sampling_settings.interval = 1;
+            }
+        }
+
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeySamplingMaxCallsPerFrame)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeySamplingMaxCallsPerFrame, sampling_settings.max_calls_per_frame);
+        }
+
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeySamplingFrameBudget)) {
+            uint32_t frame_budget_us = 0;
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeySamplingFrameBudget, frame_budget_us);
+            sampling_settings.frame_budget_ns = static_cast<uint64_t>(frame_budget_us) * 1000;
+        }
+
         std::string cond_range_string;
         if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyOutputRange)) {
             vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyOutputRange, cond_range_string);
@@ -682,19 +1419,136 @@ class ApiDumpSettings {
             }
         }
 
-        // Setfill stays active for the duration of the stream. Setting it during construction
-        // means it doesn't have to be set again whenever setw() is called.
-        output_stream << std::setfill(use_spaces ? ' ' : '\t');
+        padding_fill = use_spaces ? ' ' : '\t';
 
         if (!use_spaces) {
             indent_size = 1;  // setting this allows indentation to not need a branch on use_spaces
         }
+        if (json_lines) {
+            indent_size = 0;
+        }
+
+        writeFileHeader();
+
+        vkuDestroyLayerSettingSet(layerSettingSet, pAllocator);
+    }
+
+   private:
+    // Writes to the output stream, or to the flight recorder in flight recorder mode.
+    void writeToOutput(const char *data, size_t size) const {
+        if (flight_recorder.isEnabled()) {
+            flight_recorder.append(data, size);
+            return;
+        }
+        output_stream.write(data, static_cast<std::streamsize>(size));
+        segment_size += size;
+    }
+
+    // Opens filename as the output stream, through a GzipFileBuf when the output is compressed or a MappedFileBuf when it is
+    // memory mapped. A file that is open already is closed first.
+    void openOutputFile(const std::string &filename) {
+        output_file_open = true;
+#if !defined(_WIN32)
+        if (memory_mapped) {
+            auto mapped_buf = std::make_unique<MappedFileBuf>();
+            if (mapped_buf->open(filename)) {
+                output_stream.rdbuf(mapped_buf.get());
+                // Closes the previous file, if any
+                mapped_file_buf = std::move(mapped_buf);
+            }
+            return;
+        }
+#endif
+        if (output_compression == OutputCompression::Gzip) {
+#if defined(API_DUMP_HAS_ZLIB)
+            auto gzip_buf = std::make_unique<GzipFileBuf>();
+            if (gzip_buf->open(filename)) {
+                output_stream.rdbuf(gzip_buf.get());
+                // Finishes the previous file, if any
+                gzip_file_buf = std::move(gzip_buf);
+            }
+#endif
+            return;
+        }
+        if (output_file_stream.is_open()) {
+            output_file_stream.close();
+        }
+        std::ios_base::openmode mode = std::ofstream::out | std::ostream::trunc;
+        if (output_format == ApiDumpFormat::Binary) {
+            mode |= std::ostream::binary;
+        }
+        output_file_stream.open(filename, mode);
+        output_stream.rdbuf(output_file_stream.rdbuf());
+    }
+
+    void initFlightRecorder(VkuLayerSettingSet layerSettingSet, const std::string &stem, const std::string &extension) {
+        uint32_t size_mb = 64;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderSize)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorderSize, size_mb);
+            size_mb = std::max(size_mb, 1u);
+        }
+        uint32_t max_calls = 0;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderCalls)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorderCalls, max_calls);
+        }
+        uint32_t max_frames = 0;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderFrames)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorderFrames, max_frames);
+        }
+
+        flight_recorder_results = {"VK_ERROR_DEVICE_LOST"};
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderResults)) {
+            vkuGetLayerSettingValues(layerSettingSet, kSettingsKeyFlightRecorderResults, flight_recorder_results);
+        }
+
+        flight_recorder_signal = 0;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderSignal)) {
+            std::string value;
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorderSignal, value);
+#if !defined(_WIN32)
+            value = ToLowerString(value);
+            if (value == "sigusr1") {
+                flight_recorder_signal = SIGUSR1;
+            } else if (value == "sigusr2") {
+                flight_recorder_signal = SIGUSR2;
+            }
+#endif
+        }
+
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderTriggerFile)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorderTriggerFile, flight_recorder_trigger_file);
+        }
+
+        flight_recorder_dump_on_exit = true;
+        if (vkuHasLayerSetting(layerSettingSet, kSettingsKeyFlightRecorderDumpOnExit)) {
+            vkuGetLayerSettingValue(layerSettingSet, kSettingsKeyFlightRecorderDumpOnExit, flight_recorder_dump_on_exit);
+        }
+
+        flight_recorder.init(static_cast<size_t>(size_mb) * 1024 * 1024, max_calls, max_frames, binaryFileHeader(), stem,
+                             extension, output_compression);
+    }
+
+    static ApiDumpBinaryFileHeader binaryFileHeader() {
+        ApiDumpBinaryFileHeader header{};
+        memcpy(header.magic, kApiDumpBinaryMagic, sizeof(header.magic));
+        header.version = kApiDumpBinaryVersion;
+        header.header_version = VK_HEADER_VERSION_COMPLETE;
+        header.pointer_size = sizeof(void *);
+        return header;
+    }
+
+    std::string segmentFilename(uint32_t index) const {
+        char number[16];
+        snprintf(number, sizeof(number), ".%06u", index);
+        return rotation_stem + number + rotation_extension;
+    }
 
-        // Generate HTML heading if specified
+    // Writes what precedes the frames in each output file.
+    void writeFileHeader() {
         if (output_format == ApiDumpFormat::Html) {
             // clang-format off
             // Insert html heading
-            output_stream <<
+            output_buffer <<
                 "<!doctype html>"
                 "<html>"
                     "<head>"
@@ -793,18 +1647,33 @@ class ApiDumpSettings {
                         "</div>"
                         "<div id='wrapper'>";
             // clang-format on
-        } else if (output_format == ApiDumpFormat::Json) {
-            output_stream << "[\n";
-        }
-
-        if (isFrameInRange(0)) {
-            setupInterFrameOutputFormatting(0);
+        } else if (output_format == ApiDumpFormat::Json && !json_lines) {
+            output_buffer << "[\n";
+        } else if (output_format == ApiDumpFormat::Trace) {
+            output_buffer << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        } else if (output_format == ApiDumpFormat::Binary && !flight_recorder.isEnabled()) {
+            // The flight recorder writes the header of the files it dumps
+            const ApiDumpBinaryFileHeader header = binaryFileHeader();
+            output_buffer.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+        frame_output_written = false;
+        statistics_written = false;
+        segment_header_size = segment_size + output_buffer.size();
+    }
+
+    // Closes off the output file, after the last frame was closed off by ApiDumpInstance.
+    void writeFileTrailer() const {
+        if (output_format == ApiDumpFormat::Html) {
+            output_buffer << "</div></body></html>";
+        } else if (output_format == ApiDumpFormat::Json && !json_lines) {
+            output_buffer << "\n]\n";
+        } else if (output_format == ApiDumpFormat::Trace) {
+            // Every event is followed by a separator, so the array is closed off by one more event
+            output_buffer << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kTraceProcessId
+                          << ",\"tid\":0,\"args\":{\"name\":\"Vulkan API\"}}\n]}\n";
         }
-
-        vkuDestroyLayerSettingSet(layerSettingSet, pAllocator);
     }
 
-   private:
     // Utility member to enable easier comparison by forcing a string to all lower-case
     static std::string ToLowerString(const std::string &value) {
         std::string lower_value = value;
@@ -812,37 +1681,162 @@ class ApiDumpSettings {
         return lower_value;
     }
 
+    static FormatBuffer *&threadRecordStream() {
+        thread_local FormatBuffer *record_stream = nullptr;
+        return record_stream;
+    }
+
     // The mutable is necessary because everyone who 'writes' to the stream necessarily must be able to modify it.
     // Since basically every function in this struct is const, we have to work around that.
+    mutable FormatBuffer output_buffer;
     mutable std::ostream output_stream;
     std::ofstream output_file_stream;
+#if defined(API_DUMP_HAS_ZLIB)
+    std::unique_ptr<GzipFileBuf> gzip_file_buf;
+#endif
+#if !defined(_WIN32)
+    std::unique_ptr<MappedFileBuf> mapped_file_buf;
+#endif
+    bool output_file_open = false;
+
+    // Rotation of the output file, see rotateOutputFile()
+    uint64_t rotate_size = 0;  // In bytes, before compression
+    uint32_t rotate_frames = 0;
+    uint32_t rotate_max_files = 0;
+    std::string rotation_stem;  // Empty when the output isn't rotated
+    std::string rotation_extension;
+    uint32_t segment_index = 0;
+    uint64_t segment_first_frame = 0;
+    mutable uint64_t segment_size = 0;  // Bytes written to the current file
+    uint64_t segment_header_size = 0;
+    std::deque<std::string> segment_files;  // Files that weren't deleted yet, oldest first
 #ifdef __ANDROID__
     std::unique_ptr<AndroidLogcatBuf<>> android_logcat_buf = nullptr;
 #endif
     ApiDumpFormat output_format;
+    bool json_lines = false;  // The json format, written as JSON Lines
     bool show_params;
     bool show_address;
     bool should_flush;
+    uint32_t flush_interval = 0;
+    mutable std::chrono::steady_clock::time_point last_flush_time;
+    OutputCompression output_compression = OutputCompression::None;
+    bool memory_mapped = false;
     bool should_pre_dump;
     bool show_timestamp;
+    TimestampClock timestamp_clock = TimestampClock::System;
 
     bool show_type;
     int indent_size;  // how many indent levels to use - also sets the tab_size
     int name_size;
     int type_size;
     bool use_spaces;
+    char padding_fill = ' ';
     bool show_shader;
+    bool save_shaders = false;
+    mutable ApiDumpShaderStore shader_store;
+    bool pipeline_profile = false;
+    std::string pipeline_profile_file;
+    uint32_t pipeline_profile_count = 50;
     bool show_thread_and_frame;
+    ApiDumpFeatures feature_bits = kApiDumpFeaturesRuntime;
+    bool buffer_records = false;
+    bool async_output = false;
+    uint32_t async_queue_size;
+    QueueFullPolicy async_queue_full_policy;
 
     bool use_conditional_output = false;
     ConditionalFrameOutput condFrameOutput;
+    FunctionFilter function_filter;
+    std::vector<bool> dumped_functions;  // Indexed by ApiDumpFunctionId
+    SamplingSettings sampling_settings;
+    bool statistics_mode = false;
+    uint32_t statistics_interval = 1;
+    mutable bool statistics_written = false;
+    mutable bool frame_output_written = false;
+    mutable uint64_t open_frame = 0;
+
+    mutable FlightRecorder flight_recorder;
+    std::vector<std::string> flight_recorder_results;  // Names of the VkResults that trigger a dump
+    int flight_recorder_signal = 0;
+    std::string flight_recorder_trigger_file;
+    bool flight_recorder_dump_on_exit = true;
+    const ApiDumpAddressMap *address_map = nullptr;
 
     int tab_size;  // equal to the indent size if using spaces, otherwise is equal to 1
 };
 
+// Context of the API call a thread is dumping: the state that is stashed while dumping one structure and read back while dumping
+// one of its members, such as the active member of a union or the length of an array. The generated functions create one on
+// their stack for each call, and the thread finds it through a thread local pointer. The state doesn't outlive the call and isn't
+// shared with other threads, so dumping doesn't depend on the output mutex to keep it consistent. A call made while another is
+// dumped on the same thread, such as the loader calling back into the layer, gets a context of its own.
+class ApiDumpCallContext {
+   public:
+    struct DecodeState {
+        // Storage for getCmdBufferLevel() which is called in a place where it needs access to the cmd_buffer but it isn't present
+        // in the current structure.
+        VkCommandBuffer cmd_buffer = VK_NULL_HANDLE;
+
+        // Storage for VkPipelineViewportStateCreateInfo which needs to ignore the scissor and viewport pipeline state if their
+        // respective dynamic state is set.
+        bool is_dynamic_scissor = false;
+        bool is_dynamic_viewport = false;
+
+        // Storage for VkPhysicalDeviceMemoryBudgetPropertiesEXT which needs the number of heaps from
+        // VkPhysicalDeviceMemoryProperties
+        uint32_t memory_heap_count = 0;
+
+        // Storage for the VkDescriptorDataEXT/VkResourceDescriptorDataEXT union to know what is the active element
+        VkDescriptorType descriptor_type{};
+
+        // True when creating a graphics pipeline library with VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT or
+        // VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT set in the VkGraphicsPipelineLibraryCreateInfoEXT struct.
+        bool GPLPreRasterOrFragmentShader = false;
+
+        // Storage for the VkIndirectExecutionSetInfoEXT union to know which is the active element
+        VkIndirectExecutionSetInfoTypeEXT indirectExecutionSetInfoType{};
+
+        // Storage for the VkIndirectCommandsTokenDataEXT union to know which is the active element
+        VkIndirectCommandsTokenTypeEXT indirectCommandsLayoutToken{};
+
+        // Storage for the VkDescriptorMappingSourceDataEXT union
+        VkDescriptorMappingSourceEXT descriptorMappingSource{};
+
+        // Storage for StdVideoH265HrdParameters's array length for pSubLayerHrdParametersNal and pSubLayerHrdParametersVcl
+        uint8_t sps_max_sub_layers_minus1 = 0;
+        uint8_t vps_max_sub_layers_minus1 = 0;
+
+        // True if StdVideoH265HrdParameters is currently in StdVideoH265VideoParameterSet, false if it is in
+        // StdVideoH265SequenceParameterSetVui. Needed to determine whether to use vps_max_sub_layers_minus1 or
+        // sps_max_sub_layers_minus1
+        bool is_in_vps = false;
+    };
+
+    ApiDumpCallContext() : previous(active) { active = this; }
+    ~ApiDumpCallContext() { active = previous; }
+    ApiDumpCallContext(const ApiDumpCallContext &) = delete;
+    ApiDumpCallContext &operator=(const ApiDumpCallContext &) = delete;
+
+    // The state of the call the thread is dumping. What is dumped outside of a call, like the output of the benchmarks, uses
+    // state of the thread.
+    static DecodeState &decodeState() {
+        if (active != nullptr) {
+            return active->decode_state;
+        }
+        thread_local DecodeState outside_call;
+        return outside_call;
+    }
+
+   private:
+    DecodeState decode_state;
+    ApiDumpCallContext *const previous;
+    static inline thread_local ApiDumpCallContext *active = nullptr;
+};
+
 class ApiDumpInstance {
    public:
-    ApiDumpInstance() noexcept : frame_count(0) { program_start = std::chrono::system_clock::now(); }
+    ApiDumpInstance() noexcept : frame_count(0) {}
     // Can't copy or move this type
     ApiDumpInstance(const ApiDumpInstance &) = delete;
     ApiDumpInstance &operator=(const ApiDumpInstance &) = delete;
@@ -850,235 +1844,764 @@ class ApiDumpInstance {
     ApiDumpInstance &operator=(ApiDumpInstance &&) = delete;
 
     ~ApiDumpInstance() {
-        if (!first_func_call_on_frame) settings().closeFrameOutput();
+        // Queued records have to be written before the frame and the file are closed off
+        stopWriter();
+        stopFlightRecorderWatch();
+        if (frame_output_open) settings().closeFrameOutput(endFrameSampling());
+        if (settings().statisticsMode()) writeStatistics(frameCount() + 1);
+        pipeline_profile.writeReport(object_name_map);
+        if (settings().flightRecorderMode() && settings().flightRecorderDumpOnExit()) {
+            std::lock_guard<std::mutex> lg(output_mutex);
+            settings().dumpFlightRecorder();
+        }
     }
 
     void initLayerSettings(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator) {
         this->dump_settings.init(pCreateInfo, pAllocator);
+        clock.select(settings().timestampClock());
+        if (settings().sampling().enabled() && !function_sampling) {
+            function_sampling = std::make_unique<FunctionSampling[]>(api_dump_function_count());
+        }
+        if (settings().statisticsMode()) {
+            call_statistics.init(api_dump_function_count());
+        }
+        if (settings().pipelineProfile()) {
+            pipeline_profile.init(settings().pipelineProfileFile(), settings().pipelineProfileCount());
+        }
+        {
+            std::lock_guard<std::mutex> lg(frame_mutex);
+            should_dump_output = settings().isFrameInRange(frameCount());
+        }
+        if (settings().isFrameInRange(frameCount()) && !settings().statisticsMode()) {
+            settings().openFrameOutput(frameCount());
+            frame_output_open = true;
+        }
+        // vkCreateInstance started before output_range, the function filter and sampling were known
+        ThreadCall &call = threadCall();
+        if (call.state != CallState::None) {
+            latchCall(call);
+        }
+        if (settings().asyncOutput()) {
+            startWriter();
+        }
+        if (settings().flightRecorderMode()) {
+            startFlightRecorderWatch();
+        }
     }
 
-    uint64_t frameCount() {
-        std::lock_guard<std::mutex> lg(frame_mutex);
-        uint64_t count = frame_count;
-        return count;
+    // Used by the capture decoder for captures that start at a later frame, like the files of a rotated capture. Must be called
+    // before initLayerSettings().
+    void setFirstFrame(uint64_t frame) {
+        frame_count.store(frame, std::memory_order_relaxed);
+        statistics_first_frame = frame;
     }
 
+    // Frames are only advanced with frame_mutex held, but read without it on every dumped call.
+    uint64_t frameCount() const { return frame_count.load(std::memory_order_relaxed); }
+
+    // Must be called with the output mutex held. When the calling thread is buffering a record, the frame is advanced once the
+    // record has been appended to the output, so that the frame delimiter follows the call that ended the frame.
     void nextFrame() {
+        if (settings().isThreadBufferingRecord()) {
+            threadRecord().next_frame_pending = true;
+            return;
+        }
+        std::vector<SuppressedCalls> suppressed;
+        if (threadCall().state == CallState::Skipped) {
+            // Skipped calls don't hold the output mutex, but the frame delimiters are still written in order
+            std::lock_guard<std::mutex> output_lock(output_mutex);
+            std::lock_guard<std::mutex> lg(frame_mutex);
+            const uint64_t frame = advanceFrame(suppressed);
+            startFrameOutput(frame, suppressed);
+            return;
+        }
         std::lock_guard<std::mutex> lg(frame_mutex);
-        ++frame_count;
+        const uint64_t frame = advanceFrame(suppressed);
+        startFrameOutput(frame, suppressed);
+    }
 
-        should_dump_output = settings().isFrameInRange(frame_count);
-        settings().setupInterFrameOutputFormatting(frame_count);
+    // Block until every record queued for the writer thread so far has been written out. When called while buffering a record,
+    // the wait happens after that record has been queued.
+    void drainOutput() {
+        if (settings().isThreadBufferingRecord()) {
+            threadRecord().drain_pending = true;
+            return;
+        }
+        if (!writer_thread.joinable()) {
+            return;
+        }
+        const uint64_t target = records_queued.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        while (records_written.load(std::memory_order_acquire) < target && writer_thread.joinable()) {
+            writer_cv.notify_one();
+            drained_cv.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+
+    // Whether API calls are dumped. Inside an API call, this is the decision latched by beginCall(), so that a call never
+    // starts writing output it didn't take the output mutex for when another thread starts a frame in range meanwhile.
+    bool shouldDumpOutput() const {
+        const CallState state = threadCall().state;
+        if (state != CallState::None) {
+            return state == CallState::Dumped;
+        }
+        return should_dump_output.load(std::memory_order_relaxed);
+    }
+
+    // Called by ApiDumpRecordGuard before anything else. Only reads the flag advanceFrame() updates, so that calls outside the
+    // output range take no lock at all. Returns whether the call is dumped, which it isn't either when the function is
+    // filtered out or sampling leaves the call out.
+    bool beginCall(ApiDumpFunctionId function) {
+        ThreadCall &call = threadCall();
+        call.function = static_cast<uint32_t>(function);
+        return latchCall(call);
+    }
+    // Output that isn't an API call, such as the frames the binary capture decoder starts, only depends on the output range.
+    bool beginCall() {
+        ThreadCall &call = threadCall();
+        call.function = kNoFunction;
+        return latchCall(call);
+    }
+    // Whether the call of the function down the chain is timed for the statistics, which are only counted in the frames of the
+    // output range, and for the functions selected by the filter.
+    bool isCallMeasured(ApiDumpFunctionId function) {
+        return settings().statisticsMode() && should_dump_output.load(std::memory_order_relaxed) &&
+               settings().isFunctionDumped(function);
+    }
+
+    void recordCallStatistics(ApiDumpFunctionId function, uint64_t latency_ns) {
+        call_statistics.record(static_cast<uint32_t>(function), latency_ns);
+    }
+
+    // Whether the call down the chain is timed for the timestamps of the dump, or for the duration of its trace event. Blocking
+    // functions time their call before the dump decision is latched, so this only reads the output range flag.
+    bool isCallTimestamped() {
+        return (settings().showTimestamp() || settings().format() == ApiDumpFormat::Trace) && !settings().statisticsMode() &&
+               should_dump_output.load(std::memory_order_relaxed);
+    }
+
+    // When the call down the chain of the calling thread's API call was made and returned, kept until the call ends.
+    void setNextLayerCallTimes(uint64_t entry_ns, uint64_t return_ns) {
+        ThreadCall &call = threadCall();
+        call.next_layer_timed = true;
+        call.next_layer_entry_ns = entry_ns;
+        call.next_layer_return_ns = return_ns;
+    }
+    bool nextLayerCallTimes(uint64_t &entry_ns, uint64_t &return_ns) const {
+        const ThreadCall &call = threadCall();
+        entry_ns = call.next_layer_entry_ns;
+        return_ns = call.next_layer_return_ns;
+        return call.next_layer_timed;
+    }
+
+    void endCall() {
+        ThreadCall &call = threadCall();
+        if (call.timed) {
+            const auto elapsed = std::chrono::steady_clock::now() - call.start;
+            frame_dump_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                    std::memory_order_relaxed);
+            call.timed = false;
+        }
+        call.next_layer_timed = false;
+        call.state = CallState::None;
+    }
+
+    bool firstFunctionCallOnFrame() {
+        if (first_func_call_on_frame) {
+            first_func_call_on_frame = false;
+            return true;
+        }
+        return false;
+    }
+
+    std::mutex &outputMutex() { return output_mutex; }
+
+    // Start formatting a record into the calling thread's buffer. No lock is held until endRecord().
+    void beginRecord() {
+        ThreadRecord &record = threadRecord();
+        record.buffer.clear();
+        settings().setThreadRecordStream(&record.buffer);
+    }
+
+    // Append the record formatted since beginRecord() to the output, or hand it to the writer thread when output is
+    // asynchronous. This is the only part of a buffered call that is serialized, so records of different threads never
+    // interleave.
+    void endRecord() {
+        ThreadRecord &record = threadRecord();
+        settings().setThreadRecordStream(nullptr);
+
+        if (writer_thread.joinable()) {
+            QueuedRecord queued;
+            queued.text = record.buffer.take();
+            if (record.next_frame_pending) {
+                record.next_frame_pending = false;
+                // Frames have to be queued in the order they are counted, and their delimiters can never be dropped.
+                std::lock_guard<std::mutex> lg(frame_mutex);
+                queued.next_frame = advanceFrame(queued.suppressed);
+                queueRecord(std::move(queued), QueueFullPolicy::Block);
+            } else if (!queued.text.empty()) {
+                queueRecord(std::move(queued), settings().asyncQueueFullPolicy());
+            }
+            if (record.drain_pending) {
+                record.drain_pending = false;
+                drainOutput();
+            }
+            return;
+        }
+
+        if (record.buffer.empty() && !record.next_frame_pending) {
+            // Nothing to write, which is the case of every call outside the output range
+            record.drain_pending = false;
+            return;
+        }
+        std::lock_guard<std::mutex> lg(output_mutex);
+        appendRecord(record.buffer.str());
+        if (record.next_frame_pending) {
+            record.next_frame_pending = false;
+            nextFrame();
+        }
+        record.drain_pending = false;
+        settings().flushOutput(settings().shouldFlush());
+    }
+
+    ApiDumpSettings &settings() { return dump_settings; }
+
+    // Threads are numbered in the order they first dump a call. The number is assigned once per thread and cached, so that
+    // dumping a call takes no lock for it.
+    uint64_t threadID() {
+        thread_local const uint64_t thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+        return thread_id;
+    }
+
+    void setCmdBuffer(VkCommandBuffer cmd_buffer) { decodeState().cmd_buffer = cmd_buffer; }
+
+    VkCommandBufferLevel getCmdBufferLevel() { return cmd_buffer_state.level(decodeState().cmd_buffer); }
+
+    void eraseCmdBuffers(VkDevice device, VkCommandPool cmd_pool, uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers) {
+        cmd_buffer_state.erase(device, cmd_pool, cmd_buffer_count, cmd_buffers);
+    }
+
+    void addCmdBuffers(VkDevice device, VkCommandPool cmd_pool, uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers,
+                       VkCommandBufferLevel level) {
+        cmd_buffer_state.add(device, cmd_pool, cmd_buffer_count, cmd_buffers, level);
+    }
+
+    void eraseCmdBufferPool(VkDevice device, VkCommandPool cmd_pool) {
+        // Destroying the pool frees its command buffers
+        cmd_buffer_state.erasePool(device, cmd_pool, [this](VkCommandBuffer cmd_buffer) { erase_object_name((uint64_t)cmd_buffer); });
+    }
+
+    void setIsDynamicScissor(bool is_dynamic_scissor) { decodeState().is_dynamic_scissor = is_dynamic_scissor; }
+    void setIsDynamicViewport(bool is_dynamic_viewport) { decodeState().is_dynamic_viewport = is_dynamic_viewport; }
+    bool getIsDynamicScissor() const { return decodeState().is_dynamic_scissor; }
+    bool getIsDynamicViewport() const { return decodeState().is_dynamic_viewport; }
+    void setMemoryHeapCount(uint32_t memory_heap_count) { decodeState().memory_heap_count = memory_heap_count; }
+    uint32_t getMemoryHeapCount() { return decodeState().memory_heap_count; }
+    void setDescriptorType(VkDescriptorType type) { decodeState().descriptor_type = type; }
+    VkDescriptorType getDescriptorType() { return decodeState().descriptor_type; }
+    void setIsGPLPreRasterOrFragmentShader(bool in) { decodeState().GPLPreRasterOrFragmentShader = in; }
+    bool getIsGPLPreRasterOrFragmentShader() { return decodeState().GPLPreRasterOrFragmentShader; }
+    void setIndirectExecutionSetInfoType(VkIndirectExecutionSetInfoTypeEXT type) {
+        decodeState().indirectExecutionSetInfoType = type;
+    }
+    VkIndirectExecutionSetInfoTypeEXT getIndirectExecutionSetInfoType() { return decodeState().indirectExecutionSetInfoType; }
+    void setIndirectCommandsLayoutToken(VkIndirectCommandsTokenTypeEXT type) { decodeState().indirectCommandsLayoutToken = type; }
+    VkIndirectCommandsTokenTypeEXT getIndirectCommandsLayoutToken() { return decodeState().indirectCommandsLayoutToken; }
+    void setDescriptorMappingSource(VkDescriptorMappingSourceEXT source) { decodeState().descriptorMappingSource = source; }
+    VkDescriptorMappingSourceEXT getDescriptorMappingSource() { return decodeState().descriptorMappingSource; }
+
+    void setSpsMaxSubLayersMinus1(uint8_t sps_max_sub_layers_minus1) {
+        decodeState().sps_max_sub_layers_minus1 = sps_max_sub_layers_minus1;
+    }
+    uint8_t getSpsMaxSubLayersMinus1() { return decodeState().sps_max_sub_layers_minus1; }
+    void setVpsMaxSubLayersMinus1(uint8_t vps_max_sub_layers_minus1) {
+        decodeState().vps_max_sub_layers_minus1 = vps_max_sub_layers_minus1;
+    }
+    uint8_t getVpsMaxSubLayersMinus1() { return decodeState().vps_max_sub_layers_minus1; }
+    void setIsInVps(bool is_in_vps) { decodeState().is_in_vps = is_in_vps; }
+    bool getIsInVps() { return decodeState().is_in_vps; }
+
+    std::chrono::nanoseconds current_time_since_start() const { return std::chrono::nanoseconds(clock.now()); }
+
+    static ApiDumpInstance &current() {
+        // Because ApiDumpInstance is a static variable in a static function, there will only be one instance of it.
+        // Additionally, the object will be constructed on the *first* call to current(), rather than at process startup time.
+        static ApiDumpInstance current_instance;
+        return current_instance;
+    }
+
+    void set_vk_instance(VkPhysicalDevice phys_dev, VkInstance instance) {
+        std::lock_guard<std::mutex> lg(vk_instance_mutex);
+        vk_instance_map.insert({phys_dev, instance});
+    }
+    VkInstance get_vk_instance(VkPhysicalDevice phys_dev) {
+        std::lock_guard<std::mutex> lg(vk_instance_mutex);
+        if (vk_instance_map.count(phys_dev) == 0) return VK_NULL_HANDLE;
+        return vk_instance_map.at(phys_dev);
+    }
+
+    // Records may be formatted without the output mutex held, and objects named or destroyed by other threads meanwhile. Looking
+    // up a name doesn't lock, see ApiDumpObjectNames.
+    const ApiDumpObjectNames &object_names() const { return object_name_map; }
+
+    void update_object_name_map(const VkDebugMarkerObjectNameInfoEXT *pNameInfo) {
+        object_name_map.set(pNameInfo->object, pNameInfo->pObjectName);
+    }
+    void update_object_name_map(const VkDebugUtilsObjectNameInfoEXT *pNameInfo) {
+        object_name_map.set(pNameInfo->objectHandle, pNameInfo->pObjectName);
+    }
+
+    // Called once an object was destroyed, and the call destroying it dumped, as its handle may be reused for another object.
+    void erase_object_name(uint64_t handle) { object_name_map.erase(handle); }
+
+    ApiDumpPipelineProfile &pipelineProfile() { return pipeline_profile; }
+
+   private:
+    ApiDumpSettings dump_settings;
+    std::mutex output_mutex;
+    std::mutex frame_mutex;
+    std::atomic<uint64_t> frame_count;
+
+    std::atomic<uint64_t> next_thread_id = 0;
+
+    ApiDumpCommandBuffers cmd_buffer_state;
+
+    // Recomputed for each new frame, and read before any lock is taken by every API call.
+    std::atomic<bool> should_dump_output = true;
+    bool first_func_call_on_frame = true;
+    bool frame_output_open = false;  // Whether the output of an in range frame was started and not closed yet
+
+    // Sampling counters of each function, indexed by ApiDumpFunctionId. Only allocated when sampling is enabled.
+    struct FunctionSampling {
+        std::atomic<uint64_t> calls = 0;             // Calls in the output range, for the sampling interval
+        std::atomic<uint64_t> frame_calls = 0;       // Calls of the frame sampled by the interval and the time budget
+        std::atomic<uint64_t> frame_suppressed = 0;  // Calls of the frame that sampling left out
+    };
+    std::unique_ptr<FunctionSampling[]> function_sampling;
+    std::atomic<uint64_t> frame_dump_ns = 0;  // Time spent in the dumped calls of the frame, for the time budget
+
+    ApiDumpStatistics call_statistics;
+    uint64_t statistics_first_frame = 0;  // First frame of the next statistics summary
+
+    ApiDumpClock clock;
+
+    // Store the VkInstance handle so we don't use null in the call to
+    // vkGetInstanceProcAddr(instance_handle, "vkCreateDevice");
+    std::mutex vk_instance_mutex;
+    std::unordered_map<VkPhysicalDevice, VkInstance> vk_instance_map;
+
+    ApiDumpObjectNames object_name_map;
+
+    ApiDumpPipelineProfile pipeline_profile;
+
+    // Output of the API call the thread is currently formatting when records are buffered.
+    struct ThreadRecord {
+        FormatBuffer buffer;
+        bool next_frame_pending = false;
+        bool drain_pending = false;
+    };
+
+    // A finished record waiting for the writer thread.
+    struct QueuedRecord {
+        std::string text;
+        uint64_t next_frame = 0;  // Frame started once this record is written, 0 if the record doesn't end a frame.
+        std::vector<SuppressedCalls> suppressed;  // Calls sampling left out of the frame this record ends.
+    };
+
+    // Must be called with frame_mutex held. Returns the new frame number, and the calls sampling left out of the frame that
+    // ended in suppressed.
+    uint64_t advanceFrame(std::vector<SuppressedCalls> &suppressed) {
+        suppressed = endFrameSampling();
+        const uint64_t frame = frame_count.load(std::memory_order_relaxed) + 1;
+        frame_count.store(frame, std::memory_order_relaxed);
+        should_dump_output = settings().isFrameInRange(frame);
+        return frame;
+    }
+
+    // Must be called with the output mutex held. Writes the statistics of the frames from the end of the last summary to the
+    // frame before end_frame, if any call was made in them.
+    void writeStatistics(uint64_t end_frame) {
+        const std::vector<ApiDumpFunctionStatistics> summary = call_statistics.summarize();
+        if (!summary.empty()) {
+            settings().writeStatistics(statistics_first_frame, end_frame - 1, summary);
+        }
+        statistics_first_frame = end_frame;
+    }
+
+    // Collects the calls sampling left out of the frame that ends, and starts the per frame limits over.
+    std::vector<SuppressedCalls> endFrameSampling() {
+        std::vector<SuppressedCalls> suppressed;
+        if (!function_sampling) {
+            return suppressed;
+        }
+        for (uint32_t index = 0; index < api_dump_function_count(); ++index) {
+            FunctionSampling &counters = function_sampling[index];
+            counters.frame_calls.store(0, std::memory_order_relaxed);
+            const uint64_t count = counters.frame_suppressed.exchange(0, std::memory_order_relaxed);
+            if (count > 0) {
+                suppressed.push_back({static_cast<ApiDumpFunctionId>(index), count});
+            }
+        }
+        frame_dump_ns.store(0, std::memory_order_relaxed);
+        return suppressed;
+    }
+
+    // Must be called with the output mutex held.
+    void startFrameOutput(uint64_t frame, const std::vector<SuppressedCalls> &suppressed) {
+        if (settings().statisticsMode()) {
+            const uint32_t interval = settings().statisticsInterval();
+            if (interval > 0 && frame - statistics_first_frame >= interval) {
+                writeStatistics(frame);
+                settings().flushOutput(settings().shouldFlush());
+            }
+            settings().rotateOutputFile(frame);
+            first_func_call_on_frame = true;
+            return;
+        }
+        if (frame_output_open) {
+            settings().closeFrameOutput(suppressed);
+        }
+        // Files are only rotated between frames, so that each one holds whole frames
+        settings().rotateOutputFile(frame);
+        frame_output_open = settings().isFrameInRange(frame);
+        if (frame_output_open) {
+            settings().openFrameOutput(frame);
+        }
         first_func_call_on_frame = true;
     }
 
-    bool shouldDumpOutput() {
-        if (!conditional_initialized) {
-            should_dump_output = settings().isFrameInRange(frame_count);
-            conditional_initialized = true;
+    // Must be called with the output mutex held.
+    void appendRecord(const std::string &text) {
+        if (text.empty()) {
+            return;
+        }
+        // Json separators depend on what was written before, which is only known once the record is ordered.
+        if (settings().format() == ApiDumpFormat::Json && !settings().jsonLines() && !firstFunctionCallOnFrame()) {
+            settings().stream() << ",\n";
         }
-        return should_dump_output;
+        settings().writeOutput(text);
     }
 
-    bool firstFunctionCallOnFrame() {
-        if (first_func_call_on_frame) {
-            first_func_call_on_frame = false;
-            return true;
+    void queueRecord(QueuedRecord &&queued, QueueFullPolicy policy) {
+        while (!record_queue->tryPush(std::move(queued))) {
+            if (policy == QueueFullPolicy::Drop) {
+                dropped_records.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            wakeWriter();
+            std::this_thread::yield();
+        }
+        records_queued.fetch_add(1, std::memory_order_release);
+        // Pairs with the fence in writerLoop() so that either the writer sees this record or this thread sees it waiting.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writer_waiting.load(std::memory_order_relaxed)) {
+            wakeWriter();
         }
-        return false;
     }
 
-    std::mutex &outputMutex() { return output_mutex; }
-
-    ApiDumpSettings &settings() { return dump_settings; }
-
-    uint64_t threadID() {
-        std::thread::id this_id = std::this_thread::get_id();
-        std::lock_guard<std::mutex> lg(thread_mutex);
+    void wakeWriter() {
+        std::lock_guard<std::mutex> lg(writer_mutex);
+        writer_cv.notify_one();
+    }
 
-        auto it = thread_map.find(this_id);
-        if (it != thread_map.end()) {
-            return it->second;
+    void startWriter() {
+        if (writer_thread.joinable()) {
+            return;
         }
-
-        thread_map.insert({this_id, thread_map.size()});
-        return thread_map.size() - 1;
+        record_queue = std::make_unique<RecordQueue<QueuedRecord>>(settings().asyncQueueSize());
+        stop_writer = false;
+        writer_thread = std::thread(&ApiDumpInstance::writerLoop, this);
     }
 
-    void setCmdBuffer(VkCommandBuffer cmd_buffer) { this->cmd_buffer = cmd_buffer; }
+    void stopWriter() {
+        if (!writer_thread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lg(writer_mutex);
+            stop_writer = true;
+            writer_cv.notify_one();
+        }
+        writer_thread.join();
+        writer_thread = std::thread();
 
-    VkCommandBufferLevel getCmdBufferLevel() {
-        std::lock_guard<std::mutex> lg(cmd_buffer_state_mutex);
-        const auto level_iter = cmd_buffer_level.find(cmd_buffer);
-        assert(level_iter != cmd_buffer_level.end());
-        const auto level = level_iter->second;
-        return level;
+        const uint64_t dropped = dropped_records.exchange(0);
+        if (dropped > 0) {
+            std::string msg = "api_dump: " + std::to_string(dropped) + " records were dropped because the output queue was full\n";
+#ifdef ANDROID
+            __android_log_print(ANDROID_LOG_DEBUG, "api_dump", "%s", msg.c_str());
+#else
+            fprintf(stderr, "%s", msg.c_str());
+#endif
+        }
     }
 
-    void eraseCmdBuffers(VkDevice device, VkCommandPool cmd_pool, std::vector<VkCommandBuffer> cmd_buffers) {
-        cmd_buffers.erase(std::remove(cmd_buffers.begin(), cmd_buffers.end(), nullptr), cmd_buffers.end());
-        if (!cmd_buffers.empty()) {
-            std::lock_guard<std::mutex> lg(cmd_buffer_state_mutex);
-
-            const auto pool_cmd_buffers_iter = cmd_buffer_pools.find(std::make_pair(device, cmd_pool));
-            assert(pool_cmd_buffers_iter != cmd_buffer_pools.end());
-
-            for (const auto cmd_buffer : cmd_buffers) {
-                pool_cmd_buffers_iter->second.erase(cmd_buffer);
-
-                assert(cmd_buffer_level.count(cmd_buffer) > 0);
-                cmd_buffer_level.erase(cmd_buffer);
+    void writeQueuedRecord(const QueuedRecord &queued) {
+        {
+            std::lock_guard<std::mutex> lg(output_mutex);
+            appendRecord(queued.text);
+            if (queued.next_frame != 0) {
+                startFrameOutput(queued.next_frame, queued.suppressed);
             }
         }
+        records_written.fetch_add(1, std::memory_order_release);
     }
 
-    void addCmdBuffers(VkDevice device, VkCommandPool cmd_pool, std::vector<VkCommandBuffer> cmd_buffers,
-                       VkCommandBufferLevel level) {
-        std::lock_guard<std::mutex> lg(cmd_buffer_state_mutex);
-        auto &pool_cmd_buffers = cmd_buffer_pools[std::make_pair(device, cmd_pool)];
-        pool_cmd_buffers.insert(cmd_buffers.begin(), cmd_buffers.end());
-
-        for (const auto cmd_buffer : cmd_buffers) {
-            assert(cmd_buffer_level.count(cmd_buffer) == 0);
-            cmd_buffer_level[cmd_buffer] = level;
-        }
-    }
+    // Writes queued records in order. Only this thread consumes the queue.
+    void writerLoop() {
+        QueuedRecord queued;
+        for (;;) {
+            bool wrote = false;
+            while (record_queue->tryPop(queued)) {
+                writeQueuedRecord(queued);
+                wrote = true;
+            }
+            if (wrote) {
+                // Flushing once the queue runs dry keeps the file up to date without a flush per record.
+                {
+                    std::lock_guard<std::mutex> lg(output_mutex);
+                    settings().flushOutput(settings().shouldFlush());
+                }
+                drained_cv.notify_all();
+                continue;
+            }
 
-    void eraseCmdBufferPool(VkDevice device, VkCommandPool cmd_pool) {
-        if (cmd_pool != VK_NULL_HANDLE) {
-            std::lock_guard<std::mutex> lg(cmd_buffer_state_mutex);
-
-            const auto cmd_buffers_iter = cmd_buffer_pools.find(std::make_pair(device, cmd_pool));
-            if (cmd_buffers_iter != cmd_buffer_pools.end()) {
-                for (const auto cmd_buffer : cmd_buffers_iter->second) {
-                    assert(cmd_buffer_level.count(cmd_buffer) > 0);
-                    cmd_buffer_level.erase(cmd_buffer);
+            std::unique_lock<std::mutex> lock(writer_mutex);
+            if (stop_writer) {
+                // Producers may still be publishing a claimed cell, give them the chance to finish.
+                if (records_written.load(std::memory_order_acquire) >= records_queued.load(std::memory_order_acquire)) {
+                    return;
                 }
-                cmd_buffers_iter->second.clear();
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            writer_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (record_queue->tryPop(queued)) {
+                // Lost the race with a producer, write the record on the next iteration.
+                writer_waiting.store(false, std::memory_order_relaxed);
+                lock.unlock();
+                writeQueuedRecord(queued);
+                continue;
             }
+            // The timeout covers a wakeup racing with the waiting flag.
+            writer_cv.wait_for(lock, std::chrono::milliseconds(10));
+            writer_waiting.store(false, std::memory_order_relaxed);
         }
     }
 
-    void setIsDynamicScissor(bool is_dynamic_scissor) { this->is_dynamic_scissor = is_dynamic_scissor; }
-    void setIsDynamicViewport(bool is_dynamic_viewport) { this->is_dynamic_viewport = is_dynamic_viewport; }
-    bool getIsDynamicScissor() const { return is_dynamic_scissor; }
-    bool getIsDynamicViewport() const { return is_dynamic_viewport; }
-    void setMemoryHeapCount(uint32_t memory_heap_count) { this->memory_heap_count = memory_heap_count; }
-    uint32_t getMemoryHeapCount() { return memory_heap_count; }
-    void setDescriptorType(VkDescriptorType type) { this->descriptor_type = type; }
-    VkDescriptorType getDescriptorType() { return this->descriptor_type; }
-    void setIsGPLPreRasterOrFragmentShader(bool in) { this->GPLPreRasterOrFragmentShader = in; }
-    bool getIsGPLPreRasterOrFragmentShader() { return this->GPLPreRasterOrFragmentShader; }
-    void setIndirectExecutionSetInfoType(VkIndirectExecutionSetInfoTypeEXT type) { this->indirectExecutionSetInfoType = type; }
-    VkIndirectExecutionSetInfoTypeEXT getIndirectExecutionSetInfoType() { return this->indirectExecutionSetInfoType; }
-    void setIndirectCommandsLayoutToken(VkIndirectCommandsTokenTypeEXT type) { this->indirectCommandsLayoutToken = type; }
-    VkIndirectCommandsTokenTypeEXT getIndirectCommandsLayoutToken() { return this->indirectCommandsLayoutToken; }
-    void setDescriptorMappingSource(VkDescriptorMappingSourceEXT source) { this->descriptorMappingSource = source; }
-    VkDescriptorMappingSourceEXT getDescriptorMappingSource() { return this->descriptorMappingSource; }
-
-    void setSpsMaxSubLayersMinus1(uint8_t sps_max_sub_layers_minus1) {
-        this->sps_max_sub_layers_minus1 = sps_max_sub_layers_minus1;
-    }
-    uint8_t getSpsMaxSubLayersMinus1() { return sps_max_sub_layers_minus1; }
-    void setVpsMaxSubLayersMinus1(uint8_t vps_max_sub_layers_minus1) {
-        this->vps_max_sub_layers_minus1 = vps_max_sub_layers_minus1;
+    // Watches for the signal and the trigger file of the flight recorder, which can't be checked by the calls, since the
+    // application may have stopped making them.
+    void startFlightRecorderWatch() {
+        const int signal_number = settings().flightRecorderSignal();
+        if (watch_thread.joinable() || (signal_number == 0 && settings().flightRecorderTriggerFile().empty())) {
+            return;
+        }
+#if !defined(_WIN32)
+        if (signal_number != 0) {
+            InstallFlightRecorderSignalHandler(signal_number);
+        }
+#endif
+        stop_watch = false;
+        watch_thread = std::thread(&ApiDumpInstance::flightRecorderWatchLoop, this);
     }
-    uint8_t getVpsMaxSubLayersMinus1() { return vps_max_sub_layers_minus1; }
-    void setIsInVps(bool is_in_vps) { this->is_in_vps = is_in_vps; }
-    bool getIsInVps() { return is_in_vps; }
 
-    std::chrono::microseconds current_time_since_start() {
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        return std::chrono::duration_cast<std::chrono::microseconds>(now - program_start);
+    void stopFlightRecorderWatch() {
+        if (!watch_thread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lg(watch_mutex);
+            stop_watch = true;
+            watch_cv.notify_one();
+        }
+        watch_thread.join();
+        watch_thread = std::thread();
     }
 
-    static ApiDumpInstance &current() {
-        // Because ApiDumpInstance is a static variable in a static function, there will only be one instance of it.
-        // Additionally, the object will be constructed on the *first* call to current(), rather than at process startup time.
-        static ApiDumpInstance current_instance;
-        return current_instance;
+    void flightRecorderWatchLoop() {
+        const std::string &trigger_file = settings().flightRecorderTriggerFile();
+        std::unique_lock<std::mutex> lock(watch_mutex);
+        while (!watch_cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return stop_watch; })) {
+            bool triggered = false;
+#if !defined(_WIN32)
+            triggered = flight_recorder_signaled.exchange(false, std::memory_order_relaxed);
+#endif
+            if (!trigger_file.empty()) {
+                if (FILE *file = fopen(trigger_file.c_str(), "r")) {
+                    // Removed so that creating it again triggers another dump
+                    fclose(file);
+                    remove(trigger_file.c_str());
+                    triggered = true;
+                }
+            }
+            if (triggered) {
+                std::lock_guard<std::mutex> lg(output_mutex);
+                settings().dumpFlightRecorder();
+            }
+        }
     }
 
-    std::unordered_map<uint64_t, std::string> object_name_map;
+    std::thread watch_thread;
+    std::mutex watch_mutex;
+    std::condition_variable watch_cv;
+    bool stop_watch = false;
 
-    void set_vk_instance(VkPhysicalDevice phys_dev, VkInstance instance) { vk_instance_map.insert({phys_dev, instance}); }
-    VkInstance get_vk_instance(VkPhysicalDevice phys_dev) const {
-        if (vk_instance_map.count(phys_dev) == 0) return VK_NULL_HANDLE;
-        return vk_instance_map.at(phys_dev);
-    }
+    std::unique_ptr<RecordQueue<QueuedRecord>> record_queue;
+    std::thread writer_thread;
+    std::mutex writer_mutex;
+    std::condition_variable writer_cv;
+    std::condition_variable drained_cv;
+    bool stop_writer = false;
+    std::atomic<bool> writer_waiting = false;
+    std::atomic<uint64_t> records_queued = 0;
+    std::atomic<uint64_t> records_written = 0;
+    std::atomic<uint64_t> dropped_records = 0;
 
-    void update_object_name_map(const VkDebugMarkerObjectNameInfoEXT *pNameInfo) {
-        if (pNameInfo->pObjectName)
-            object_name_map[pNameInfo->object] = pNameInfo->pObjectName;
-        else
-            object_name_map.erase(pNameInfo->object);
-    }
-    void update_object_name_map(const VkDebugUtilsObjectNameInfoEXT *pNameInfo) {
-        if (pNameInfo->pObjectName)
-            object_name_map[pNameInfo->objectHandle] = pNameInfo->pObjectName;
-        else
-            object_name_map.erase(pNameInfo->objectHandle);
+    static ThreadRecord &threadRecord() {
+        thread_local ThreadRecord record;
+        return record;
     }
 
-   private:
-    ApiDumpSettings dump_settings;
-    std::mutex output_mutex;
-    std::mutex frame_mutex;
-    uint64_t frame_count;
-
-    std::mutex thread_mutex;
-    std::unordered_map<std::thread::id, uint64_t> thread_map;
+    // Whether the API call the thread is in is dumped, latched for the whole call by beginCall().
+    enum class CallState : uint8_t { None, Dumped, Skipped };
 
-    std::mutex cmd_buffer_state_mutex;
-    std::map<std::pair<VkDevice, VkCommandPool>, std::unordered_set<VkCommandBuffer>> cmd_buffer_pools;
-    std::unordered_map<VkCommandBuffer, VkCommandBufferLevel> cmd_buffer_level;
-
-    bool conditional_initialized = false;
-    bool should_dump_output = true;
-    bool first_func_call_on_frame = true;
+    static const uint32_t kNoFunction = UINT32_MAX;
 
-    std::chrono::system_clock::time_point program_start;
+    struct ThreadCall {
+        CallState state = CallState::None;
+        uint32_t function = kNoFunction;  // ApiDumpFunctionId of the call, kNoFunction for output that isn't an API call
+        bool timed = false;               // Whether the call counts against the time budget of the frame
+        std::chrono::steady_clock::time_point start;
+        // Set by ApiDumpCallTimer, which blocking functions run before beginCall(), and cleared by endCall()
+        bool next_layer_timed = false;
+        uint64_t next_layer_entry_ns = 0;
+        uint64_t next_layer_return_ns = 0;
+    };
 
-    // Store the VkInstance handle so we don't use null in the call to
-    // vkGetInstanceProcAddr(instance_handle, "vkCreateDevice");
-    std::unordered_map<VkPhysicalDevice, VkInstance> vk_instance_map;
+    static ThreadCall &threadCall() {
+        thread_local ThreadCall call;
+        return call;
+    }
 
-    // Storage for getCmdBufferLevel() which is called in a place where it needs access to the cmd_buffer but it isn't present in
-    // the current structure.
-    VkCommandBuffer cmd_buffer;
+    bool latchCall(ThreadCall &call) {
+        bool dumped = !settings().statisticsMode() && should_dump_output.load(std::memory_order_relaxed);
+        if (dumped && call.function != kNoFunction) {
+            dumped = settings().isFunctionDumped(static_cast<ApiDumpFunctionId>(call.function)) && sampleCall(call.function);
+        }
+        call.state = dumped ? CallState::Dumped : CallState::Skipped;
+        call.timed = dumped && function_sampling && settings().sampling().frame_budget_ns > 0;
+        if (call.timed) {
+            call.start = std::chrono::steady_clock::now();
+        }
+        return dumped;
+    }
 
-    // Storage for VkPipelineViewportStateCreateInfo which needs to ignore the scissor and viewport pipeline state if their
-    // respective dynamic state is set.
-    bool is_dynamic_scissor;
-    bool is_dynamic_viewport;
+    // Returns whether sampling keeps a call of the function, and counts the call as suppressed otherwise. Calls are only
+    // sampled in the frames of the output range.
+    bool sampleCall(uint32_t function) {
+        if (!function_sampling) {
+            return true;
+        }
+        const SamplingSettings &sampling = settings().sampling();
+        FunctionSampling &counters = function_sampling[function];
+        bool sampled = counters.calls.fetch_add(1, std::memory_order_relaxed) % sampling.interval == 0;
+        if (sampled && sampling.frame_budget_ns > 0) {
+            sampled = frame_dump_ns.load(std::memory_order_relaxed) < sampling.frame_budget_ns;
+        }
+        if (sampled && sampling.max_calls_per_frame > 0) {
+            sampled = counters.frame_calls.fetch_add(1, std::memory_order_relaxed) < sampling.max_calls_per_frame;
+        }
+        if (!sampled) {
+            counters.frame_suppressed.fetch_add(1, std::memory_order_relaxed);
+        }
+        return sampled;
+    }
 
-    // Storage for VkPhysicalDeviceMemoryBudgetPropertiesEXT which needs the number of heaps from VkPhysicalDeviceMemoryProperties
-    uint32_t memory_heap_count;
+    static ApiDumpCallContext::DecodeState &decodeState() { return ApiDumpCallContext::decodeState(); }
+};
 
-    // Storage for the VkDescriptorDataEXT/VkResourceDescriptorDataEXT union to know what is the active element
-    VkDescriptorType descriptor_type;
+// Serializes the output of one API call. By default the output mutex is held for the lifetime of the guard, including the call
+// down the chain. When records are buffered, the call is formatted into a per-thread buffer with no lock held and only the
+// append of the finished record to the output is serialized. Calls made while the frame is outside the output range, of
+// functions that are filtered out, or that sampling leaves out, write nothing and take no lock.
+class ApiDumpRecordGuard {
+   public:
+    ApiDumpRecordGuard(ApiDumpInstance &dump_inst, ApiDumpFunctionId function)
+        : dump_inst(dump_inst), buffered(dump_inst.settings().bufferRecords()), locked(dump_inst.beginCall(function) && !buffered) {
+        begin();
+    }
+    // For output that isn't an API call.
+    explicit ApiDumpRecordGuard(ApiDumpInstance &dump_inst)
+        : dump_inst(dump_inst), buffered(dump_inst.settings().bufferRecords()), locked(dump_inst.beginCall() && !buffered) {
+        begin();
+    }
+    ~ApiDumpRecordGuard() {
+        dump_inst.endCall();
+        if (buffered) {
+            dump_inst.endRecord();
+        } else if (locked) {
+            dump_inst.outputMutex().unlock();
+        }
+    }
+    ApiDumpRecordGuard(const ApiDumpRecordGuard &) = delete;
+    ApiDumpRecordGuard &operator=(const ApiDumpRecordGuard &) = delete;
 
-    // True when creating a graphics pipeline library with VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT or
-    // VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT set in the VkGraphicsPipelineLibraryCreateInfoEXT struct.
-    bool GPLPreRasterOrFragmentShader;
+    bool holdsOutputLock() const { return locked; }
 
-    // Storage for the VkIndirectExecutionSetInfoEXT union to know which is the active element
-    VkIndirectExecutionSetInfoTypeEXT indirectExecutionSetInfoType;
+   private:
+    void begin() {
+        if (buffered) {
+            dump_inst.beginRecord();
+        } else if (locked) {
+            dump_inst.outputMutex().lock();
+        }
+    }
 
-    // Storage for the VkIndirectCommandsTokenDataEXT union to know which is the active element
-    VkIndirectCommandsTokenTypeEXT indirectCommandsLayoutToken;
+    ApiDumpInstance &dump_inst;
+    // Latched at construction since vkCreateInstance reads the settings while holding the guard.
+    const bool buffered;
+    const bool locked;
+};
 
-    // Storage for the VkDescriptorMappingSourceDataEXT union
-    VkDescriptorMappingSourceEXT descriptorMappingSource;
+// Times the call of a function down the chain for the statistics output mode and for the timestamps of the dump, and does
+// nothing otherwise.
+class ApiDumpCallTimer {
+   public:
+    ApiDumpCallTimer(ApiDumpInstance &dump_inst, ApiDumpFunctionId function)
+        : dump_inst(dump_inst),
+          function(function),
+          measured(dump_inst.isCallMeasured(function)),
+          timestamped(dump_inst.isCallTimestamped()) {
+        if (measured || timestamped) {
+            start = dump_inst.current_time_since_start();
+        }
+    }
+    ApiDumpCallTimer(const ApiDumpCallTimer &) = delete;
+    ApiDumpCallTimer &operator=(const ApiDumpCallTimer &) = delete;
 
-    // Storage for StdVideoH265HrdParameters's array length for pSubLayerHrdParametersNal and pSubLayerHrdParametersVcl
-    uint8_t sps_max_sub_layers_minus1;
-    uint8_t vps_max_sub_layers_minus1;
+    // Called once the call down the chain returned.
+    void stop() {
+        if (!measured && !timestamped) {
+            return;
+        }
+        const std::chrono::nanoseconds end = dump_inst.current_time_since_start();
+        if (measured) {
+            // Most calls take less than a microsecond, so the latency is counted in nanoseconds
+            dump_inst.recordCallStatistics(function, end > start ? static_cast<uint64_t>((end - start).count()) : 0);
+        }
+        if (timestamped) {
+            dump_inst.setNextLayerCallTimes(static_cast<uint64_t>(start.count()), static_cast<uint64_t>(end.count()));
+        }
+    }
 
-    // True if StdVideoH265HrdParameters is currently in StdVideoH265VideoParameterSet, false if it is in
-    // StdVideoH265SequenceParameterSetVui. Needed to determine whether to use vps_max_sub_layers_minus1 or
-    // sps_max_sub_layers_minus1
-    bool is_in_vps;
+   private:
+    ApiDumpInstance &dump_inst;
+    const ApiDumpFunctionId function;
+    const bool measured;
+    const bool timestamped;
+    std::chrono::nanoseconds start{};
 };
 
 enum class OutputConstruct {
@@ -1105,22 +2628,19 @@ inline bool checkForGPLPreRasterOrFragmentShader(const VkGraphicsPipelineCreateI
 
 //==================================== Templated Helpers ======================================//
 
-inline void flush(const ApiDumpSettings &settings) {
-    if (settings.shouldFlush()) {
-        settings.stream().flush();
-    }
-}
+inline void flush(const ApiDumpSettings &settings) { settings.flushOutput(settings.shouldFlush()); }
 
 template <ApiDumpFormat Format>
 void dump_value_start(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Html) settings.stream() << "<div class=\'val\'>";
-    if constexpr (Format == ApiDumpFormat::Json) settings.stream() << " \"";
+    if constexpr (Format == ApiDumpFormat::Json) settings.stream() << (settings.jsonLines() ? "\"" : " \"");
+    if constexpr (Format == ApiDumpFormat::Trace) settings.stream() << '"';
 }
 
 template <ApiDumpFormat Format>
 void dump_value_end(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Html) settings.stream() << "</div>";
-    if constexpr (Format == ApiDumpFormat::Json) settings.stream() << '"';
+    if constexpr (Format == ApiDumpFormat::Json || Format == ApiDumpFormat::Trace) settings.stream() << '"';
 }
 
 template <ApiDumpFormat Format, typename... T>
@@ -1133,9 +2653,8 @@ void dump_value(const ApiDumpSettings &settings, T &&...values) {
 template <ApiDumpFormat Format, typename... T>
 void dump_value_hex(const ApiDumpSettings &settings, T &&...values) {
     dump_value_start<Format>(settings);
-    settings.stream() << "0x" << std::hex;
-    (settings.stream() << ... << values);
-    settings.stream() << std::dec;
+    settings.stream() << "0x";
+    (settings.stream().writeHex(values), ...);
     dump_value_end<Format>(settings);
 }
 
@@ -1153,29 +2672,29 @@ template <ApiDumpFormat Format, typename T>
 void dump_enum(const ApiDumpSettings &settings, const char *name, T value) {
     if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
         dump_value<Format>(settings, name, " (", value, ")");
-    } else if constexpr (Format == ApiDumpFormat::Json) {
+    } else if constexpr (Format == ApiDumpFormat::Json || Format == ApiDumpFormat::Trace) {
         dump_value<Format>(settings, name);
     }
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_pNext_struct_name(const void *object, const ApiDumpSettings &settings, const char *type_name, const char *var_name,
                             int indents);
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_pNext_trampoline(const void *object, const ApiDumpSettings &settings, const char *type_name, const char *var_name,
                            int indents);
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_pNext(const void *object, const ApiDumpSettings &settings, const char *type_string, const char *name, int indents) {
     if constexpr (Format == ApiDumpFormat::Text) {
-        dump_pNext_struct_name<Format>(object, settings, type_string, name, indents);
+        dump_pNext_struct_name<Format, Features>(object, settings, type_string, name, indents);
     } else if constexpr (Format == ApiDumpFormat::Html || Format == ApiDumpFormat::Json) {
-        dump_pNext_trampoline<Format>(object, settings, type_string, name, indents);
+        dump_pNext_trampoline<Format, Features>(object, settings, type_string, name, indents);
     }
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_address(const ApiDumpSettings &settings, const void *address) {
     if (address == NULL) {
         // TEMPORARY to minimize diff in output while developing.
@@ -1184,8 +2703,8 @@ void dump_address(const ApiDumpSettings &settings, const void *address) {
         } else {
             dump_value<Format>(settings, "NULL");
         }
-    } else if (settings.showAddress())
-        dump_value<Format>(settings, address);
+    } else if (settings.showAddress<Features>())
+        dump_value<Format>(settings, settings.displayAddress(address));
     else
         dump_value<Format>(settings, "address");
 }
@@ -1193,30 +2712,77 @@ void dump_address(const ApiDumpSettings &settings, const void *address) {
 template <ApiDumpFormat Format>
 void dump_separate_members(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Json) {
-        settings.stream() << ",\n";
+        settings.stream() << (settings.jsonLines() ? "," : ",\n");
     }
 }
 
 //============================== Json formatting helper functions ==============================//
 
+// JSON Lines output has no newlines within a call, and no indentation since its indent size is 0.
+inline void dump_json_newline(const ApiDumpSettings &settings) {
+    if (!settings.jsonLines()) settings.stream() << '\n';
+}
 inline void dump_json_key_start_array(const ApiDumpSettings &settings, int indents, const char *key) {
+    if (settings.jsonLines()) {
+        settings.stream() << '"' << key << "\":[";
+        return;
+    }
     settings.stream() << settings.indentation(indents) << "\"" << key << "\" :\n" << settings.indentation(indents) << "[\n";
 }
 inline void dump_json_end_array(const ApiDumpSettings &settings, int indents) {
     settings.stream() << settings.indentation(indents) << "]";
 }
 inline void dump_json_newline_end_array(const ApiDumpSettings &settings, int indents) {
-    settings.stream() << "\n";
+    dump_json_newline(settings);
     dump_json_end_array(settings, indents);
 }
 inline void dump_json_start_object(const ApiDumpSettings &settings, int indents) {
-    settings.stream() << settings.indentation(indents) << "{\n";
+    settings.stream() << settings.indentation(indents) << (settings.jsonLines() ? "{" : "{\n");
 }
 inline void dump_json_end_object(const ApiDumpSettings &settings, int indents) {
-    settings.stream() << "\n" << settings.indentation(indents) << "}";
+    dump_json_newline(settings);
+    settings.stream() << settings.indentation(indents) << "}";
 }
 inline void dump_json_key(const ApiDumpSettings &settings, int indents, const char *key) {
-    settings.stream() << settings.indentation(indents) << "\"" << key << "\" :";
+    settings.stream() << settings.indentation(indents) << "\"" << key << (settings.jsonLines() ? "\":" : "\" :");
+}
+
+// Numbers are written unquoted in JSON Lines output, except for the infinities and NaNs JSON has no numbers for.
+template <typename T>
+void dump_json_number(const ApiDumpSettings &settings, const T &value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(value)) {
+            dump_value<ApiDumpFormat::Json>(settings, value);
+            return;
+        }
+    }
+    if (settings.jsonLines()) {
+        // Promoted, so that 8-bit integers are written as numbers rather than characters
+        settings.stream() << +value;
+    } else {
+        dump_value<ApiDumpFormat::Json>(settings, value);
+    }
+}
+
+// The characters that JSON strings can't hold are written as escapes, so that a string never ends the value or the line early.
+inline void dump_json_escaped(const ApiDumpSettings &settings, const char *string) {
+    for (const char *c = string; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            settings.stream() << '\\' << *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+            settings.stream() << escaped;
+        } else {
+            settings.stream() << *c;
+        }
+    }
+}
+
+template <typename T>
+void dump_json_key_number(const ApiDumpSettings &settings, int indents, const char *key, const T &value) {
+    dump_json_key(settings, indents, key);
+    dump_json_number(settings, value);
 }
 
 template <typename... T>
@@ -1225,23 +2791,91 @@ void dump_json_key_value(const ApiDumpSettings &settings, int indents, const cha
     dump_value<ApiDumpFormat::Json>(settings, values...);
 }
 
-inline void dump_json_key_address(const ApiDumpSettings &settings, int indents, const void *address) {
+//============================== Trace formatting helper functions ==============================//
+
+// Trace timestamps are in microseconds, written to the nanosecond.
+inline void dump_trace_time(const ApiDumpSettings &settings, uint64_t time_ns) {
+    char text[32];
+    snprintf(text, sizeof(text), "%" PRIu64 ".%03" PRIu64, time_ns / 1000, time_ns % 1000);
+    settings.stream() << text;
+}
+
+inline void dump_trace_string(const ApiDumpSettings &settings, const char *string) {
+    settings.stream() << '"';
+    dump_json_escaped(settings, string);
+    settings.stream() << '"';
+}
+
+// The top level value of a parameter, in the args of the event of its call. Pointers and handles are written as addresses,
+// what they point to is left out.
+template <typename T>
+void dump_trace_arg(const ApiDumpSettings &settings, const char *name, const T &value) {
+    settings.stream() << ",\"" << name << "\":";
+    if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>) {
+        if (value == nullptr) {
+            settings.stream() << "null";
+        } else {
+            dump_trace_string(settings, value);
+        }
+    } else if constexpr (std::is_pointer_v<T>) {
+        if (value == nullptr) {
+            settings.stream() << "null";
+        } else if (settings.showAddress()) {
+            settings.stream() << '"' << settings.displayAddress(reinterpret_cast<const void *>(value)) << '"';
+        } else {
+            settings.stream() << "\"address\"";
+        }
+    } else if constexpr (std::is_floating_point_v<T>) {
+        // Json has no infinities or NaNs
+        if (std::isfinite(value)) {
+            settings.stream() << value;
+        } else {
+            settings.stream() << '"' << value << '"';
+        }
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        settings.stream() << static_cast<int64_t>(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        settings.stream() << static_cast<uint64_t>(value);
+    } else if constexpr (std::is_enum_v<T>) {
+        settings.stream() << static_cast<int64_t>(value);
+    } else {
+        settings.stream() << "null";
+    }
+}
+
+// When the layer was called for the call the calling thread is dumping, the start of its trace event when the call down the
+// chain wasn't timed.
+inline uint64_t &trace_event_start() {
+    thread_local uint64_t start_ns = 0;
+    return start_ns;
+}
+
+// Start and end of the trace event of the call the calling thread is dumping.
+inline void trace_event_times(ApiDumpInstance &dump_inst, uint64_t &start_ns, uint64_t &end_ns) {
+    if (!dump_inst.nextLayerCallTimes(start_ns, end_ns)) {
+        start_ns = trace_event_start();
+        end_ns = start_ns;
+    }
+}
+
+template <ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
+void dump_json_key_address(const ApiDumpSettings &settings, int indents, const void *address) {
     dump_json_key(settings, indents, "address");
-    dump_address<ApiDumpFormat::Json>(settings, address);
+    dump_address<ApiDumpFormat::Json, Features>(settings, address);
 }
 
 //================================ Common Output Functions ================================//
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_start(const ApiDumpSettings &settings, OutputConstruct construct, const char *type_string, const char *name, int indents,
                 const void *address = nullptr) {
     if constexpr (Format == ApiDumpFormat::Text) {
-        settings.formatNameType(indents, name, type_string);
+        settings.formatNameType<Features>(indents, name, type_string);
         if (construct == OutputConstruct::pointer) {
-            dump_address<Format>(settings, address);
+            dump_address<Format, Features>(settings, address);
         } else if (construct == OutputConstruct::api_struct || construct == OutputConstruct::api_union) {
-            if (settings.showAddress())
-                dump_value<Format>(settings, address);
+            if (settings.showAddress<Features>())
+                dump_value<Format>(settings, settings.displayAddress(address));
             else
                 dump_value<Format>(settings, "address");
             if (construct == OutputConstruct::api_struct) {
@@ -1254,20 +2888,20 @@ void dump_start(const ApiDumpSettings &settings, OutputConstruct construct, cons
     } else if constexpr (Format == ApiDumpFormat::Html) {
         settings.stream() << "<details class='data'><summary>";
         settings.stream() << "<div class='var'>" << name << "</div>";
-        if (settings.showType()) {
+        if (settings.showType<Features>()) {
             settings.stream() << "<div class='type'>" << type_string << "</div>";
         }
         if (construct == OutputConstruct::pointer) {
-            dump_address<Format>(settings, address);
+            dump_address<Format, Features>(settings, address);
         } else if (construct == OutputConstruct::api_struct) {
-            if (settings.showAddress())
-                dump_value<Format>(settings, address, "\n");
+            if (settings.showAddress<Features>())
+                dump_value<Format>(settings, settings.displayAddress(address), "\n");
             else
                 dump_value<Format>(settings, "address\n");
             settings.stream() << "</summary>";
         } else if (construct == OutputConstruct::api_union) {
-            if (settings.showAddress())
-                dump_value<Format>(settings, address, " (Union):\n");
+            if (settings.showAddress<Features>())
+                dump_value<Format>(settings, settings.displayAddress(address), " (Union):\n");
             else
                 dump_value<Format>(settings, "address (Union):\n");
             settings.stream() << "</summary>";
@@ -1285,7 +2919,7 @@ void dump_start(const ApiDumpSettings &settings, OutputConstruct construct, cons
 
         if (construct == OutputConstruct::pointer || address != nullptr) {
             dump_separate_members<ApiDumpFormat::Json>(settings);
-            dump_json_key_address(settings, indents + 1, address);
+            dump_json_key_address<Features>(settings, indents + 1, address);
         }
         if (construct != OutputConstruct::pointer) {
             dump_separate_members<ApiDumpFormat::Json>(settings);
@@ -1318,62 +2952,62 @@ void dump_end(const ApiDumpSettings &settings, OutputConstruct construct, int in
     }
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_nullptr(const ApiDumpSettings &settings, const char *type_string, const char *name, int indents) {
-    dump_start<Format>(settings, OutputConstruct::pointer, type_string, name, indents);
+    dump_start<Format, Features>(settings, OutputConstruct::pointer, type_string, name, indents);
     dump_end<Format>(settings, OutputConstruct::pointer, indents);
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_char(const char *object, const ApiDumpSettings &settings, const char *type_string, const char *name, int indents,
                const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::value, type_string, name, indents, address);
+    dump_start<Format, Features>(settings, OutputConstruct::value, type_string, name, indents, address);
     if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
         if (object == NULL)
             dump_value<Format>(settings, "NULL");
         else
             dump_value<Format>(settings, '"', object, '"');
     } else if constexpr (Format == ApiDumpFormat::Json) {
-        dump_value<Format>(settings, (object != NULL ? object : ""));
+        dump_value_start<Format>(settings);
+        if (object != NULL) dump_json_escaped(settings, object);
+        dump_value_end<Format>(settings);
     }
     dump_end<Format>(settings, OutputConstruct::value, indents);
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_void(const void *object, const ApiDumpSettings &settings, const char *type_string, const char *name, int indents,
                const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::pointer, type_string, name, indents, object);
+    dump_start<Format, Features>(settings, OutputConstruct::pointer, type_string, name, indents, object);
     dump_end<Format>(settings, OutputConstruct::pointer, indents);
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_api_version(uint32_t api_version, const ApiDumpSettings &settings, const char *type_string, const char *name, int indents,
                       const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::value, type_string, name, indents, address);
+    dump_start<Format, Features>(settings, OutputConstruct::value, type_string, name, indents, address);
     dump_value<Format>(settings, api_version, " (", VK_API_VERSION_MAJOR(api_version), ".", VK_API_VERSION_MINOR(api_version), ".",
                        VK_API_VERSION_PATCH(api_version), ")");
     dump_end<Format>(settings, OutputConstruct::value, indents);
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_special(const char *const &text, const ApiDumpSettings &settings, const char *type_string, const char *name,
                   int indents) {
-    dump_start<Format>(settings, OutputConstruct::value, type_string, name, indents, text);
+    dump_start<Format, Features>(settings, OutputConstruct::value, type_string, name, indents, text);
     dump_value<Format>(settings, text);
     dump_end<Format>(settings, OutputConstruct::value, indents);
 }
 
-template <ApiDumpFormat Format, typename T>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
 void dump_handle(T object, const ApiDumpSettings &settings, const char *type_string, const char *name, int indents,
                  const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::value, type_string, name, indents, address);
-    if (settings.showAddress()) {
+    dump_start<Format, Features>(settings, OutputConstruct::value, type_string, name, indents, address);
+    if (settings.showAddress<Features>()) {
         if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
-            std::unordered_map<uint64_t, std::string>::const_iterator it =
-                ApiDumpInstance::current().object_name_map.find((uint64_t)object);
-            if (it != ApiDumpInstance::current().object_name_map.end()) {
-                dump_value<Format>(settings, object, " [", it->second, "]");
-            } else {
+            const bool named = ApiDumpInstance::current().object_names().visit(
+                (uint64_t)object, [&](const std::string &object_name) { dump_value<Format>(settings, object, " [", object_name, "]"); });
+            if (!named) {
                 dump_value<Format>(settings, object);
             }
         } else if constexpr (Format == ApiDumpFormat::Json) {
@@ -1385,67 +3019,71 @@ void dump_handle(T object, const ApiDumpSettings &settings, const char *type_str
     dump_end<Format>(settings, OutputConstruct::value, indents);
 }
 
-template <ApiDumpFormat Format, typename T>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
 std::enable_if_t<!std::is_pointer_v<T>> dump_type(const T &object, const ApiDumpSettings &settings, const char *type_string,
                                                   const char *name, int indents, const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::value, type_string, name, indents, address);
-    dump_value<Format>(settings, object);
+    dump_start<Format, Features>(settings, OutputConstruct::value, type_string, name, indents, address);
+    if constexpr (Format == ApiDumpFormat::Json && std::is_arithmetic_v<T> && !std::is_same_v<T, char>) {
+        dump_json_number(settings, object);
+    } else {
+        dump_value<Format>(settings, object);
+    }
     dump_end<Format>(settings, OutputConstruct::value, indents);
 }
 
-template <ApiDumpFormat Format, typename T>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
 std::enable_if_t<std::is_pointer_v<T>> dump_type(const T &object, const ApiDumpSettings &settings, const char *type_string,
                                                  const char *name, int indents, const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::pointer, type_string, name, indents, object);
+    dump_start<Format, Features>(settings, OutputConstruct::pointer, type_string, name, indents, object);
     dump_end<Format>(settings, OutputConstruct::pointer, indents);
 }
 
-template <ApiDumpFormat Format, typename T>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
 std::enable_if_t<!std::is_pointer_v<T>> dump_type_hex(const T &object, const ApiDumpSettings &settings, const char *type_string,
                                                       const char *name, int indents, const void *address = nullptr) {
-    dump_start<Format>(settings, OutputConstruct::value, type_string, name, indents, address);
+    dump_start<Format, Features>(settings, OutputConstruct::value, type_string, name, indents, address);
     dump_value_hex<Format>(settings, object);
     dump_end<Format>(settings, OutputConstruct::value, indents);
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_uint64_t_as_pointer(const uint64_t object, const ApiDumpSettings &settings, const char *type_string, const char *name,
                               int indents) {
-    dump_start<Format>(settings, OutputConstruct::pointer, type_string, name, indents,
-                       reinterpret_cast<const void *>(static_cast<uintptr_t>(object)));
+    dump_start<Format, Features>(settings, OutputConstruct::pointer, type_string, name, indents,
+                                 reinterpret_cast<const void *>(static_cast<uintptr_t>(object)));
     dump_end<Format>(settings, OutputConstruct::pointer, indents);
 }
 
-template <ApiDumpFormat Format, typename T, typename DumpValue>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T, typename DumpValue>
 void dump_pointer(const T *object, const ApiDumpSettings &settings, const char *type_string, const char *name, int indents,
                   DumpValue dump_value) {
     if (object == NULL) {
-        dump_nullptr<Format>(settings, type_string, name, indents);
+        dump_nullptr<Format, Features>(settings, type_string, name, indents);
     } else {
         dump_value(*object, settings, type_string, name, indents, object);
     }
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_array_start(const void *array, size_t len, const ApiDumpSettings &settings, const char *type_string, const char *name,
                       int indents) {
     if constexpr (Format == ApiDumpFormat::Text) {
-        dump_start<Format>(settings, OutputConstruct::pointer, type_string, name, indents, array);
+        dump_start<Format, Features>(settings, OutputConstruct::pointer, type_string, name, indents, array);
         settings.stream() << "\n";
     } else if constexpr (Format == ApiDumpFormat::Html) {
-        dump_start<Format>(settings, OutputConstruct::api_struct, type_string, name, indents, array);
+        dump_start<Format, Features>(settings, OutputConstruct::api_struct, type_string, name, indents, array);
     } else if constexpr (Format == ApiDumpFormat::Json) {
         dump_json_start_object(settings, indents);
         dump_json_key_value(settings, indents + 1, "type", type_string);
         dump_separate_members<Format>(settings);
         dump_json_key_value(settings, indents + 1, "name", name);
         dump_separate_members<Format>(settings);
-        dump_json_key_address(settings, indents + 1, array);
+        dump_json_key_address<Features>(settings, indents + 1, array);
         if (len > 0 && array != NULL) {
             dump_separate_members<Format>(settings);
             dump_json_key_start_array(settings, indents + 1, "elements");
         } else {
-            settings.stream() << "\n";
+            dump_json_newline(settings);
         }
     }
 }
@@ -1462,101 +3100,103 @@ void dump_array_end(const void *array, size_t len, const ApiDumpSettings &settin
     }
 }
 
-template <ApiDumpFormat Format, size_t N, typename T, typename DumpElement>
+// Sets element_name to the name of an array element without going through a stream, reusing its storage. Json doesn't repeat
+// the name of the array.
+template <ApiDumpFormat Format>
+void set_element_name(std::string &element_name, const char *name, size_t index) {
+    if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
+        element_name = name;
+    } else {
+        element_name.clear();
+    }
+    char digits[24];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), index);
+    element_name += '[';
+    element_name.append(digits, result.ptr);
+    element_name += ']';
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, size_t N, typename T, typename DumpElement>
 void dump_double_array(const T(array)[][N], size_t len1, size_t len2, const ApiDumpSettings &settings, const char *type_string,
                        const char *name, const char *element_type, int indents, DumpElement dump_element) {
     if (len1 == 0 || len2 == 0) {
         return;
     }
-    dump_array_start<Format>(array, len1 * len2, settings, type_string, name, indents);
+    dump_array_start<Format, Features>(array, len1 * len2, settings, type_string, name, indents);
+    std::string row_name;
+    std::string index_name;
     for (size_t i = 0; i < len1; ++i) {
+        set_element_name<Format>(row_name, name, i);
         for (size_t j = 0; j < len2; ++j) {
-            std::stringstream stream;
-            if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
-                stream << name;
-            }
-            stream << "[" << i << "][" << j << "]";
-            std::string indexName = stream.str();
-            dump_element(array[i][j], settings, element_type, indexName.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
+            set_element_name<ApiDumpFormat::Text>(index_name, row_name.c_str(), j);
+            dump_element(array[i][j], settings, element_type, index_name.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
                          nullptr);
             if constexpr (Format == ApiDumpFormat::Json) {
-                if (i < len1 - 1 && j < len2 - 1) settings.stream() << ',';
-                settings.stream() << "\n";
+                if (i < len1 - 1 || j < len2 - 1) settings.stream() << ',';
+                dump_json_newline(settings);
             }
         }
     }
     dump_array_end<Format>(array, len1 * len2, settings, indents);
 }
 
-template <ApiDumpFormat Format, size_t N, typename T, typename DumpElement>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, size_t N, typename T, typename DumpElement>
 void dump_single_array(const T (&array)[N], size_t len, const ApiDumpSettings &settings, const char *type_string, const char *name,
                        const char *element_type, int indents, DumpElement dump_element) {
     if (len == 0) {
         return;
     }
-    dump_array_start<Format>(array, len, settings, type_string, name, indents);
+    dump_array_start<Format, Features>(array, len, settings, type_string, name, indents);
+    std::string index_name;
     for (size_t i = 0; i < len; ++i) {
-        std::stringstream stream;
-        if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
-            stream << name;
-        }
-        stream << "[" << i << "]";
-        std::string indexName = stream.str();
-        dump_element(array[i], settings, element_type, indexName.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
+        set_element_name<Format>(index_name, name, i);
+        dump_element(array[i], settings, element_type, index_name.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
                      nullptr);
         if constexpr (Format == ApiDumpFormat::Json) {
             if (i < len - 1) settings.stream() << ',';
-            settings.stream() << "\n";
+            dump_json_newline(settings);
         }
     }
     dump_array_end<Format>(array, len, settings, indents);
 }
 
-template <ApiDumpFormat Format, typename T, typename DumpElement>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T, typename DumpElement>
 void dump_pointer_array(const T *array, size_t len, const ApiDumpSettings &settings, const char *type_string, const char *name,
                         const char *element_type, int indents, DumpElement dump_element) {
     if (array == NULL || len == 0) {
-        dump_nullptr<Format>(settings, type_string, name, indents);
+        dump_nullptr<Format, Features>(settings, type_string, name, indents);
         return;
     }
-    dump_array_start<Format>(array, len, settings, type_string, name, indents);
+    dump_array_start<Format, Features>(array, len, settings, type_string, name, indents);
+    std::string index_name;
     for (size_t i = 0; i < len; ++i) {
-        std::stringstream stream;
-        if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
-            stream << name;
-        }
-        stream << "[" << i << "]";
-        std::string indexName = stream.str();
-        dump_element(array[i], settings, element_type, indexName.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
+        set_element_name<Format>(index_name, name, i);
+        dump_element(array[i], settings, element_type, index_name.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
                      array + i);
         if constexpr (Format == ApiDumpFormat::Json) {
             if (i < len - 1) settings.stream() << ',';
-            settings.stream() << "\n";
+            dump_json_newline(settings);
         }
     }
     dump_array_end<Format>(array, len, settings, indents);
 }
 
-template <ApiDumpFormat Format, typename T, typename DumpElement>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T, typename DumpElement>
 void dump_double_pointer_array(const T *const *array, size_t len, const ApiDumpSettings &settings, const char *type_string,
                                const char *name, const char *element_type, int indents, DumpElement dump_element) {
     if (array == nullptr || len == 0) {
-        dump_nullptr<Format>(settings, type_string, name, indents);
+        dump_nullptr<Format, Features>(settings, type_string, name, indents);
         return;
     }
-    dump_array_start<Format>(array, len, settings, type_string, name, indents);
+    dump_array_start<Format, Features>(array, len, settings, type_string, name, indents);
+    std::string index_name;
     for (size_t i = 0; i < len; ++i) {
-        std::stringstream stream;
-        if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
-            stream << name;
-        }
-        stream << "[" << i << "]";
-        std::string indexName = stream.str();
-        dump_pointer<Format>(array[i], settings, element_type, indexName.c_str(), indents + (Format == ApiDumpFormat::Json ? 2 : 1),
-                             dump_element);
+        set_element_name<Format>(index_name, name, i);
+        dump_pointer<Format, Features>(array[i], settings, element_type, index_name.c_str(),
+                                       indents + (Format == ApiDumpFormat::Json ? 2 : 1), dump_element);
         if constexpr (Format == ApiDumpFormat::Json) {
             if (i < len - 1) settings.stream() << ',';
-            settings.stream() << "\n";
+            dump_json_newline(settings);
         }
     }
     dump_array_end<Format>(array, len, settings, indents);
@@ -1564,56 +3204,70 @@ void dump_double_pointer_array(const T *const *array, size_t len, const ApiDumpS
 
 // Designed to be viewed in something like https://www.khronos.org/spir/visualizer/
 // There is also now support in SPIRV-Tools (https://github.com/KhronosGroup/SPIRV-Tools/pull/5870) to consume the array
-template <ApiDumpFormat Format, typename T>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
 void dump_spirv(const T *array, size_t len, const ApiDumpSettings &settings, const char *type_string, const char *name,
                 int indents) {
     if (array == NULL || len == 0) {
-        dump_nullptr<Format>(settings, type_string, name, indents);
+        dump_nullptr<Format, Features>(settings, type_string, name, indents);
         return;
     }
-    dump_array_start<Format>(array, len, settings, type_string, name, indents);
+    dump_array_start<Format, Features>(array, len, settings, type_string, name, indents);
 
-    std::stringstream stream;
+    FormatBuffer &out = settings.stream();
     // For JSON we will just dump it as a valid JSON array of string like
     // [ "0x07230203", "0x00010300", "0x0008000b", ...
     if constexpr (Format == ApiDumpFormat::Json) {
-        for (size_t i = 0; i < len; ++i) {
-            if (i != 0) {
-                stream << ", ";
-            }
-            const uint32_t dword = static_cast<const uint32_t *>(array)[i];
-            stream << "\"0x" << std::hex << std::setfill('0') << std::setw(8) << dword << "\"";
-        }
-        settings.stream() << stream.str();
+        WriteSpirvHex(out, reinterpret_cast<const uint32_t *>(array), len, true);
     } else {
-        stream << settings.indentation(indents) << "[ ";
-        for (size_t i = 0; i < len; ++i) {
-            if (i != 0) {
-                stream << ", ";
-            }
-            const uint32_t dword = static_cast<const uint32_t *>(array)[i];
-            stream << "0x" << std::hex << std::setfill('0') << std::setw(8) << dword;
-        }
-        stream << " ]\n";
-        dump_value<Format>(settings, stream.str());
+        out << settings.indentation(indents);
+        dump_value_start<Format>(settings);
+        out << "[ ";
+        WriteSpirvHex(out, reinterpret_cast<const uint32_t *>(array), len, false);
+        out << " ]\n";
+        dump_value_end<Format>(settings);
     }
 
     dump_array_end<Format>(array, len, settings, indents);
 }
 
-template <ApiDumpFormat Format>
+// With save_shaders, the code is saved to a file named after its hash, and only the file and the size of the code are shown.
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
+void dump_saved_spirv(const T *array, size_t len, const ApiDumpSettings &settings, const char *type_string, const char *name,
+                      int indents) {
+    if (array == NULL || len == 0) {
+        dump_nullptr<Format, Features>(settings, type_string, name, indents);
+        return;
+    }
+    const size_t size = len * sizeof(uint32_t);
+    std::string text = settings.shaderStore().save(reinterpret_cast<const uint32_t *>(array), size);
+    text += " (";
+    text += std::to_string(size);
+    text += " bytes)";
+    const char *const text_string = text.c_str();
+    dump_special<Format, Features>(text_string, settings, type_string, name, indents);
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_before_pre_dump_formatting(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Text) {
-        if (ApiDumpInstance::current().settings().shouldPreDump()) {
+        if (settings.shouldPreDump<Features>()) {
             settings.stream() << "<before calling into implementation>\n";
         }
     }
 }
 
-template <ApiDumpFormat Format, typename T>
+template <typename T>
+void dump_binary_return_value(const ApiDumpSettings &settings, const T &result);
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T>
 void dump_return_value(const ApiDumpSettings &settings, const char *returnType, T result) {
-    if constexpr (Format == ApiDumpFormat::Text) {
-        if (ApiDumpInstance::current().settings().shouldPreDump()) {
+    if constexpr (Format == ApiDumpFormat::Binary) {
+        dump_binary_return_value(settings, result);
+        return;
+    } else if constexpr (Format == ApiDumpFormat::Trace) {
+        settings.stream() << ",\"result\":";
+    } else if constexpr (Format == ApiDumpFormat::Text) {
+        if (settings.shouldPreDump<Features>()) {
             settings.stream() << "return " << returnType;
         }
         settings.stream() << " ";
@@ -1622,18 +3276,27 @@ void dump_return_value(const ApiDumpSettings &settings, const char *returnType,
         dump_separate_members<Format>(settings);
         dump_json_key(settings, 3, "returnValue");
     }
-    dump_value<Format>(settings, result);
+    if constexpr (Format == ApiDumpFormat::Json && std::is_arithmetic_v<T>) {
+        dump_json_number(settings, result);
+    } else {
+        dump_value<Format>(settings, result);
+    }
     if constexpr (Format == ApiDumpFormat::Text) {
-        if (ApiDumpInstance::current().settings().shouldPreDump()) {
+        if (settings.shouldPreDump<Features>()) {
             settings.stream() << ":\n";
         }
     }
 }
 
-template <ApiDumpFormat Format, typename T, typename DumpReturnValue>
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime, typename T, typename DumpReturnValue>
 void dump_return_value(const ApiDumpSettings &settings, const char *returnType, T result, DumpReturnValue dump_return_value) {
-    if constexpr (Format == ApiDumpFormat::Text) {
-        if (ApiDumpInstance::current().settings().shouldPreDump()) {
+    if constexpr (Format == ApiDumpFormat::Binary) {
+        dump_binary_return_value(settings, result);
+        return;
+    } else if constexpr (Format == ApiDumpFormat::Trace) {
+        settings.stream() << ",\"result\":";
+    } else if constexpr (Format == ApiDumpFormat::Text) {
+        if (settings.shouldPreDump<Features>()) {
             settings.stream() << "return " << returnType;
         }
         settings.stream() << " ";
@@ -1644,7 +3307,7 @@ void dump_return_value(const ApiDumpSettings &settings, const char *returnType,
     }
     dump_return_value(result, settings);
     if constexpr (Format == ApiDumpFormat::Text) {
-        if (ApiDumpInstance::current().settings().shouldPreDump()) {
+        if (settings.shouldPreDump<Features>()) {
             settings.stream() << ":\n";
         }
     }
@@ -1662,14 +3325,51 @@ void dump_post_params_formatting(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
         settings.stream() << "\n";
     } else if constexpr (Format == ApiDumpFormat::Json) {
-        settings.stream() << "\n" << settings.indentation(3) << "]\n";
+        if (settings.jsonLines()) {
+            settings.stream() << ']';
+        } else {
+            settings.stream() << "\n" << settings.indentation(3) << "]\n";
+        }
     }
 }
 
-template <ApiDumpFormat Format>
+// When the call down the chain was made and returned, shown with the timestamps.
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
+void dump_next_layer_call_times(const ApiDumpSettings &settings) {
+    uint64_t entry_ns = 0;
+    uint64_t return_ns = 0;
+    if (!settings.showTimestamp<Features>() || !ApiDumpInstance::current().nextLayerCallTimes(entry_ns, return_ns)) {
+        return;
+    }
+    const char *unit = settings.timestampUnit();
+    if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
+        if constexpr (Format == ApiDumpFormat::Text) {
+            settings.stream() << settings.indentation(1);
+        } else {
+            settings.stream() << "<div class='time'>";
+        }
+        settings.stream() << "Next layer called at " << settings.timestampValue(entry_ns) << unit << ", returned at "
+                          << settings.timestampValue(return_ns) << unit << " (" << settings.timestampValue(return_ns - entry_ns)
+                          << unit << ")";
+        settings.stream() << (Format == ApiDumpFormat::Text ? "\n" : "</div>");
+    } else if constexpr (Format == ApiDumpFormat::Json) {
+        dump_separate_members<Format>(settings);
+        if (settings.jsonLines()) {
+            dump_json_key_number(settings, 3, "nextLayerCallTime", settings.timestampValue(entry_ns));
+            dump_separate_members<Format>(settings);
+            dump_json_key_number(settings, 3, "nextLayerReturnTime", settings.timestampValue(return_ns));
+        } else {
+            dump_json_key_value(settings, 3, "nextLayerCallTime", settings.timestampValue(entry_ns), unit);
+            dump_separate_members<Format>(settings);
+            dump_json_key_value(settings, 3, "nextLayerReturnTime", settings.timestampValue(return_ns), unit);
+        }
+    }
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
 void dump_pre_function_formatting(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Text) {
-        if (ApiDumpInstance::current().settings().shouldPreDump()) {
+        if (settings.shouldPreDump<Features>()) {
             settings.stream() << "<after returning from implementation>\n";
         } else {
             settings.stream() << ":\n";
@@ -1677,76 +3377,130 @@ void dump_pre_function_formatting(const ApiDumpSettings &settings) {
     } else if constexpr (Format == ApiDumpFormat::Html) {
         settings.stream() << "</summary>";
     }
+    dump_next_layer_call_times<Format, Features>(settings);
 }
 template <ApiDumpFormat Format>
 void dump_post_function_formatting(const ApiDumpSettings &settings) {
     if constexpr (Format == ApiDumpFormat::Html) {
         settings.stream() << "</details>";
     } else if constexpr (Format == ApiDumpFormat::Json) {
-        settings.stream() << settings.indentation(2) << "}";
+        // JSON Lines calls end their line, the calls of the json format are separated by the next one
+        settings.stream() << settings.indentation(2) << (settings.jsonLines() ? "}\n" : "}");
+    } else if constexpr (Format == ApiDumpFormat::Trace) {
+        // The event lasts for the call down the chain
+        uint64_t start_ns = 0;
+        uint64_t end_ns = 0;
+        trace_event_times(ApiDumpInstance::current(), start_ns, end_ns);
+        settings.stream() << "},\"ts\":";
+        dump_trace_time(settings, start_ns);
+        settings.stream() << ",\"dur\":";
+        dump_trace_time(settings, end_ns - start_ns);
+        settings.stream() << "},\n";
+    }
+}
+
+// Marks the end of a frame in the trace, when vkQueuePresentKHR returns.
+template <ApiDumpFormat Format>
+void dump_frame_end_marker(ApiDumpInstance &dump_inst) {
+    if constexpr (Format == ApiDumpFormat::Trace) {
+        const ApiDumpSettings &settings(dump_inst.settings());
+        uint64_t start_ns = 0;
+        uint64_t end_ns = 0;
+        trace_event_times(dump_inst, start_ns, end_ns);
+        settings.stream() << "{\"name\":\"Frame " << dump_inst.frameCount()
+                          << "\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" << kTraceProcessId << ",\"tid\":0,\"ts\":";
+        dump_trace_time(settings, end_ns);
+        settings.stream() << "},\n";
     }
 }
 
 //==================================== Function Head Helpers ======================================//
 
-inline void dump_text_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcNamedParams,
-                                    const char *funcReturn) {
+// When decoding a binary capture, recorded holds the thread and time of the captured call.
+inline uint64_t function_head_thread(ApiDumpInstance &dump_inst, const ApiDumpBinaryRecordHeader *recorded) {
+    return recorded != nullptr ? recorded->thread_id : dump_inst.threadID();
+}
+
+inline uint64_t function_head_time(ApiDumpInstance &dump_inst, const ApiDumpBinaryRecordHeader *recorded) {
+    const uint64_t time_ns =
+        recorded != nullptr ? recorded->time_ns : static_cast<uint64_t>(dump_inst.current_time_since_start().count());
+    return dump_inst.settings().timestampValue(time_ns);
+}
+
+template <ApiDumpFeatures Features>
+void dump_text_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcNamedParams, const char *funcReturn,
+                             const ApiDumpBinaryRecordHeader *recorded) {
     const ApiDumpSettings &settings(dump_inst.settings());
-    if (settings.showThreadAndFrame()) {
-        settings.stream() << "Thread " << dump_inst.threadID() << ", Frame " << dump_inst.frameCount();
+    if (settings.showThreadAndFrame<Features>()) {
+        settings.stream() << "Thread " << function_head_thread(dump_inst, recorded) << ", Frame " << dump_inst.frameCount();
     }
-    if (settings.showTimestamp() && settings.showThreadAndFrame()) {
+    if (settings.showTimestamp<Features>() && settings.showThreadAndFrame<Features>()) {
         settings.stream() << ", ";
     }
-    if (settings.showTimestamp()) {
-        settings.stream() << "Time " << dump_inst.current_time_since_start().count() << " us";
+    if (settings.showTimestamp<Features>()) {
+        settings.stream() << "Time " << function_head_time(dump_inst, recorded) << settings.timestampUnit();
     }
-    if (settings.showTimestamp() || settings.showThreadAndFrame()) {
+    if (settings.showTimestamp<Features>() || settings.showThreadAndFrame<Features>()) {
         settings.stream() << ":\n";
     }
     settings.stream() << funcName << "(" << funcNamedParams << ") returns " << funcReturn;
-    if (ApiDumpInstance::current().settings().shouldPreDump() && ApiDumpInstance::current().shouldDumpOutput()) {
+    if (settings.shouldPreDump<Features>() && dump_inst.shouldDumpOutput()) {
         settings.stream() << ":\n";
     }
     flush(settings);
 }
 
-inline void dump_html_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcNamedParams,
-                                    const char *funcReturn) {
+template <ApiDumpFeatures Features>
+void dump_html_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcNamedParams, const char *funcReturn,
+                             const ApiDumpBinaryRecordHeader *recorded) {
     const ApiDumpSettings &settings(dump_inst.settings());
-    if (settings.showThreadAndFrame()) {
-        settings.stream() << "<div class='thd'>Thread: " << dump_inst.threadID() << "</div>";
+    if (settings.showThreadAndFrame<Features>()) {
+        settings.stream() << "<div class='thd'>Thread: " << function_head_thread(dump_inst, recorded) << "</div>";
     }
-    if (settings.showTimestamp())
-        settings.stream() << "<div class='time'>Time: " << dump_inst.current_time_since_start().count() << " us</div>";
+    if (settings.showTimestamp<Features>())
+        settings.stream() << "<div class='time'>Time: " << function_head_time(dump_inst, recorded) << settings.timestampUnit()
+                          << "</div>";
     settings.stream() << "<details class='fn'><summary>";
     settings.stream() << "<div class='var'>" << funcName << "(" << funcNamedParams << ")</div>";
-    if (settings.showType()) {
+    if (settings.showType<Features>()) {
         settings.stream() << "<div class='type'>" << funcReturn << "</div>";
     }
     flush(settings);
 }
 
-inline void dump_json_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcReturn) {
+template <ApiDumpFeatures Features>
+void dump_json_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcReturn,
+                             const ApiDumpBinaryRecordHeader *recorded) {
     const ApiDumpSettings &settings(dump_inst.settings());
 
-    if (!dump_inst.firstFunctionCallOnFrame()) {
+    // Buffered records get their separator when they are appended to the output
+    if (!settings.jsonLines() && !settings.isThreadBufferingRecord() && !dump_inst.firstFunctionCallOnFrame()) {
         dump_separate_members<ApiDumpFormat::Json>(settings);
     }
     // Display api call name
     dump_json_start_object(settings, 2);
     dump_json_key_value(settings, 3, "name", funcName);
 
-    // Display thread info
-    if (settings.showThreadAndFrame()) {
+    // Display thread info, and the frame, which JSON Lines calls aren't grouped by
+    if (settings.showThreadAndFrame<Features>()) {
         dump_separate_members<ApiDumpFormat::Json>(settings);
-        dump_json_key_value(settings, 3, "thread", "Thread ", dump_inst.threadID());
+        if (settings.jsonLines()) {
+            dump_json_key_number(settings, 3, "thread", function_head_thread(dump_inst, recorded));
+            dump_separate_members<ApiDumpFormat::Json>(settings);
+            dump_json_key_number(settings, 3, "frame", dump_inst.frameCount());
+        } else {
+            dump_json_key_value(settings, 3, "thread", "Thread ", function_head_thread(dump_inst, recorded));
+        }
     }
 
     // Display elapsed time
-    if (settings.showTimestamp()) {
+    if (settings.showTimestamp<Features>()) {
         dump_separate_members<ApiDumpFormat::Json>(settings);
-        dump_json_key_value(settings, 3, "time", dump_inst.current_time_since_start().count(), " us");
+        if (settings.jsonLines()) {
+            dump_json_key_number(settings, 3, "time", function_head_time(dump_inst, recorded));
+        } else {
+            dump_json_key_value(settings, 3, "time", function_head_time(dump_inst, recorded), settings.timestampUnit());
+        }
     }
 
     // Display return type
@@ -1755,6 +3509,18 @@ inline void dump_json_function_head(ApiDumpInstance &dump_inst, const char *func
     flush(settings);
 }
 
+// Only the start of the event is written before the call down the chain, dump_post_function_formatting() finishes it once
+// the duration of the call is known.
+inline void dump_trace_function_head(ApiDumpInstance &dump_inst, const char *funcName, const ApiDumpBinaryRecordHeader *recorded) {
+    const ApiDumpSettings &settings(dump_inst.settings());
+    trace_event_start() =
+        recorded != nullptr ? recorded->time_ns : static_cast<uint64_t>(dump_inst.current_time_since_start().count());
+    settings.stream() << "{\"name\":\"" << funcName << "\",\"cat\":\"vulkan\",\"ph\":\"X\",\"pid\":" << kTraceProcessId
+                      << ",\"tid\":" << function_head_thread(dump_inst, recorded)
+                      << ",\"args\":{\"frame\":" << dump_inst.frameCount();
+    flush(settings);
+}
+
 inline void dump_json_UNUSED(const ApiDumpSettings &settings, const char *type_string, const char *name, int indents) {
     dump_json_start_object(settings, indents);
     dump_json_key_value(settings, indents + 1, "type", type_string);
@@ -1767,21 +3533,108 @@ inline void dump_json_UNUSED(const ApiDumpSettings &settings, const char *type_s
     dump_json_end_object(settings, indents);
 }
 
+//==================================== Binary Capture Helpers ======================================//
+
+// The record of the call the calling thread is currently capturing in the binary format.
+struct ApiDumpBinaryCall {
+    ApiDumpBinaryRecordHeader header{};
+    ApiDumpBinaryWriter writer;  // Return value followed by the parameters
+};
+
+inline ApiDumpBinaryCall &binary_call() {
+    thread_local ApiDumpBinaryCall call;
+    return call;
+}
+
+inline void dump_binary_function_head(ApiDumpInstance &dump_inst) {
+    ApiDumpBinaryCall &call = binary_call();
+    call.header = {};
+    call.header.thread_id = dump_inst.threadID();
+    call.header.frame = dump_inst.frameCount();
+    call.header.time_ns = static_cast<uint64_t>(dump_inst.current_time_since_start().count());
+    call.writer.clear();
+}
+
+template <typename T>
+void dump_binary_return_value(const ApiDumpSettings &settings, const T &result) {
+    ApiDumpBinaryCall &call = binary_call();
+    call.header.return_value_size = sizeof(T);
+    call.writer.writeValue(result);
+    if constexpr (std::is_same_v<T, VkResult>) {
+        if (settings.isFlightRecorderTrigger(result)) {
+            call.header.flags |= kApiDumpBinaryRecordTrigger;
+        }
+    }
+}
+
+// Called by the generated capture_params_ functions once all parameters have been written.
+inline void dump_binary_record(ApiDumpInstance &dump_inst, uint32_t function_id) {
+    ApiDumpBinaryCall &call = binary_call();
+    call.header.function_id = function_id;
+    if (dump_inst.nextLayerCallTimes(call.header.call_entry_ns, call.header.call_return_ns)) {
+        call.header.flags |= kApiDumpBinaryRecordCallTimed;
+    }
+    call.header.size = static_cast<uint32_t>(call.writer.data().size());
+    FormatBuffer &out = dump_inst.settings().stream();
+    out.write(reinterpret_cast<const char *>(&call.header), sizeof(call.header));
+    out.write(call.writer.data().data(), call.writer.data().size());
+}
+
 //==================================== Common Helpers ======================================//
 
-inline void dump_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcNamedParams,
-                               const char *funcReturn) {
+template <ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
+void dump_function_head(ApiDumpInstance &dump_inst, const char *funcName, const char *funcNamedParams, const char *funcReturn,
+                        const ApiDumpBinaryRecordHeader *recorded = nullptr) {
     if (dump_inst.shouldDumpOutput()) {
         switch (dump_inst.settings().format()) {
             case ApiDumpFormat::Text:
-                dump_text_function_head(dump_inst, funcName, funcNamedParams, funcReturn);
+                dump_text_function_head<Features>(dump_inst, funcName, funcNamedParams, funcReturn, recorded);
                 break;
             case ApiDumpFormat::Html:
-                dump_html_function_head(dump_inst, funcName, funcNamedParams, funcReturn);
+                dump_html_function_head<Features>(dump_inst, funcName, funcNamedParams, funcReturn, recorded);
                 break;
             case ApiDumpFormat::Json:
-                dump_json_function_head(dump_inst, funcName, funcReturn);
+                dump_json_function_head<Features>(dump_inst, funcName, funcReturn, recorded);
+                break;
+            case ApiDumpFormat::Binary:
+                dump_binary_function_head(dump_inst);
+                break;
+            case ApiDumpFormat::Trace:
+                dump_trace_function_head(dump_inst, funcName, recorded);
                 break;
         }
     }
 }
+
+//==================================== Command Lookup ======================================//
+
+// A command returned by vkGetInstanceProcAddr or vkGetDeviceProcAddr. The generated api_dump_find_command keeps them in a
+// table sorted by name.
+struct ApiDumpCommand {
+    const char *name;
+    PFN_vkVoidFunction function;
+    // Returned by vkGetInstanceProcAddr
+    bool instance;
+    // Returned by vkGetDeviceProcAddr, if the next layer implements it
+    bool device;
+    // Offset of the next layer's function in VkuDeviceDispatchTable, for device commands
+    size_t device_table_offset;
+    // Returned even when the function filter leaves it out, since the layer keeps state from it
+    bool always_intercepted = false;
+
+    // Whether the layer returns its own function, instead of letting the next layer's function be called directly
+    bool intercepted() const { return always_intercepted || ApiDumpInstance::current().settings().isFunctionDumped(name); }
+
+    bool availableOn(VkDevice device_handle) const {
+        const char *table = reinterpret_cast<const char *>(device_dispatch_table(device_handle));
+        return *reinterpret_cast<const PFN_vkVoidFunction *>(table + device_table_offset) != nullptr;
+    }
+};
+
+template <size_t N>
+const ApiDumpCommand *find_api_dump_command(const ApiDumpCommand (&commands)[N], const char *name) {
+    const ApiDumpCommand *command = std::lower_bound(
+        commands, commands + N, name, [](const ApiDumpCommand &entry, const char *key) { return strcmp(entry.name, key) < 0; });
+    if (command == commands + N || strcmp(command->name, name) != 0) return nullptr;
+    return command;
+}
@@ -0,0 +1,192 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary captures are a file header followed by one record per dumped call. Values are stored in the byte order and with the
+// pointer size of the captured process, and function ids depend on the Vulkan headers the layer was built with, so a capture
+// can only be decoded by a decoder built from the same headers for the same kind of machine.
+//
+// A record is an ApiDumpBinaryRecordHeader followed by `size` bytes of payload: the return value, the raw value of every
+// parameter, then the objects the parameters point to. Those are stored as "pointer slots", visited in the same order the
+// generated dump functions visit them: a flag byte, and when the flag is set, the byte count and the bytes pointed to.
+
+static const char kApiDumpBinaryMagic[8] = {'V', 'K', 'A', 'P', 'I', 'D', 'M', 'P'};
+static const uint32_t kApiDumpBinaryVersion = 2;
+
+struct ApiDumpBinaryFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_version;  // VK_HEADER_VERSION_COMPLETE of the capturing layer
+    uint32_t pointer_size;
+    uint32_t reserved;
+};
+
+struct ApiDumpBinaryRecordHeader {
+    uint32_t size;  // Payload bytes following the header
+    uint32_t function_id;
+    uint64_t thread_id;
+    uint64_t frame;
+    uint64_t time_ns;          // When the layer was called, in nanoseconds since it was loaded
+    uint64_t call_entry_ns;    // When the next layer was called and returned, if kApiDumpBinaryRecordCallTimed is set
+    uint64_t call_return_ns;
+    uint32_t return_value_size;
+    uint32_t flags;
+};
+
+static const uint32_t kApiDumpBinaryRecordCallTimed = 0x1;
+// The call returned a result the flight recorder dumps on. Decoders ignore it.
+static const uint32_t kApiDumpBinaryRecordTrigger = 0x2;
+
+class ApiDumpBinaryWriter {
+   public:
+    void clear() { buffer.clear(); }
+    const std::string &data() const { return buffer; }
+
+    void write(const void *data, size_t size) { buffer.append(static_cast<const char *>(data), size); }
+
+    template <typename T>
+    void writeValue(const T &value) {
+        write(&value, sizeof(T));
+    }
+
+    void writeFlag(bool set) { writeValue<uint8_t>(set ? 1 : 0); }
+
+    // An empty pointer slot, for null pointers and pointers the dump doesn't follow.
+    void writeAbsent() { writeFlag(false); }
+
+    void writeBlock(const void *data, size_t size) {
+        writeFlag(true);
+        writeValue<uint64_t>(size);
+        write(data, size);
+    }
+
+    void writeString(const char *string) { writeBlock(string, strlen(string) + 1); }
+
+   private:
+    std::string buffer;
+};
+
+// Maps the copies made by the decoder back to the addresses the application used, so decoded output shows the original
+// addresses, including the ones of members and array elements.
+class ApiDumpAddressMap {
+   public:
+    void clear() { copies.clear(); }
+
+    void add(const void *copy, size_t size, const void *original) {
+        copies[reinterpret_cast<uintptr_t>(copy)] = {size, reinterpret_cast<uintptr_t>(original)};
+    }
+
+    const void *originalAddress(const void *address) const {
+        const uintptr_t value = reinterpret_cast<uintptr_t>(address);
+        auto it = copies.upper_bound(value);
+        if (it == copies.begin()) {
+            return address;
+        }
+        --it;
+        const size_t size = it->second.first > 0 ? it->second.first : 1;
+        if (value - it->first >= size) {
+            return address;
+        }
+        return reinterpret_cast<const void *>(it->second.second + (value - it->first));
+    }
+
+   private:
+    std::map<uintptr_t, std::pair<size_t, uintptr_t>> copies;
+};
+
+// Reads back one record payload. Pointed to objects are copied into storage owned by the reader, which stays valid until the
+// next call to beginRecord(). Reading past the end of the payload yields zeroes and marks the reader as failed.
+class ApiDumpBinaryReader {
+   public:
+    void beginRecord(const uint8_t *payload, size_t payload_size) {
+        data = payload;
+        size = payload_size;
+        offset = 0;
+        read_failed = false;
+        storage.clear();
+        address_map.clear();
+    }
+
+    bool failed() const { return read_failed; }
+    const ApiDumpAddressMap &addressMap() const { return address_map; }
+
+    void read(void *out, size_t bytes) {
+        if (read_failed || bytes > size - offset) {
+            read_failed = true;
+            memset(out, 0, bytes);
+            return;
+        }
+        memcpy(out, data + offset, bytes);
+        offset += bytes;
+    }
+
+    template <typename T>
+    void readValue(T &value) {
+        read(const_cast<void *>(static_cast<const void *>(&value)), sizeof(T));
+    }
+
+    bool readFlag() {
+        uint8_t flag = 0;
+        readValue(flag);
+        return flag != 0;
+    }
+
+    // Reads a pointer slot. If it holds the pointed to bytes, points pointer at a copy of them and returns true, otherwise
+    // leaves the captured value in place, which the dump functions only print.
+    template <typename P>
+    bool readPointer(P &pointer, size_t *copy_size = nullptr) {
+        if (!readFlag()) {
+            return false;
+        }
+        uint64_t bytes = 0;
+        readValue(bytes);
+        if (read_failed || bytes > size - offset) {
+            read_failed = true;
+            return false;
+        }
+        // Allocate whole max_align_t units so that the copy is suitably aligned for any type
+        const size_t units = static_cast<size_t>(bytes) / sizeof(std::max_align_t) + 1;
+        storage.emplace_back(std::make_unique<std::max_align_t[]>(units));
+        void *copy = storage.back().get();
+        memcpy(copy, data + offset, static_cast<size_t>(bytes));
+        offset += static_cast<size_t>(bytes);
+
+        address_map.add(copy, static_cast<size_t>(bytes), reinterpret_cast<const void *>(pointer));
+        pointer = reinterpret_cast<P>(copy);
+        if (copy_size != nullptr) {
+            *copy_size = static_cast<size_t>(bytes);
+        }
+        return true;
+    }
+
+   private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    bool read_failed = false;
+    std::vector<std::unique_ptr<std::max_align_t[]>> storage;
+    ApiDumpAddressMap address_map;
+};
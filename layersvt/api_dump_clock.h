@@ -0,0 +1,118 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define API_DUMP_CLOCK_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define API_DUMP_CLOCK_TSC
+#endif
+
+// Clock the timestamps of the layer are read from.
+enum class TimestampClock {
+    System,  // std::chrono::system_clock, which isn't monotonic
+    Steady,  // std::chrono::steady_clock
+    Raw,     // The TSC on x86, CLOCK_MONOTONIC_RAW elsewhere on Linux and Android, the steady clock otherwise
+};
+
+// Timestamps in nanoseconds since the layer was loaded, from the selected clock. Every clock counts from the same origin.
+class ApiDumpClock {
+   public:
+    ApiDumpClock() : system_start(std::chrono::system_clock::now()), steady_start(std::chrono::steady_clock::now()) {}
+
+    // Calls must not overlap, but other threads can read the clock meanwhile, as each vkCreateInstance selects it again. The raw
+    // clock is calibrated against the steady clock the first time it is selected, which takes a few milliseconds, and is only
+    // selected once its calibration is visible to the threads that read it.
+    void select(TimestampClock selected) {
+        if (selected == TimestampClock::Raw && !raw_calibrated) {
+            calibrateRaw();
+        }
+        clock.store(selected, std::memory_order_release);
+    }
+
+    TimestampClock selected() const { return clock.load(std::memory_order_acquire); }
+
+    uint64_t now() const {
+        switch (selected()) {
+            case TimestampClock::Steady:
+                return nanoseconds(std::chrono::steady_clock::now() - steady_start);
+            case TimestampClock::Raw:
+                return raw_origin_ns + static_cast<uint64_t>(static_cast<double>(rawTicks() - raw_origin_ticks) * raw_ns_per_tick);
+            default: {
+                // The system clock can be set back past the time the layer was loaded
+                const auto elapsed = std::chrono::system_clock::now() - system_start;
+                return elapsed.count() > 0 ? nanoseconds(elapsed) : 0;
+            }
+        }
+    }
+
+   private:
+    template <typename Duration>
+    static uint64_t nanoseconds(Duration duration) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+#if defined(API_DUMP_CLOCK_TSC)
+    static const bool kRawTicksAreNanoseconds = false;
+    static uint64_t rawTicks() { return __rdtsc(); }
+#elif defined(__linux__) || defined(__ANDROID__)
+    static const bool kRawTicksAreNanoseconds = true;
+    static uint64_t rawTicks() {
+        timespec time{};
+        clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_nsec);
+    }
+#else
+    static const bool kRawTicksAreNanoseconds = true;
+    static uint64_t rawTicks() { return nanoseconds(std::chrono::steady_clock::now().time_since_epoch()); }
+#endif
+
+    // Measures the tick rate over a short sleep, and starts the raw clock where the steady clock is.
+    void calibrateRaw() {
+        const auto steady_begin = std::chrono::steady_clock::now();
+        const uint64_t ticks_begin = rawTicks();
+        if (!kRawTicksAreNanoseconds) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const auto steady_end = std::chrono::steady_clock::now();
+        const uint64_t ticks_end = rawTicks();
+        if (!kRawTicksAreNanoseconds && ticks_end > ticks_begin) {
+            raw_ns_per_tick =
+                static_cast<double>(nanoseconds(steady_end - steady_begin)) / static_cast<double>(ticks_end - ticks_begin);
+        }
+        raw_origin_ticks = ticks_end;
+        raw_origin_ns = nanoseconds(steady_end - steady_start);
+        raw_calibrated = true;
+    }
+
+    std::atomic<TimestampClock> clock{TimestampClock::System};
+    std::chrono::system_clock::time_point system_start;
+    std::chrono::steady_clock::time_point steady_start;
+
+    bool raw_calibrated = false;
+    double raw_ns_per_tick = 1.0;
+    uint64_t raw_origin_ticks = 0;
+    uint64_t raw_origin_ns = 0;
+};
@@ -0,0 +1,157 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// The command buffers allocated from each command pool, and their level, which is needed to know whether
+// VkCommandBufferBeginInfo::pInheritanceInfo is valid when vkBeginCommandBuffer is dumped.
+//
+// Applications allocate and free command buffers from many threads, usually from a pool per thread, so the state is split in
+// shards, each with its own lock. The level of a command buffer is in the shard of the command buffer, and the command buffers
+// of a pool in the shard of the pool. A call locks one shard at a time, and threads working with different pools and command
+// buffers rarely wait for each other.
+class ApiDumpCommandBuffers {
+   public:
+    void add(VkDevice device, VkCommandPool cmd_pool, uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers,
+             VkCommandBufferLevel level) {
+        {
+            Shard &pool_shard = shardOf(cmd_pool);
+            std::lock_guard<std::mutex> lg(pool_shard.mutex);
+            auto &pool_cmd_buffers = pool_shard.pools[std::make_pair(device, cmd_pool)];
+            pool_cmd_buffers.insert(cmd_buffers, cmd_buffers + cmd_buffer_count);
+        }
+        forEachShard(cmd_buffer_count, cmd_buffers, [level](Shard &shard, VkCommandBuffer cmd_buffer) {
+            assert(shard.levels.count(cmd_buffer) == 0);
+            shard.levels[cmd_buffer] = level;
+        });
+    }
+
+    void erase(VkDevice device, VkCommandPool cmd_pool, uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers) {
+        if (cmd_buffers == nullptr) {
+            return;
+        }
+        {
+            Shard &pool_shard = shardOf(cmd_pool);
+            std::lock_guard<std::mutex> lg(pool_shard.mutex);
+            const auto pool_cmd_buffers_iter = pool_shard.pools.find(std::make_pair(device, cmd_pool));
+            if (pool_cmd_buffers_iter != pool_shard.pools.end()) {
+                for (uint32_t i = 0; i < cmd_buffer_count; ++i) {
+                    pool_cmd_buffers_iter->second.erase(cmd_buffers[i]);
+                }
+            }
+        }
+        forEachShard(cmd_buffer_count, cmd_buffers, [](Shard &shard, VkCommandBuffer cmd_buffer) {
+            if (cmd_buffer != VK_NULL_HANDLE) {
+                assert(shard.levels.count(cmd_buffer) > 0);
+                shard.levels.erase(cmd_buffer);
+            }
+        });
+    }
+
+    // Forgets the command buffers of the pool, and calls function with each of them.
+    template <typename Function>
+    void erasePool(VkDevice device, VkCommandPool cmd_pool, Function &&function) {
+        if (cmd_pool == VK_NULL_HANDLE) {
+            return;
+        }
+        std::vector<VkCommandBuffer> pool_cmd_buffers;
+        {
+            Shard &pool_shard = shardOf(cmd_pool);
+            std::lock_guard<std::mutex> lg(pool_shard.mutex);
+            const auto pool_cmd_buffers_iter = pool_shard.pools.find(std::make_pair(device, cmd_pool));
+            if (pool_cmd_buffers_iter == pool_shard.pools.end()) {
+                return;
+            }
+            pool_cmd_buffers.assign(pool_cmd_buffers_iter->second.begin(), pool_cmd_buffers_iter->second.end());
+            pool_shard.pools.erase(pool_cmd_buffers_iter);
+        }
+        forEachShard(static_cast<uint32_t>(pool_cmd_buffers.size()), pool_cmd_buffers.data(),
+                     [](Shard &shard, VkCommandBuffer cmd_buffer) {
+                         assert(shard.levels.count(cmd_buffer) > 0);
+                         shard.levels.erase(cmd_buffer);
+                     });
+        for (const auto cmd_buffer : pool_cmd_buffers) {
+            function(cmd_buffer);
+        }
+    }
+
+    // VK_COMMAND_BUFFER_LEVEL_MAX_ENUM for a command buffer that isn't tracked, such as one the application already freed, so
+    // that the fields that depend on the level are left out rather than dumped for a guessed level.
+    VkCommandBufferLevel level(VkCommandBuffer cmd_buffer) {
+        Shard &shard = shardOf(cmd_buffer);
+        std::lock_guard<std::mutex> lg(shard.mutex);
+        const auto level_iter = shard.levels.find(cmd_buffer);
+        return level_iter != shard.levels.end() ? level_iter->second : VK_COMMAND_BUFFER_LEVEL_MAX_ENUM;
+    }
+
+   private:
+    static const size_t kShardCount = 16;
+
+    // On its own cache line, so that threads locking neighbouring shards don't slow each other down
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<VkCommandBuffer, VkCommandBufferLevel> levels;
+        std::map<std::pair<VkDevice, VkCommandPool>, std::unordered_set<VkCommandBuffer>> pools;
+    };
+
+    // Handles are aligned addresses or counters depending on the driver, so all their bits are mixed
+    template <typename T>
+    static size_t shardIndex(T handle) {
+        const uint64_t mixed = (uint64_t)handle * 0x9e3779b97f4a7c15ull;
+        return static_cast<size_t>(mixed >> 60) % kShardCount;
+    }
+
+    template <typename T>
+    Shard &shardOf(T handle) {
+        return shards[shardIndex(handle)];
+    }
+
+    // Calls function with each command buffer and its shard locked. Each shard is locked once, for all the command buffers in
+    // it, as command buffers are allocated and freed in batches.
+    template <typename Function>
+    void forEachShard(uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers, Function &&function) {
+        uint32_t used_shards = 0;
+        for (uint32_t i = 0; i < cmd_buffer_count; ++i) {
+            used_shards |= 1u << shardIndex(cmd_buffers[i]);
+        }
+        for (size_t shard_index = 0; used_shards != 0; ++shard_index, used_shards >>= 1) {
+            if ((used_shards & 1) == 0) {
+                continue;
+            }
+            Shard &shard = shards[shard_index];
+            std::lock_guard<std::mutex> lg(shard.mutex);
+            for (uint32_t i = 0; i < cmd_buffer_count; ++i) {
+                if (shardIndex(cmd_buffers[i]) == shard_index) {
+                    function(shard, cmd_buffers[i]);
+                }
+            }
+        }
+    }
+
+    Shard shards[kShardCount];
+};
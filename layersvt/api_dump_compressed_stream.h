@@ -0,0 +1,210 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(API_DUMP_HAS_ZLIB)
+#include <zlib.h>
+#endif
+
+// Compression of the output file.
+enum class OutputCompression {
+    None,
+    Gzip,
+};
+
+// Whether the layer was built with zlib, which gzip output needs.
+inline bool IsGzipOutputSupported() {
+#if defined(API_DUMP_HAS_ZLIB)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(API_DUMP_HAS_ZLIB)
+
+// Stream buffer that writes a gzip file. What is written to it is gathered into chunks by the writing thread, and a thread of its
+// own compresses the chunks and writes them to the file, so that writing to the stream only costs a copy. Writers wait when
+// the compression falls kMaxQueuedChunks behind.
+class GzipFileBuf final : public std::streambuf {
+   public:
+    static const size_t kChunkSize = 1 << 20;
+    static const size_t kMaxQueuedChunks = 8;
+
+    GzipFileBuf() = default;
+    GzipFileBuf(const GzipFileBuf &) = delete;
+    GzipFileBuf &operator=(const GzipFileBuf &) = delete;
+
+    ~GzipFileBuf() {
+        if (file == nullptr) {
+            return;
+        }
+        submitChunk(false);
+        {
+            std::lock_guard<std::mutex> lg(queue_mutex);
+            closing = true;
+        }
+        queue_cv.notify_one();
+        compress_thread.join();
+        deflateEnd(&stream);
+        fclose(file);
+    }
+
+    // Favors speed over ratio by default, dumps are large and written while the application runs.
+    bool open(const std::string &filename, int level = Z_BEST_SPEED) {
+        file = fopen(filename.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        // 16 added to the window bits selects a gzip header and trailer instead of a zlib one
+        if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            fclose(file);
+            file = nullptr;
+            return false;
+        }
+        compressed.resize(kChunkSize / 4);
+        startChunk();
+        compress_thread = std::thread(&GzipFileBuf::compressLoop, this);
+        return true;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+
+   protected:
+    int_type overflow(int_type c) override {
+        if (file == nullptr) {
+            return traits_type::eof();
+        }
+        submitChunk(false);
+        if (c != traits_type::eof()) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    // Hands what was written so far to the compression thread, which flushes the compressed stream and the file once it is
+    // compressed. Doesn't wait for it.
+    int sync() override {
+        if (file == nullptr) {
+            return -1;
+        }
+        if (pptr() != pbase() || unflushed) {
+            submitChunk(true);
+        }
+        return 0;
+    }
+
+   private:
+    struct Chunk {
+        std::vector<char> data;
+        bool flush = false;
+    };
+
+    void startChunk() {
+        {
+            std::lock_guard<std::mutex> lg(queue_mutex);
+            if (!free_chunks.empty()) {
+                chunk = std::move(free_chunks.back());
+                free_chunks.pop_back();
+            }
+        }
+        chunk.resize(kChunkSize);
+        setp(chunk.data(), chunk.data() + chunk.size());
+    }
+
+    void submitChunk(bool flush) {
+        chunk.resize(static_cast<size_t>(pptr() - pbase()));
+        unflushed = !flush && (unflushed || !chunk.empty());
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            space_cv.wait(lock, [this] { return queue.size() < kMaxQueuedChunks; });
+            queue.push_back({std::move(chunk), flush});
+        }
+        queue_cv.notify_one();
+        chunk = std::vector<char>();
+        startChunk();
+    }
+
+    void compressLoop() {
+        Chunk queued;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this] { return !queue.empty() || closing; });
+                if (queue.empty()) {
+                    break;
+                }
+                queued = std::move(queue.front());
+                queue.pop_front();
+            }
+            space_cv.notify_one();
+
+            deflateData(queued.data.data(), queued.data.size(), queued.flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+            if (queued.flush) {
+                fflush(file);
+            }
+
+            queued.data.clear();
+            std::lock_guard<std::mutex> lg(queue_mutex);
+            free_chunks.push_back(std::move(queued.data));
+        }
+        deflateData(nullptr, 0, Z_FINISH);
+        fflush(file);
+    }
+
+    void deflateData(const char *data, size_t size, int flush) {
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream.avail_in = static_cast<uInt>(size);
+        // deflate() is done with the input once it leaves room in the output
+        do {
+            stream.next_out = compressed.data();
+            stream.avail_out = static_cast<uInt>(compressed.size());
+            deflate(&stream, flush);
+            fwrite(compressed.data(), 1, compressed.size() - stream.avail_out, file);
+        } while (stream.avail_out == 0);
+    }
+
+    FILE *file = nullptr;
+    std::vector<char> chunk;  // Owned by the writing threads, which hold the output mutex
+    bool unflushed = false;   // Whether chunks were submitted since the last flush
+
+    // Owned by the compression thread
+    z_stream stream{};
+    std::vector<Bytef> compressed;
+    std::thread compress_thread;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::condition_variable space_cv;
+    std::deque<Chunk> queue;
+    std::vector<std::vector<char>> free_chunks;
+    bool closing = false;
+};
+
+#endif  // API_DUMP_HAS_ZLIB
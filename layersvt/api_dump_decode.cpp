@@ -0,0 +1,215 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// vkapidump_decode renders a binary capture of the api_dump layer (output_format = binary) as text, HTML or JSON, using the
+// same dump functions as the layer.
+
+#include "generated/api_dump_decode.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--format text|html|json|jsonl|trace] [--output <file>] <capture.bin[.gz]>\n"
+              << "Other api_dump settings, such as show_shader or output_range, are read from the environment and\n"
+              << "vk_layer_settings.txt like they are by the layer.\n";
+}
+
+// Reads the whole capture. Captures written with gzip compression are decompressed when the decoder was built with zlib.
+static bool read_capture(const std::string &input, std::vector<uint8_t> &data) {
+#if defined(API_DUMP_HAS_ZLIB)
+    // gzread() passes files that aren't compressed through as they are
+    gzFile file = gzopen(input.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t chunk[1 << 16];
+    int read_size = 0;
+    while ((read_size = gzread(file, chunk, sizeof(chunk))) > 0) {
+        data.insert(data.end(), chunk, chunk + read_size);
+    }
+    gzclose(file);
+    return read_size == 0;
+#else
+    std::ifstream file(input, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+#endif
+}
+
+template <ApiDumpFormat Format>
+static int decode_capture(const std::vector<uint8_t> &data, size_t offset) {
+    ApiDumpInstance &dump_inst = ApiDumpInstance::current();
+    ApiDumpBinaryReader reader;
+    dump_inst.settings().setAddressMap(&reader.addressMap());
+
+    int result = EXIT_SUCCESS;
+    std::set<uint32_t> unknown_ids;
+    while (offset < data.size()) {
+        // A memory mapped capture that wasn't closed, because the process crashed, ends with the zeros it was grown with
+        if (std::all_of(data.begin() + offset, data.end(), [](uint8_t byte) { return byte == 0; })) {
+            std::cerr << "Capture ends at offset " << offset << ", the rest of it was never written\n";
+            break;
+        }
+        ApiDumpBinaryRecordHeader header{};
+        if (data.size() - offset < sizeof(header)) {
+            std::cerr << "Capture is truncated at offset " << offset << "\n";
+            return EXIT_FAILURE;
+        }
+        memcpy(&header, data.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.size > data.size() - offset) {
+            std::cerr << "Capture is truncated at offset " << offset << "\n";
+            return EXIT_FAILURE;
+        }
+        reader.beginRecord(data.data() + offset, header.size);
+        offset += header.size;
+
+        // Whether the record is dumped depends on its frame, so the frame has to be started before the record's guard
+        while (dump_inst.frameCount() < header.frame) {
+            ApiDumpRecordGuard frame_lg(dump_inst);
+            dump_inst.nextFrame();
+        }
+        // The function filter and sampling select the records that are dumped, like they select the calls the layer dumps
+        ApiDumpRecordGuard lg(dump_inst, static_cast<ApiDumpFunctionId>(header.function_id));
+        ApiDumpCallContext call_context;
+        if (header.flags & kApiDumpBinaryRecordCallTimed) {
+            dump_inst.setNextLayerCallTimes(header.call_entry_ns, header.call_return_ns);
+        }
+        if (!decode_record<Format>(dump_inst, reader, header)) {
+            if (unknown_ids.insert(header.function_id).second) {
+                std::cerr << "Skipping records of unknown function id " << header.function_id << "\n";
+            }
+            continue;
+        }
+        if (reader.failed()) {
+            std::cerr << "Record of " << kApiDumpFunctionNames[header.function_id] << " is malformed\n";
+            result = EXIT_FAILURE;
+        }
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    std::string format = "text";
+    std::string output;
+    std::string input;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg.size() > 0 && arg[0] != '-' && input.empty()) {
+            input = arg;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (input.empty() || (format != "text" && format != "html" && format != "json" && format != "jsonl" && format != "trace")) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<uint8_t> data;
+    if (!read_capture(input, data)) {
+        std::cerr << "Could not read " << input << "\n";
+        return EXIT_FAILURE;
+    }
+
+    ApiDumpBinaryFileHeader file_header{};
+    if (data.size() < sizeof(file_header)) {
+        std::cerr << input << " is not an api_dump binary capture\n";
+        return EXIT_FAILURE;
+    }
+    memcpy(&file_header, data.data(), sizeof(file_header));
+    if (memcmp(file_header.magic, kApiDumpBinaryMagic, sizeof(kApiDumpBinaryMagic)) != 0) {
+        std::cerr << input << " is not an api_dump binary capture\n";
+        return EXIT_FAILURE;
+    }
+    if (file_header.version != kApiDumpBinaryVersion) {
+        std::cerr << input << " has capture format version " << file_header.version << ", this decoder reads version "
+                  << kApiDumpBinaryVersion << "\n";
+        return EXIT_FAILURE;
+    }
+    if (file_header.pointer_size != sizeof(void *)) {
+        std::cerr << input << " was captured by a " << file_header.pointer_size * 8 << "-bit process, this decoder is "
+                  << sizeof(void *) * 8 << "-bit\n";
+        return EXIT_FAILURE;
+    }
+    // Function ids and structure layouts come from the Vulkan headers
+    if (file_header.header_version != VK_HEADER_VERSION_COMPLETE) {
+        std::cerr << input << " was captured with Vulkan headers " << VK_API_VERSION_MAJOR(file_header.header_version) << "."
+                  << VK_API_VERSION_MINOR(file_header.header_version) << "." << VK_API_VERSION_PATCH(file_header.header_version)
+                  << ", this decoder was built with " << VK_API_VERSION_MAJOR(VK_HEADER_VERSION_COMPLETE) << "."
+                  << VK_API_VERSION_MINOR(VK_HEADER_VERSION_COMPLETE) << "." << VK_API_VERSION_PATCH(VK_HEADER_VERSION_COMPLETE)
+                  << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // The files of a rotated capture start at the frame they were rotated at
+    if (data.size() >= sizeof(file_header) + sizeof(ApiDumpBinaryRecordHeader)) {
+        ApiDumpBinaryRecordHeader first_record{};
+        memcpy(&first_record, data.data() + sizeof(file_header), sizeof(first_record));
+        ApiDumpInstance::current().setFirstFrame(first_record.frame);
+    }
+
+    // Configure the output the same way the layer is configured, through layer settings
+    const char *format_value = format.c_str();
+    const char *output_value = output.c_str();
+    const VkBool32 disabled = VK_FALSE;
+    std::vector<VkLayerSettingEXT> layer_settings = {
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyOutputFormat, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &format_value},
+        // Only the values after the call are captured
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyPreDump, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &disabled},
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyFlush, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &disabled},
+    };
+    if (!output.empty()) {
+        layer_settings.push_back(
+            {"VK_LAYER_LUNARG_api_dump", kSettingsKeyLogFilename, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &output_value});
+    }
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_CREATE_INFO_EXT, nullptr,
+                                                           static_cast<uint32_t>(layer_settings.size()), layer_settings.data()};
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+    ApiDumpInstance::current().initLayerSettings(&instance_create_info, nullptr);
+
+    switch (ApiDumpInstance::current().settings().format()) {
+        case ApiDumpFormat::Text:
+            return decode_capture<ApiDumpFormat::Text>(data, sizeof(file_header));
+        case ApiDumpFormat::Html:
+            return decode_capture<ApiDumpFormat::Html>(data, sizeof(file_header));
+        case ApiDumpFormat::Json:
+            return decode_capture<ApiDumpFormat::Json>(data, sizeof(file_header));
+        case ApiDumpFormat::Trace:
+            return decode_capture<ApiDumpFormat::Trace>(data, sizeof(file_header));
+        case ApiDumpFormat::Binary:
+            break;
+    }
+    std::cerr << "Captures can only be decoded to text, html, json, jsonl or trace\n";
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "api_dump_binary.h"
+#include "api_dump_compressed_stream.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#endif
+
+// Keeps the most recent records of a binary capture in memory, and writes them to a capture file of their own when a trigger
+// fires. Records are kept in a ring of bytes allocated once, the oldest ones are dropped to make room for new ones, or when
+// there are more than max_calls of them or they are more than max_frames frames old. Not thread safe, the layer calls it with
+// the output mutex held.
+class FlightRecorder {
+   public:
+    // Dumps are written to filename_stem.000000filename_extension, and numbered up from there.
+    void init(size_t capacity_bytes, uint64_t max_call_count, uint64_t max_frame_count, const ApiDumpBinaryFileHeader &header,
+              const std::string &stem, const std::string &extension, OutputCompression output_compression) {
+        if (capacity != capacity_bytes) {
+            // The records kept so far were in the old storage, and their positions are of the old capacity
+            storage = std::make_unique<char[]>(capacity_bytes);
+            capacity = capacity_bytes;
+            entries.clear();
+            write_position = 0;
+            used = 0;
+        }
+        max_calls = max_call_count;
+        max_frames = max_frame_count;
+        file_header = header;
+        filename_stem = stem;
+        filename_extension = extension;
+        compression = output_compression;
+        enabled = true;
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    bool empty() const { return entries.empty(); }
+
+    // Keeps the records in data, which holds whole records. A record flagged with kApiDumpBinaryRecordTrigger makes the next
+    // dumpIfRequested() write a dump.
+    void append(const char *data, size_t size) {
+        ApiDumpBinaryRecordHeader header{};
+        while (size >= sizeof(header)) {
+            memcpy(&header, data, sizeof(header));
+            const size_t record_size = sizeof(header) + header.size;
+            if (record_size > size) {
+                break;
+            }
+            keep(data, record_size, header.frame);
+            if (header.flags & kApiDumpBinaryRecordTrigger) {
+                dump_requested = true;
+            }
+            data += record_size;
+            size -= record_size;
+        }
+    }
+
+    void dumpIfRequested() {
+        if (dump_requested) {
+            dump_requested = false;
+            dump();
+        }
+    }
+
+    // Writes the records kept so far to the next dump file, and starts over with an empty ring.
+    void dump() {
+        const std::string filename = filename_stem + dumpNumber(dump_count++) + filename_extension;
+        std::ofstream file_stream;
+        std::unique_ptr<std::streambuf> gzip_buf;
+        std::ostream out(nullptr);
+#if defined(API_DUMP_HAS_ZLIB)
+        if (compression == OutputCompression::Gzip) {
+            auto buf = std::make_unique<GzipFileBuf>();
+            if (buf->open(filename)) {
+                out.rdbuf(buf.get());
+                gzip_buf = std::move(buf);
+            }
+        }
+#endif
+        if (!gzip_buf) {
+            file_stream.open(filename, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+            out.rdbuf(file_stream.rdbuf());
+        }
+
+        out.write(reinterpret_cast<const char *>(&file_header), sizeof(file_header));
+        for (const Entry &entry : entries) {
+            const size_t offset = static_cast<size_t>(entry.position % capacity);
+            const size_t first_part = std::min(static_cast<size_t>(entry.size), capacity - offset);
+            out.write(storage.get() + offset, static_cast<std::streamsize>(first_part));
+            out.write(storage.get(), static_cast<std::streamsize>(entry.size - first_part));
+        }
+        out.flush();
+
+        entries.clear();
+        used = 0;
+    }
+
+   private:
+    struct Entry {
+        uint64_t position;  // Of the first byte, counted from the first record ever kept
+        uint32_t size;
+        uint64_t frame;
+    };
+
+    static std::string dumpNumber(uint32_t index) {
+        char number[16];
+        snprintf(number, sizeof(number), ".%06u", index);
+        return number;
+    }
+
+    void keep(const char *record, size_t size, uint64_t frame) {
+        if (size > capacity) {
+            return;
+        }
+        while (!entries.empty() && (used + size > capacity || (max_calls > 0 && entries.size() >= max_calls) ||
+                                    (max_frames > 0 && entries.front().frame + max_frames <= frame))) {
+            used -= entries.front().size;
+            entries.pop_front();
+        }
+        const size_t offset = static_cast<size_t>(write_position % capacity);
+        const size_t first_part = std::min(size, capacity - offset);
+        memcpy(storage.get() + offset, record, first_part);
+        memcpy(storage.get(), record + first_part, size - first_part);
+        entries.push_back({write_position, static_cast<uint32_t>(size), frame});
+        write_position += size;
+        used += size;
+    }
+
+    bool enabled = false;
+    std::unique_ptr<char[]> storage;
+    size_t capacity = 0;
+    uint64_t write_position = 0;
+    size_t used = 0;
+    std::deque<Entry> entries;  // Oldest first, they are contiguous in storage
+    uint64_t max_calls = 0;
+    uint64_t max_frames = 0;
+
+    bool dump_requested = false;
+    uint32_t dump_count = 0;
+    ApiDumpBinaryFileHeader file_header{};
+    std::string filename_stem;
+    std::string filename_extension;
+    OutputCompression compression = OutputCompression::None;
+};
+
+#if !defined(_WIN32)
+// Set by the handler of the signal that triggers a dump, and polled by the layer. Stores to a lock free atomic are safe in a
+// signal handler, the dump itself isn't.
+inline std::atomic<bool> flight_recorder_signaled = false;
+
+inline void InstallFlightRecorderSignalHandler(int signal_number) {
+    struct sigaction action {};
+    action.sa_handler = [](int) { flight_recorder_signaled.store(true, std::memory_order_relaxed); };
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(signal_number, &action, nullptr);
+}
+#endif
@@ -0,0 +1,176 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// A run of padding characters, written with FormatBuffer::operator<<. Negative counts write nothing.
+struct FormatPadding {
+    int count;
+    char fill;
+};
+
+// Growable character buffer the api_dump output is formatted into. Values are written the way a default constructed
+// std::ostream writes them, so the output doesn't change, but without sentries, locale lookups or virtual calls per value:
+// - integers in decimal, and char types as characters,
+// - floating point values like printf's %g (6 significant digits),
+// - bool as 1 or 0,
+// - object pointers the way the C++ standard library in use writes them.
+class FormatBuffer {
+   public:
+    static constexpr size_t kInitialCapacity = 4096;
+
+    FormatBuffer() { buffer.reserve(kInitialCapacity); }
+    FormatBuffer(const FormatBuffer &) = delete;
+    FormatBuffer &operator=(const FormatBuffer &) = delete;
+
+    const std::string &str() const { return buffer; }
+    bool empty() const { return buffer.empty(); }
+    size_t size() const { return buffer.size(); }
+    void clear() { buffer.clear(); }
+    std::string take() { return std::move(buffer); }
+
+    void write(const char *data, size_t count) { buffer.append(data, count); }
+
+    FormatBuffer &operator<<(const char *string) {
+        // std::ostream refuses null strings, and then stops writing anything
+        if (string != nullptr) {
+            buffer.append(string);
+        }
+        return *this;
+    }
+    FormatBuffer &operator<<(const signed char *string) { return *this << reinterpret_cast<const char *>(string); }
+    FormatBuffer &operator<<(const unsigned char *string) { return *this << reinterpret_cast<const char *>(string); }
+    FormatBuffer &operator<<(std::string_view string) {
+        buffer.append(string.data(), string.size());
+        return *this;
+    }
+    FormatBuffer &operator<<(const std::string &string) {
+        buffer.append(string);
+        return *this;
+    }
+    FormatBuffer &operator<<(char c) {
+        buffer.push_back(c);
+        return *this;
+    }
+    FormatBuffer &operator<<(signed char c) { return *this << static_cast<char>(c); }
+    FormatBuffer &operator<<(unsigned char c) { return *this << static_cast<char>(c); }
+    FormatBuffer &operator<<(bool value) { return *this << (value ? '1' : '0'); }
+
+    FormatBuffer &operator<<(FormatPadding padding) {
+        if (padding.count > 0) {
+            buffer.append(static_cast<size_t>(padding.count), padding.fill);
+        }
+        return *this;
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T>, FormatBuffer &> operator<<(T value) {
+        char digits[24];
+        const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+        return *this;
+    }
+
+    // Unscoped enums are promoted to an integer, like std::ostream does
+    template <typename T>
+    std::enable_if_t<std::is_enum_v<T>, FormatBuffer &> operator<<(T value) {
+        return *this << +value;
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_floating_point_v<T>, FormatBuffer &> operator<<(T value) {
+        // std::ostream writes floats as doubles
+        using Written = std::conditional_t<std::is_same_v<T, float>, double, T>;
+        char digits[64];
+#if defined(__cpp_lib_to_chars)
+        const std::to_chars_result result =
+            std::to_chars(digits, digits + sizeof(digits), static_cast<Written>(value), std::chars_format::general, 6);
+        buffer.append(digits, result.ptr);
+#else
+        // Standard libraries without floating point to_chars
+        int count = 0;
+        if constexpr (std::is_same_v<Written, long double>) {
+            count = snprintf(digits, sizeof(digits), "%Lg", value);
+        } else {
+            count = snprintf(digits, sizeof(digits), "%g", static_cast<double>(value));
+        }
+        buffer.append(digits, static_cast<size_t>(count > 0 ? count : 0));
+#endif
+        return *this;
+    }
+
+    // Pointers to char types are strings, written by the overloads above
+    template <typename T>
+    std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char> && !std::is_same_v<std::remove_cv_t<T>, signed char> &&
+                         !std::is_same_v<std::remove_cv_t<T>, unsigned char> && !std::is_function_v<T>,
+                     FormatBuffer &>
+    operator<<(T *pointer) {
+        writeAddress(static_cast<const volatile void *>(pointer));
+        return *this;
+    }
+
+    FormatBuffer &operator<<(std::nullptr_t) { return *this << "nullptr"; }
+
+    // Like operator<< with std::hex: integers are written as lowercase hexadecimal digits, without prefix, zero padded to at
+    // least min_digits. Negative integers are written as their two's complement. Anything else is written as usual.
+    template <typename T>
+    FormatBuffer &writeHex(const T &value, int min_digits = 0) {
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) > 1) {
+            char digits[24];
+            const std::to_chars_result result =
+                std::to_chars(digits, digits + sizeof(digits), static_cast<std::make_unsigned_t<T>>(value), 16);
+            const int count = static_cast<int>(result.ptr - digits);
+            *this << FormatPadding{min_digits - count, '0'};
+            buffer.append(digits, result.ptr);
+        } else if constexpr (std::is_enum_v<T>) {
+            writeHex(+value, min_digits);
+        } else {
+            *this << value;
+        }
+        return *this;
+    }
+
+   private:
+    void writeAddress(const volatile void *address) {
+        const uintptr_t value = reinterpret_cast<uintptr_t>(address);
+#if defined(__GLIBCXX__)
+        // libstdc++ writes null as 0, and other addresses in hexadecimal with the 0x prefix
+        if (value == 0) {
+            buffer.push_back('0');
+            return;
+        }
+        buffer.append("0x", 2);
+        writeHex(value);
+#else
+        // libc++ and the MSVC STL write addresses with %p
+        char digits[32];
+        const int count = snprintf(digits, sizeof(digits), "%p", const_cast<const void *>(address));
+        buffer.append(digits, static_cast<size_t>(count > 0 ? count : 0));
+#endif
+    }
+
+    std::string buffer;
+};
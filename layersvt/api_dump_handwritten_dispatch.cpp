@@ -30,34 +30,10 @@
 extern "C" {
 
 EXPORT_FUNCTION VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(VkInstance instance, const char* pName) {
-    PFN_vkVoidFunction instance_func = nullptr;
-    switch (ApiDumpInstance::current().settings().format()) {
-        case ApiDumpFormat::Text:
-            instance_func = api_dump_known_instance_functions<ApiDumpFormat::Text>(instance, pName);
-            break;
-        case ApiDumpFormat::Html:
-            instance_func = api_dump_known_instance_functions<ApiDumpFormat::Html>(instance, pName);
-            break;
-        case ApiDumpFormat::Json:
-            instance_func = api_dump_known_instance_functions<ApiDumpFormat::Json>(instance, pName);
-            break;
-    }
-    if (instance_func) return instance_func;
-    PFN_vkVoidFunction device_func = nullptr;
-
-    switch (ApiDumpInstance::current().settings().format()) {
-        case ApiDumpFormat::Text:
-            device_func = api_dump_known_device_functions<ApiDumpFormat::Text>(NULL, pName);
-            break;
-        case ApiDumpFormat::Html:
-            device_func = api_dump_known_device_functions<ApiDumpFormat::Html>(NULL, pName);
-            break;
-        case ApiDumpFormat::Json:
-            device_func = api_dump_known_device_functions<ApiDumpFormat::Json>(NULL, pName);
-            break;
-    }
-    // Make sure that device functions queried through GIPA works
-    if (device_func) return device_func;
+    const ApiDumpCommand* command = api_dump_find_command(ApiDumpInstance::current().settings(), pName);
+    // Instance functions, and device functions since querying them through GIPA must work. Functions filtered out by
+    // include_functions or exclude_functions go straight to the next layer.
+    if (command && command->intercepted()) return command->function;
 
     // Haven't created an instance yet, exit now since there is no instance_dispatch_table
     if (instance_dispatch_table(instance)->GetInstanceProcAddr == NULL) return nullptr;
@@ -65,19 +41,8 @@ EXPORT_FUNCTION VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(V
 }
 
 EXPORT_FUNCTION VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice device, const char* pName) {
-    PFN_vkVoidFunction device_func = nullptr;
-    switch (ApiDumpInstance::current().settings().format()) {
-        case ApiDumpFormat::Text:
-            device_func = api_dump_known_device_functions<ApiDumpFormat::Text>(device, pName);
-            break;
-        case ApiDumpFormat::Html:
-            device_func = api_dump_known_device_functions<ApiDumpFormat::Html>(device, pName);
-            break;
-        case ApiDumpFormat::Json:
-            device_func = api_dump_known_device_functions<ApiDumpFormat::Json>(device, pName);
-            break;
-    }
-    if (device_func) return device_func;
+    const ApiDumpCommand* command = api_dump_find_command(ApiDumpInstance::current().settings(), pName);
+    if (command && command->device && (!device || command->availableOn(device)) && command->intercepted()) return command->function;
 
     // Haven't created a device yet, exit now since there is no device_dispatch_table
     if (device_dispatch_table(device)->GetDeviceProcAddr == NULL) return nullptr;
@@ -43,8 +43,17 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo* pCre
     _CrtSetReportFile(_CRT_ASSERT, _CRTDBG_FILE_STDERR);
 #endif
 
-    std::lock_guard<std::mutex> lg(ApiDumpInstance::current().outputMutex());
-    ApiDumpInstance::current().initLayerSettings(pCreateInfo, pAllocator);
+    ApiDumpRecordGuard lg(ApiDumpInstance::current(), ApiDumpFunctionId::vkCreateInstance);
+    ApiDumpCallContext call_context;
+    {
+        // The settings are rewritten in place, which must not happen while another thread holds the output lock, even when
+        // this call is buffered or filtered out and the guard doesn't hold it.
+        std::unique_lock<std::mutex> settings_lock(ApiDumpInstance::current().outputMutex(), std::defer_lock);
+        if (!lg.holdsOutputLock()) {
+            settings_lock.lock();
+        }
+        ApiDumpInstance::current().initLayerSettings(pCreateInfo, pAllocator);
+    }
     dump_function_head(ApiDumpInstance::current(), "vkCreateInstance", "pCreateInfo, pAllocator, pInstance", "VkResult");
     if (ApiDumpInstance::current().settings().shouldPreDump() &&
         ApiDumpInstance::current().settings().format() == ApiDumpFormat::Text && ApiDumpInstance::current().shouldDumpOutput()) {
@@ -64,9 +73,12 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo* pCre
 
     // Call the function and create the dispatch table
     chain_info->u.pLayerInfo = chain_info->u.pLayerInfo->pNext;
+    ApiDumpCallTimer call_timer(ApiDumpInstance::current(), ApiDumpFunctionId::vkCreateInstance);
     VkResult result = fpCreateInstance(pCreateInfo, pAllocator, pInstance);
+    call_timer.stop();
     if (result == VK_SUCCESS) {
         initInstanceTable(*pInstance, fpGetInstanceProcAddr);
+        ApiDumpInstance::current().pipelineProfile().addInstance(*pInstance, pCreateInfo);
     }
 
     // Output the API dump
@@ -93,6 +105,17 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo* pCre
                 dump_params_vkCreateInstance<ApiDumpFormat::Json>(ApiDumpInstance::current(), pCreateInfo, pAllocator, pInstance);
                 dump_post_function_formatting<ApiDumpFormat::Json>(ApiDumpInstance::current().settings());
                 break;
+            case ApiDumpFormat::Binary:
+                dump_return_value<ApiDumpFormat::Binary>(ApiDumpInstance::current().settings(), "VkResult", result,
+                                                         dump_return_value_VkResult<ApiDumpFormat::Binary>);
+                dump_params_vkCreateInstance<ApiDumpFormat::Binary>(ApiDumpInstance::current(), pCreateInfo, pAllocator, pInstance);
+                break;
+            case ApiDumpFormat::Trace:
+                dump_return_value<ApiDumpFormat::Trace>(ApiDumpInstance::current().settings(), "VkResult", result,
+                                                        dump_return_value_VkResult<ApiDumpFormat::Trace>);
+                dump_params_vkCreateInstance<ApiDumpFormat::Trace>(ApiDumpInstance::current(), pCreateInfo, pAllocator, pInstance);
+                dump_post_function_formatting<ApiDumpFormat::Trace>(ApiDumpInstance::current().settings());
+                break;
         }
         flush(ApiDumpInstance::current().settings());
     }
@@ -101,12 +124,13 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo* pCre
 }
 }
 
-template <ApiDumpFormat Format>
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
 VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo* pCreateInfo,
                                               const VkAllocationCallbacks* pAllocator, VkDevice* pDevice) {
-    std::lock_guard<std::mutex> lg(ApiDumpInstance::current().outputMutex());
-    dump_function_head(ApiDumpInstance::current(), "vkCreateDevice", "physicalDevice, pCreateInfo, pAllocator, pDevice",
-                       "VkResult");
+    ApiDumpRecordGuard lg(ApiDumpInstance::current(), ApiDumpFunctionId::vkCreateDevice);
+    ApiDumpCallContext call_context;
+    dump_function_head<Features>(ApiDumpInstance::current(), "vkCreateDevice", "physicalDevice, pCreateInfo, pAllocator, pDevice",
+                                 "VkResult");
     if (ApiDumpInstance::current().settings().shouldPreDump() &&
         ApiDumpInstance::current().settings().format() == ApiDumpFormat::Text && ApiDumpInstance::current().shouldDumpOutput()) {
         dump_before_pre_dump_formatting<ApiDumpFormat::Text>(ApiDumpInstance::current().settings());
@@ -127,16 +151,24 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice physicalDevice, c
 
     // Call the function and create the dispatch table
     chain_info->u.pLayerInfo = chain_info->u.pLayerInfo->pNext;
+    ApiDumpCallTimer call_timer(ApiDumpInstance::current(), ApiDumpFunctionId::vkCreateDevice);
     VkResult result = fpCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+    call_timer.stop();
     if (result == VK_SUCCESS) {
         initDeviceTable(*pDevice, fpGetDeviceProcAddr);
+        if (ApiDumpInstance::current().pipelineProfile().enabled()) {
+            VkPhysicalDeviceProperties properties{};
+            instance_dispatch_table(physicalDevice)->GetPhysicalDeviceProperties(physicalDevice, &properties);
+            ApiDumpInstance::current().pipelineProfile().addDevice(*pDevice, vk_instance, properties.apiVersion, pCreateInfo);
+        }
     }
 
     // Output the API dump
     if (ApiDumpInstance::current().shouldDumpOutput()) {
-        dump_return_value<Format>(ApiDumpInstance::current().settings(), "VkResult", result, dump_return_value_VkResult<Format>);
-        dump_pre_function_formatting<Format>(ApiDumpInstance::current().settings());
-        dump_params_vkCreateDevice<Format>(ApiDumpInstance::current(), physicalDevice, pCreateInfo, pAllocator, pDevice);
+        dump_return_value<Format, Features>(ApiDumpInstance::current().settings(), "VkResult", result,
+                                            dump_return_value_VkResult<Format>);
+        dump_pre_function_formatting<Format, Features>(ApiDumpInstance::current().settings());
+        dump_params_vkCreateDevice<Format, Features>(ApiDumpInstance::current(), physicalDevice, pCreateInfo, pAllocator, pDevice);
         dump_post_function_formatting<Format>(ApiDumpInstance::current().settings());
 
         flush(ApiDumpInstance::current().settings());
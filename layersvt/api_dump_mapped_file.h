@@ -0,0 +1,149 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Whether the output file can be written through a memory mapping on this platform.
+inline bool IsMappedFileOutputSupported() {
+#if !defined(_WIN32)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if !defined(_WIN32)
+
+// Stream buffer that writes a file through a shared memory mapping. The file is grown kWindowSize bytes at a time, and the
+// window at its end is mapped, so writing to the stream is a copy into the page cache without a system call. What is written
+// is visible to other processes reading the file right away, and is kept by the kernel if the process crashes. Until the file
+// is closed, it is followed by zeros up to the end of the window. Closing the file truncates it to what was written.
+class MappedFileBuf final : public std::streambuf {
+   public:
+    static const size_t kWindowSize = 32 << 20;
+
+    MappedFileBuf() = default;
+    MappedFileBuf(const MappedFileBuf &) = delete;
+    MappedFileBuf &operator=(const MappedFileBuf &) = delete;
+
+    ~MappedFileBuf() {
+        if (fd < 0) {
+            return;
+        }
+        unmapWindow();
+        if (ftruncate(fd, written_size) != 0) {
+            // The output is all there, but followed by the zeros of the rest of the last window
+            std::cerr << "api_dump: couldn't truncate the mapped output file to " << written_size << " bytes: " << strerror(errno)
+                      << std::endl;
+        }
+        close(fd);
+    }
+
+    bool open(const std::string &filename) {
+        fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (!mapWindow(0)) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+   protected:
+    int_type overflow(int_type c) override {
+        if (fd < 0) {
+            return traits_type::eof();
+        }
+        if (!mapWindow(window_offset + static_cast<off_t>(kWindowSize))) {
+            return traits_type::eof();
+        }
+        if (c != traits_type::eof()) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char_type *data, std::streamsize size) override {
+        std::streamsize written = 0;
+        while (written < size) {
+            if (pptr() == epptr() && overflow(traits_type::eof()) == traits_type::eof()) {
+                break;
+            }
+            const std::streamsize part = std::min<std::streamsize>(size - written, epptr() - pptr());
+            traits_type::copy(pptr(), data + written, static_cast<size_t>(part));
+            pbump(static_cast<int>(part));
+            written += part;
+        }
+        return written;
+    }
+
+    // The mapped pages are in the page cache already, where readers and the kernel find them, so there is nothing to flush.
+    int sync() override { return fd >= 0 ? 0 : -1; }
+
+   private:
+    // Grows the file to hold the window at offset, and maps it in place of the previous one
+    bool mapWindow(off_t offset) {
+        unmapWindow();
+        if (ftruncate(fd, offset + static_cast<off_t>(kWindowSize)) != 0) {
+            return false;
+        }
+        void *mapped = mmap(nullptr, kWindowSize, PROT_WRITE, MAP_SHARED, fd, offset);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        window = static_cast<char *>(mapped);
+        window_offset = offset;
+        setp(window, window + kWindowSize);
+        return true;
+    }
+
+    void unmapWindow() {
+        if (window != nullptr) {
+            written_size = window_offset + static_cast<off_t>(pptr() - pbase());
+            munmap(window, kWindowSize);
+            window = nullptr;
+            setp(nullptr, nullptr);
+        }
+    }
+
+    int fd = -1;
+    char *window = nullptr;
+    off_t window_offset = 0;  // Of the window in the file
+    off_t written_size = 0;   // Up to the current window
+};
+
+#endif  // !_WIN32
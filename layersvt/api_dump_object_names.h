@@ -0,0 +1,295 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Names given to objects through vkSetDebugUtilsObjectNameEXT and vkDebugMarkerSetObjectNameEXT, which are looked up for every
+// handle the layer prints.
+//
+// Lookups are wait free: they probe an open addressing table of atomic slots without taking a lock. Names are interned, each
+// distinct name is stored once and the slots point to it. Writers serialize on a mutex, and replace the table with a larger one
+// when it fills up. Tables and names that are no longer referenced are freed with epoch based reclamation: each reading thread
+// announces the epoch it started reading in, and what was retired in an epoch is freed once no thread reads in that epoch or an
+// earlier one. The readers are thread local, so there is only one of these, in ApiDumpInstance.
+class ApiDumpObjectNames {
+   public:
+    ApiDumpObjectNames() = default;
+    ApiDumpObjectNames(const ApiDumpObjectNames &) = delete;
+    ApiDumpObjectNames &operator=(const ApiDumpObjectNames &) = delete;
+
+    // Calls function with the name of handle and returns true, or returns false if handle has no name. The name is only valid
+    // during the call.
+    template <typename Function>
+    bool visit(uint64_t handle, Function &&function) const {
+        if (table.load(std::memory_order_relaxed) == nullptr) {
+            // No object was ever named
+            return false;
+        }
+        Reader &reader = threadReader();
+        reader.epoch.store(epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        // Orders the announcement before the table is read, see retire()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::string *name = find(table.load(std::memory_order_acquire), handle);
+        if (name != nullptr) {
+            function(*name);
+        }
+        reader.epoch.store(0, std::memory_order_release);
+        return name != nullptr;
+    }
+
+    // Names handle, or removes its name when name is null.
+    void set(uint64_t handle, const char *name) {
+        if (name == nullptr) {
+            erase(handle);
+            return;
+        }
+        if (handle == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lg(write_mutex);
+        const std::string *interned = intern(name);
+        Slot *slot = current_table ? findSlot(current_table.get(), handle) : nullptr;
+        if (slot == nullptr || slot->handle.load(std::memory_order_relaxed) == 0) {
+            if (!current_table || (current_table->used + 1) * 2 > current_table->mask + 1) {
+                rebuild();
+            }
+            slot = findSlot(current_table.get(), handle);
+            ++current_table->used;
+        }
+        const std::string *previous = slot->name.load(std::memory_order_relaxed);
+        // The name is stored before the handle, so that readers finding the handle find its name
+        slot->name.store(interned, std::memory_order_release);
+        slot->handle.store(handle, std::memory_order_release);
+        release(previous);
+        reclaim();
+    }
+
+    // Removes the name of handle, when it is destroyed. Doesn't lock when the handle has no name.
+    void erase(uint64_t handle) {
+        if (handle == 0 || table.load(std::memory_order_relaxed) == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lg(write_mutex);
+        Slot *slot = findSlot(current_table.get(), handle);
+        if (slot->handle.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        // The handle stays in its slot without a name, the slot is reused if the handle is named again and dropped when the
+        // table is rebuilt
+        const std::string *previous = slot->name.exchange(nullptr, std::memory_order_release);
+        release(previous);
+        reclaim();
+    }
+
+   private:
+    struct Slot {
+        std::atomic<uint64_t> handle{0};  // 0 when the slot is free
+        std::atomic<const std::string *> name{nullptr};
+    };
+
+    struct Table {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        size_t used = 0;  // Slots with a handle, named or not
+    };
+
+    struct InternedName {
+        uint32_t references = 0;
+        uint64_t retire_epoch = 0;  // Of the last time it was no longer referenced
+    };
+
+    // Announces the epoch its thread is reading in, or 0 when it isn't reading. Allocated once per thread, and reused by the
+    // threads that start after it exited. They are never freed, as threads may exit after the layer is unloaded.
+    struct Reader {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{true};
+        Reader *next = nullptr;
+    };
+
+    // Something to free once no thread reads in retire_epoch or before.
+    struct Retired {
+        uint64_t retire_epoch;
+        std::unique_ptr<Table> table;
+        const std::string *name;
+    };
+
+    static const size_t kMinCapacity = 1024;
+
+    static size_t hash(uint64_t handle) {
+        handle ^= handle >> 33;
+        handle *= 0xff51afd7ed558ccdull;
+        handle ^= handle >> 33;
+        return static_cast<size_t>(handle);
+    }
+
+    // Returns the slot of handle, or the free slot where it goes. Tables are never full.
+    static Slot *findSlot(Table *current, uint64_t handle) {
+        for (size_t i = hash(handle) & current->mask;; i = (i + 1) & current->mask) {
+            const uint64_t slot_handle = current->slots[i].handle.load(std::memory_order_acquire);
+            if (slot_handle == handle || slot_handle == 0) {
+                return &current->slots[i];
+            }
+        }
+    }
+
+    static const std::string *find(Table *current, uint64_t handle) {
+        if (current == nullptr) {
+            return nullptr;
+        }
+        Slot *slot = findSlot(current, handle);
+        return slot->handle.load(std::memory_order_relaxed) == handle ? slot->name.load(std::memory_order_acquire) : nullptr;
+    }
+
+    Reader &threadReader() const {
+        struct ThreadReader {
+            Reader *reader = nullptr;
+            ~ThreadReader() {
+                if (reader != nullptr) {
+                    reader->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+        thread_local ThreadReader thread_reader;
+        if (thread_reader.reader == nullptr) {
+            thread_reader.reader = acquireReader();
+        }
+        return *thread_reader.reader;
+    }
+
+    Reader *acquireReader() const {
+        for (Reader *reader = readers.load(std::memory_order_acquire); reader != nullptr; reader = reader->next) {
+            bool in_use = false;
+            if (reader->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+                return reader;
+            }
+        }
+        Reader *reader = new Reader;
+        reader->next = readers.load(std::memory_order_relaxed);
+        while (!readers.compare_exchange_weak(reader->next, reader, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return reader;
+    }
+
+    const std::string *intern(const char *name) {
+        auto it = interned_names.try_emplace(name).first;
+        ++it->second.references;
+        return &it->first;
+    }
+
+    void release(const std::string *name) {
+        if (name == nullptr) {
+            return;
+        }
+        InternedName &interned = interned_names.find(*name)->second;
+        if (--interned.references == 0) {
+            interned.retire_epoch = retire({0, nullptr, name});
+        }
+    }
+
+    // Replaces the table with one holding the named handles, without the handles whose name was removed, and with room for
+    // more.
+    void rebuild() {
+        Table *current = current_table.get();
+        size_t named = 1;
+        if (current != nullptr) {
+            for (size_t i = 0; i <= current->mask; ++i) {
+                named += current->slots[i].name.load(std::memory_order_relaxed) != nullptr;
+            }
+        }
+        size_t capacity = kMinCapacity;
+        while (capacity < named * 4) {
+            capacity *= 2;
+        }
+        auto rebuilt = std::make_unique<Table>(capacity);
+        if (current != nullptr) {
+            for (size_t i = 0; i <= current->mask; ++i) {
+                const std::string *name = current->slots[i].name.load(std::memory_order_relaxed);
+                if (name != nullptr) {
+                    Slot *slot = findSlot(rebuilt.get(), current->slots[i].handle.load(std::memory_order_relaxed));
+                    slot->name.store(name, std::memory_order_relaxed);
+                    slot->handle.store(current->slots[i].handle.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    ++rebuilt->used;
+                }
+            }
+        }
+        table.store(rebuilt.get(), std::memory_order_release);
+        std::unique_ptr<Table> previous = std::move(current_table);
+        current_table = std::move(rebuilt);
+        if (previous) {
+            retire({0, std::move(previous), nullptr});
+        }
+    }
+
+    // Must be called once what is retired can no longer be reached by readers that start reading from now on. Returns the epoch
+    // it was retired in.
+    uint64_t retire(Retired retired) {
+        // A reader that announces a later epoch read the epoch after it was advanced, and can't reach what was retired. The
+        // fence pairs with the one in visit(): either this thread sees the announcement of a reader, or the reader sees what
+        // was changed before retiring.
+        retired.retire_epoch = epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint64_t retire_epoch = retired.retire_epoch;
+        retired_list.push_back(std::move(retired));
+        return retire_epoch;
+    }
+
+    // Frees what was retired before the oldest epoch a thread is reading in.
+    void reclaim() {
+        if (retired_list.empty()) {
+            return;
+        }
+        uint64_t oldest = UINT64_MAX;
+        for (Reader *reader = readers.load(std::memory_order_acquire); reader != nullptr; reader = reader->next) {
+            const uint64_t reader_epoch = reader->epoch.load(std::memory_order_acquire);
+            if (reader_epoch != 0) {
+                oldest = std::min(oldest, reader_epoch);
+            }
+        }
+        auto reclaimable = std::stable_partition(retired_list.begin(), retired_list.end(),
+                                                 [oldest](const Retired &retired) { return retired.retire_epoch >= oldest; });
+        // Oldest first, a name retired more than once is only freed by its last retirement
+        for (auto it = reclaimable; it != retired_list.end(); ++it) {
+            if (it->name != nullptr) {
+                auto interned = interned_names.find(*it->name);
+                if (interned->second.references == 0 && interned->second.retire_epoch == it->retire_epoch) {
+                    interned_names.erase(interned);
+                }
+            }
+        }
+        retired_list.erase(reclaimable, retired_list.end());
+    }
+
+    std::atomic<Table *> table{nullptr};
+    mutable std::atomic<uint64_t> epoch{1};
+    mutable std::atomic<Reader *> readers{nullptr};
+
+    // Only used by writers, with the write mutex held
+    std::mutex write_mutex;
+    std::unique_ptr<Table> current_table;  // Retired ones are owned by retired_list
+    std::unordered_map<std::string, InternedName> interned_names;
+    std::vector<Retired> retired_list;
+};
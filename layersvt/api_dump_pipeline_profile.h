@@ -0,0 +1,699 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "api_dump_object_names.h"
+#include "api_dump_spirv.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Where the time spent creating pipelines goes, for the pipeline_profile setting. Every pipeline created in the run is timed, the
+// slowest ones are kept, and the time is attributed to the shaders they were created from, which are identified by the XXH64 of
+// their SPIR-V, as the files save_shaders writes are named. A report is written once the layer is unloaded.
+//
+// Pipeline creation is rare and slow compared to the lock, so the state has a single mutex.
+class ApiDumpPipelineProfile {
+   public:
+    enum class Kind { Pipeline, Library, Linked };
+
+    // Where the duration of a pipeline comes from: the VkPipelineCreationFeedback the driver wrote, the call that created it
+    // alone, or an even share of the call that created it with others, when the driver didn't write the feedback.
+    enum class DurationSource { Feedback, Call, Batch };
+
+    struct Stage {
+        VkShaderStageFlagBits stage;
+        uint64_t shader_hash;  // 0 if the code of the shader isn't known
+        uint64_t duration_ns;  // 0 without feedback for the stage
+    };
+
+    struct Pipeline {
+        const char *function = nullptr;
+        uint64_t sequence = 0;  // Order of creation in the run, from 1
+        uint64_t handle = 0;
+        Kind kind = Kind::Pipeline;
+        uint64_t duration_ns = 0;
+        DurationSource source = DurationSource::Call;
+        VkPipelineCreationFeedbackFlags feedback_flags = 0;  // 0 without feedback
+        std::vector<Stage> stages;                           // For linked pipelines, the stages of their libraries
+        std::string name;                                    // Taken when the pipeline is destroyed, or when the report is written
+        bool destroyed = false;
+    };
+
+    // Must be called before any pipeline is created. ranked_count is the number of pipelines the report ranks.
+    void init(const std::string &path, uint32_t ranked_count) {
+        std::lock_guard<std::mutex> lg(mutex);
+        report_path = path;
+        max_ranked = ranked_count;
+        is_enabled = true;
+    }
+
+    bool enabled() const { return is_enabled; }
+
+    void addInstance(VkInstance instance, const VkInstanceCreateInfo *create_info) {
+        if (!is_enabled) return;
+        const VkApplicationInfo *application_info = create_info->pApplicationInfo;
+        const uint32_t api_version =
+            application_info != nullptr && application_info->apiVersion != 0 ? application_info->apiVersion : VK_API_VERSION_1_0;
+        std::lock_guard<std::mutex> lg(mutex);
+        instance_versions[instance] = api_version;
+    }
+
+    void eraseInstance(VkInstance instance) {
+        if (!is_enabled) return;
+        std::lock_guard<std::mutex> lg(mutex);
+        instance_versions.erase(instance);
+    }
+
+    // The layer only chains a VkPipelineCreationFeedbackCreateInfo of its own when the device can take one, as
+    // VK_EXT_pipeline_creation_feedback is enabled or the device is used as Vulkan 1.3.
+    void addDevice(VkDevice device, VkInstance instance, uint32_t physical_device_version, const VkDeviceCreateInfo *create_info) {
+        if (!is_enabled) return;
+        bool feedback = false;
+        for (uint32_t i = 0; i < create_info->enabledExtensionCount; ++i) {
+            feedback = feedback || strcmp(create_info->ppEnabledExtensionNames[i], VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME) == 0;
+        }
+        std::lock_guard<std::mutex> lg(mutex);
+        const auto instance_version = instance_versions.find(instance);
+        if (instance_version != instance_versions.end()) {
+            const uint32_t device_version = std::min(instance_version->second, physical_device_version);
+            feedback = feedback || device_version >= VK_API_VERSION_1_3;
+        }
+        feedback_devices[device] = feedback;
+    }
+
+    void eraseDevice(VkDevice device) {
+        if (!is_enabled) return;
+        std::lock_guard<std::mutex> lg(mutex);
+        feedback_devices.erase(device);
+    }
+
+    bool canChainFeedback(VkDevice device) {
+        std::lock_guard<std::mutex> lg(mutex);
+        const auto feedback = feedback_devices.find(device);
+        return feedback != feedback_devices.end() && feedback->second;
+    }
+
+    void addShaderModule(VkShaderModule shader_module, const VkShaderModuleCreateInfo *create_info) {
+        if (!is_enabled) return;
+        const uint64_t hash = HashXXH64(create_info->pCode, create_info->codeSize);
+        std::lock_guard<std::mutex> lg(mutex);
+        shader_hashes[shader_module] = hash;
+    }
+
+    void eraseShaderModule(VkShaderModule shader_module) {
+        if (!is_enabled) return;
+        std::lock_guard<std::mutex> lg(mutex);
+        shader_hashes.erase(shader_module);
+    }
+
+    // The hash of the code a pipeline stage is created from, which is either a shader module or a VkShaderModuleCreateInfo in
+    // its pNext chain. 0 if neither is known, as for stages created from a shader module identifier.
+    uint64_t shaderHash(const VkPipelineShaderStageCreateInfo &stage) {
+        if (stage.module == VK_NULL_HANDLE) {
+            const auto *create_info = findInChain<VkShaderModuleCreateInfo>(stage.pNext, VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO);
+            return create_info != nullptr ? HashXXH64(create_info->pCode, create_info->codeSize) : 0;
+        }
+        std::lock_guard<std::mutex> lg(mutex);
+        const auto hash = shader_hashes.find(stage.module);
+        return hash != shader_hashes.end() ? hash->second : 0;
+    }
+
+    // The stages of the pipeline libraries a pipeline is linked from.
+    std::vector<Stage> libraryStages(const VkPipelineLibraryCreateInfoKHR &library_info) {
+        std::vector<Stage> stages;
+        std::lock_guard<std::mutex> lg(mutex);
+        for (uint32_t i = 0; i < library_info.libraryCount; ++i) {
+            const auto library = library_stages.find(library_info.pLibraries[i]);
+            if (library != library_stages.end()) {
+                for (const Stage &stage : library->second) {
+                    stages.push_back({stage.stage, stage.shader_hash, 0});
+                }
+            }
+        }
+        return stages;
+    }
+
+    // Adds the pipelines of a call to the profile. created is the pipelines the call created, not_created the number of create
+    // infos that didn't result in a pipeline.
+    void record(uint64_t call_ns, std::vector<Pipeline> &&created, uint32_t not_created) {
+        std::lock_guard<std::mutex> lg(mutex);
+        ++totals.calls;
+        totals.call_ns += call_ns;
+        totals.not_created += not_created;
+        for (Pipeline &pipeline : created) {
+            pipeline.sequence = ++totals.pipelines;
+            if (pipeline.kind == Kind::Library) {
+                ++totals.libraries;
+                library_stages[(VkPipeline)pipeline.handle] = pipeline.stages;
+            } else if (pipeline.kind == Kind::Linked) {
+                ++totals.linked;
+            }
+            if (pipeline.source == DurationSource::Feedback) {
+                ++totals.feedback;
+                if (pipeline.feedback_flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) {
+                    ++totals.cache_hits;
+                }
+            }
+            attributeToShaders(pipeline);
+            rank(std::move(pipeline));
+        }
+    }
+
+    // Calls with a deferred operation return before the pipelines are created, they are counted but not timed.
+    void recordDeferred() {
+        std::lock_guard<std::mutex> lg(mutex);
+        ++totals.deferred_calls;
+    }
+
+    // Keeps the name of the pipeline if it is ranked, since its handle may be reused once it is destroyed.
+    void erasePipeline(VkPipeline pipeline, const ApiDumpObjectNames &names) {
+        if (!is_enabled || pipeline == VK_NULL_HANDLE) return;
+        std::lock_guard<std::mutex> lg(mutex);
+        library_stages.erase(pipeline);
+        for (Pipeline &ranked_pipeline : ranked) {
+            if (ranked_pipeline.handle == (uint64_t)pipeline && !ranked_pipeline.destroyed) {
+                names.visit(ranked_pipeline.handle, [&](const std::string &name) { ranked_pipeline.name = name; });
+                ranked_pipeline.destroyed = true;
+            }
+        }
+    }
+
+    // Writes the report, as json if its file name ends in .json and as text otherwise.
+    void writeReport(const ApiDumpObjectNames &names) {
+        if (!is_enabled) return;
+        std::lock_guard<std::mutex> lg(mutex);
+        for (Pipeline &pipeline : ranked) {
+            if (!pipeline.destroyed) {
+                names.visit(pipeline.handle, [&](const std::string &name) { pipeline.name = name; });
+            }
+        }
+        std::vector<Pipeline> slowest = ranked;
+        std::sort(slowest.begin(), slowest.end(), [](const Pipeline &a, const Pipeline &b) { return slowerThan(a, b); });
+        std::vector<std::pair<uint64_t, ShaderTotals>> shaders(shader_totals.begin(), shader_totals.end());
+        std::sort(shaders.begin(), shaders.end(), [](const auto &a, const auto &b) {
+            return a.second.duration_ns != b.second.duration_ns ? a.second.duration_ns > b.second.duration_ns : a.first < b.first;
+        });
+
+        std::ofstream file(report_path, std::ofstream::trunc);
+        const bool json = report_path.size() >= 5 && report_path.compare(report_path.size() - 5, 5, ".json") == 0;
+        if (json) {
+            writeJson(file, slowest, shaders);
+        } else {
+            writeText(file, slowest, shaders);
+        }
+        if (!file) {
+            std::cerr << "api_dump: could not write the pipeline profile to " << report_path << std::endl;
+        }
+    }
+
+    template <typename T>
+    static const T *findInChain(const void *next, VkStructureType type) {
+        for (auto *base = static_cast<const VkBaseInStructure *>(next); base != nullptr; base = base->pNext) {
+            if (base->sType == type) {
+                return reinterpret_cast<const T *>(base);
+            }
+        }
+        return nullptr;
+    }
+
+   private:
+    struct Totals {
+        uint64_t calls = 0;
+        uint64_t call_ns = 0;
+        uint64_t pipelines = 0;
+        uint64_t libraries = 0;
+        uint64_t linked = 0;
+        uint64_t not_created = 0;
+        uint64_t deferred_calls = 0;
+        uint64_t feedback = 0;
+        uint64_t cache_hits = 0;
+    };
+
+    struct ShaderTotals {
+        VkShaderStageFlags stages = 0;
+        uint64_t pipelines = 0;
+        uint64_t duration_ns = 0;
+    };
+
+    static bool slowerThan(const Pipeline &a, const Pipeline &b) {
+        return a.duration_ns != b.duration_ns ? a.duration_ns > b.duration_ns : a.sequence < b.sequence;
+    }
+
+    // The time of a stage is its feedback when the driver wrote one for every stage, and an even share of the time of the
+    // pipeline otherwise.
+    void attributeToShaders(const Pipeline &pipeline) {
+        if (pipeline.stages.empty()) {
+            return;
+        }
+        bool stage_feedback = true;
+        for (const Stage &stage : pipeline.stages) {
+            stage_feedback = stage_feedback && stage.duration_ns != 0;
+        }
+        for (const Stage &stage : pipeline.stages) {
+            if (stage.shader_hash == 0) {
+                continue;
+            }
+            ShaderTotals &shader = shader_totals[stage.shader_hash];
+            shader.stages |= stage.stage;
+            ++shader.pipelines;
+            shader.duration_ns += stage_feedback ? stage.duration_ns : pipeline.duration_ns / pipeline.stages.size();
+        }
+    }
+
+    // Keeps the max_ranked slowest pipelines in a min heap.
+    void rank(Pipeline &&pipeline) {
+        if (max_ranked == 0) {
+            return;
+        }
+        if (ranked.size() < max_ranked) {
+            ranked.push_back(std::move(pipeline));
+            std::push_heap(ranked.begin(), ranked.end(), slowerThan);
+        } else if (slowerThan(pipeline, ranked.front())) {
+            std::pop_heap(ranked.begin(), ranked.end(), slowerThan);
+            ranked.back() = std::move(pipeline);
+            std::push_heap(ranked.begin(), ranked.end(), slowerThan);
+        }
+    }
+
+    static const char *stageName(VkShaderStageFlags stage) {
+        switch (stage) {
+            case VK_SHADER_STAGE_VERTEX_BIT:
+                return "vert";
+            case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+                return "tesc";
+            case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+                return "tese";
+            case VK_SHADER_STAGE_GEOMETRY_BIT:
+                return "geom";
+            case VK_SHADER_STAGE_FRAGMENT_BIT:
+                return "frag";
+            case VK_SHADER_STAGE_COMPUTE_BIT:
+                return "comp";
+            case VK_SHADER_STAGE_TASK_BIT_EXT:
+                return "task";
+            case VK_SHADER_STAGE_MESH_BIT_EXT:
+                return "mesh";
+            case VK_SHADER_STAGE_RAYGEN_BIT_KHR:
+                return "rgen";
+            case VK_SHADER_STAGE_ANY_HIT_BIT_KHR:
+                return "rahit";
+            case VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:
+                return "rchit";
+            case VK_SHADER_STAGE_MISS_BIT_KHR:
+                return "rmiss";
+            case VK_SHADER_STAGE_INTERSECTION_BIT_KHR:
+                return "rint";
+            case VK_SHADER_STAGE_CALLABLE_BIT_KHR:
+                return "rcall";
+            default:
+                return "other";
+        }
+    }
+
+    static std::string stageNames(VkShaderStageFlags stages) {
+        std::string names;
+        for (uint32_t bit = 0; bit < 32; ++bit) {
+            if (stages & (1u << bit)) {
+                if (!names.empty()) names += ',';
+                names += stageName(1u << bit);
+            }
+        }
+        return names;
+    }
+
+    static std::string hashText(uint64_t hash) {
+        if (hash == 0) {
+            return "unknown";
+        }
+        char text[17];
+        snprintf(text, sizeof(text), "%016" PRIx64, hash);
+        return text;
+    }
+
+    static const char *kindName(Kind kind) {
+        switch (kind) {
+            case Kind::Library:
+                return "library";
+            case Kind::Linked:
+                return "linked";
+            default:
+                return "pipeline";
+        }
+    }
+
+    static const char *sourceName(DurationSource source) {
+        switch (source) {
+            case DurationSource::Feedback:
+                return "feedback";
+            case DurationSource::Batch:
+                return "batch";
+            default:
+                return "call";
+        }
+    }
+
+    static const char *cacheHitName(const Pipeline &pipeline) {
+        if (pipeline.source != DurationSource::Feedback) {
+            return "unknown";
+        }
+        return (pipeline.feedback_flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) ? "hit" : "miss";
+    }
+
+    static std::string jsonString(const std::string &text) {
+        std::string quoted = "\"";
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                quoted += escaped;
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    void writeText(std::ostream &out, const std::vector<Pipeline> &slowest,
+                   const std::vector<std::pair<uint64_t, ShaderTotals>> &shaders) const {
+        char line[512];
+        out << "Pipeline creation profile:\n";
+        snprintf(line, sizeof(line),
+                 "%" PRIu64 " calls created %" PRIu64 " pipelines (%" PRIu64 " libraries, %" PRIu64 " linked) in %.3f ms, %" PRIu64
+                 " not created, %" PRIu64 " deferred calls\n",
+                 totals.calls, totals.pipelines, totals.libraries, totals.linked, totals.call_ns / 1e6, totals.not_created,
+                 totals.deferred_calls);
+        out << line;
+        snprintf(line, sizeof(line), "Feedback for %" PRIu64 " pipelines, %" PRIu64 " application pipeline cache hits\n\n",
+                 totals.feedback, totals.cache_hits);
+        out << line;
+
+        out << "Slowest pipelines:\n";
+        snprintf(line, sizeof(line), "%5s %12s %-8s %-7s %-8s %-30s %-18s %s\n", "Rank", "Time (us)", "Source", "Cache", "Kind",
+                 "Function", "Pipeline", "Shaders");
+        out << line;
+        for (size_t i = 0; i < slowest.size(); ++i) {
+            const Pipeline &pipeline = slowest[i];
+            std::string shader_list;
+            for (const Stage &stage : pipeline.stages) {
+                shader_list += ' ';
+                shader_list += stageName(stage.stage);
+                shader_list += ':';
+                shader_list += hashText(stage.shader_hash);
+            }
+            char handle[32];
+            snprintf(handle, sizeof(handle), "0x%" PRIx64, pipeline.handle);
+            snprintf(line, sizeof(line), "%5zu %12.1f %-8s %-7s %-8s %-30s %-18s", i + 1, pipeline.duration_ns / 1e3,
+                     sourceName(pipeline.source), cacheHitName(pipeline), kindName(pipeline.kind), pipeline.function, handle);
+            out << line << shader_list;
+            if (!pipeline.name.empty()) {
+                out << " [" << pipeline.name << "]";
+            }
+            out << "\n";
+        }
+
+        out << "\nShaders by pipeline creation time:\n";
+        snprintf(line, sizeof(line), "%-16s %-16s %10s %12s\n", "Shader", "Stages", "Pipelines", "Time (us)");
+        out << line;
+        for (const auto &shader : shaders) {
+            snprintf(line, sizeof(line), "%-16s %-16s %10" PRIu64 " %12.1f\n", hashText(shader.first).c_str(),
+                     stageNames(shader.second.stages).c_str(), shader.second.pipelines, shader.second.duration_ns / 1e3);
+            out << line;
+        }
+    }
+
+    void writeJson(std::ostream &out, const std::vector<Pipeline> &slowest,
+                   const std::vector<std::pair<uint64_t, ShaderTotals>> &shaders) const {
+        out << "{\n";
+        out << "  \"calls\" : \"" << totals.calls << "\",\n";
+        out << "  \"callTimeNs\" : \"" << totals.call_ns << "\",\n";
+        out << "  \"pipelines\" : \"" << totals.pipelines << "\",\n";
+        out << "  \"libraries\" : \"" << totals.libraries << "\",\n";
+        out << "  \"linked\" : \"" << totals.linked << "\",\n";
+        out << "  \"notCreated\" : \"" << totals.not_created << "\",\n";
+        out << "  \"deferredCalls\" : \"" << totals.deferred_calls << "\",\n";
+        out << "  \"feedback\" : \"" << totals.feedback << "\",\n";
+        out << "  \"cacheHits\" : \"" << totals.cache_hits << "\",\n";
+        out << "  \"slowest\" :\n  [";
+        for (size_t i = 0; i < slowest.size(); ++i) {
+            const Pipeline &pipeline = slowest[i];
+            out << (i > 0 ? ",\n" : "\n") << "    {\n";
+            out << "      \"rank\" : \"" << i + 1 << "\",\n";
+            out << "      \"sequence\" : \"" << pipeline.sequence << "\",\n";
+            out << "      \"function\" : \"" << pipeline.function << "\",\n";
+            out << "      \"pipeline\" : \"0x" << std::hex << pipeline.handle << std::dec << "\",\n";
+            if (!pipeline.name.empty()) {
+                out << "      \"name\" : " << jsonString(pipeline.name) << ",\n";
+            }
+            out << "      \"kind\" : \"" << kindName(pipeline.kind) << "\",\n";
+            out << "      \"timeNs\" : \"" << pipeline.duration_ns << "\",\n";
+            out << "      \"source\" : \"" << sourceName(pipeline.source) << "\",\n";
+            out << "      \"cache\" : \"" << cacheHitName(pipeline) << "\",\n";
+            out << "      \"stages\" :\n      [";
+            for (size_t s = 0; s < pipeline.stages.size(); ++s) {
+                const Stage &stage = pipeline.stages[s];
+                out << (s > 0 ? ",\n" : "\n") << "        { \"stage\" : \"" << stageName(stage.stage) << "\", \"shader\" : \""
+                    << hashText(stage.shader_hash) << "\", \"timeNs\" : \"" << stage.duration_ns << "\" }";
+            }
+            out << (pipeline.stages.empty() ? "]\n" : "\n      ]\n") << "    }";
+        }
+        out << (slowest.empty() ? "],\n" : "\n  ],\n");
+        out << "  \"shaders\" :\n  [";
+        for (size_t i = 0; i < shaders.size(); ++i) {
+            out << (i > 0 ? ",\n" : "\n") << "    { \"shader\" : \"" << hashText(shaders[i].first) << "\", \"stages\" : \""
+                << stageNames(shaders[i].second.stages) << "\", \"pipelines\" : \"" << shaders[i].second.pipelines
+                << "\", \"timeNs\" : \"" << shaders[i].second.duration_ns << "\" }";
+        }
+        out << (shaders.empty() ? "]\n" : "\n  ]\n") << "}\n";
+    }
+
+    bool is_enabled = false;
+    std::mutex mutex;
+    std::string report_path;
+    uint32_t max_ranked = 0;
+    Totals totals;
+    std::vector<Pipeline> ranked;
+    std::unordered_map<uint64_t, ShaderTotals> shader_totals;
+    std::unordered_map<VkInstance, uint32_t> instance_versions;
+    std::unordered_map<VkDevice, bool> feedback_devices;  // Whether the device can take a feedback the layer chains
+    std::unordered_map<VkShaderModule, uint64_t> shader_hashes;
+    std::unordered_map<VkPipeline, std::vector<Stage>> library_stages;
+};
+
+// Profiles one call creating pipelines, for the generated vkCreate*Pipelines functions. When the application didn't chain a
+// VkPipelineCreationFeedbackCreateInfo to a create info, and the device can take one, the call is made with copies of the
+// create infos that have one of the layer's at the front of their chain. The application's own structures aren't modified.
+template <typename CreateInfo>
+class ApiDumpPipelineCreation {
+   public:
+    ApiDumpPipelineCreation(ApiDumpPipelineProfile &profile, const char *function, VkDevice device, uint32_t create_info_count,
+                            const CreateInfo *create_infos, bool deferred = false)
+        : profile(profile),
+          function(function),
+          create_info_count(create_info_count),
+          create_infos(create_infos),
+          active(profile.enabled() && create_infos != nullptr && !deferred) {
+        if (profile.enabled() && deferred) {
+            // The create infos must outlive the deferred operation, so no feedback is chained either
+            profile.recordDeferred();
+        }
+        if (!active) {
+            return;
+        }
+        feedback_infos.resize(create_info_count, nullptr);
+        uint32_t missing_stage_count = 0;
+        bool missing = false;
+        for (uint32_t i = 0; i < create_info_count; ++i) {
+            feedback_infos[i] = ApiDumpPipelineProfile::findInChain<VkPipelineCreationFeedbackCreateInfo>(
+                create_infos[i].pNext, VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO);
+            if (feedback_infos[i] == nullptr) {
+                missing = true;
+                missing_stage_count += feedbackStageCount(create_infos[i]);
+            }
+        }
+        if (missing && profile.canChainFeedback(device)) {
+            chainFeedback(missing_stage_count);
+        }
+        start = std::chrono::steady_clock::now();
+    }
+    ApiDumpPipelineCreation(const ApiDumpPipelineCreation &) = delete;
+    ApiDumpPipelineCreation &operator=(const ApiDumpPipelineCreation &) = delete;
+
+    // The create infos to call the next layer with.
+    const CreateInfo *createInfos() const { return chained_create_infos.empty() ? create_infos : chained_create_infos.data(); }
+
+    // Called once the call down the chain returned.
+    // Create infos that failed have a null handle in pipelines, whatever the result.
+    void end(const VkPipeline *pipelines) {
+        if (!active) {
+            return;
+        }
+        const uint64_t call_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        std::vector<ApiDumpPipelineProfile::Pipeline> created;
+        uint32_t not_created = 0;
+        for (uint32_t i = 0; i < create_info_count; ++i) {
+            const VkPipeline handle = pipelines != nullptr ? pipelines[i] : VK_NULL_HANDLE;
+            if (handle == VK_NULL_HANDLE) {
+                ++not_created;
+                continue;
+            }
+            const CreateInfo &create_info = create_infos[i];
+            ApiDumpPipelineProfile::Pipeline pipeline;
+            pipeline.function = function;
+            pipeline.handle = (uint64_t)handle;
+            const VkPipelineLibraryCreateInfoKHR *library_info = libraryInfo(create_info);
+            if (isLibrary(create_info)) {
+                pipeline.kind = ApiDumpPipelineProfile::Kind::Library;
+            } else if (library_info != nullptr && library_info->libraryCount > 0) {
+                pipeline.kind = ApiDumpPipelineProfile::Kind::Linked;
+            }
+
+            const VkPipelineCreationFeedbackCreateInfo *feedback_info = feedback_infos[i];
+            const VkPipelineCreationFeedback *feedback = feedback_info != nullptr ? feedback_info->pPipelineCreationFeedback : nullptr;
+            if (feedback != nullptr && (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)) {
+                pipeline.duration_ns = feedback->duration;
+                pipeline.source = ApiDumpPipelineProfile::DurationSource::Feedback;
+                pipeline.feedback_flags = feedback->flags;
+            } else if (create_info_count == 1) {
+                pipeline.duration_ns = call_ns;
+            } else {
+                pipeline.duration_ns = call_ns / create_info_count;
+                pipeline.source = ApiDumpPipelineProfile::DurationSource::Batch;
+            }
+
+            const uint32_t stage_count = stageCount(create_info);
+            const VkPipelineShaderStageCreateInfo *stage_infos = stages(create_info);
+            const bool stage_feedback = feedback_info != nullptr && feedback_info->pipelineStageCreationFeedbackCount == stage_count &&
+                                        feedback_info->pPipelineStageCreationFeedbacks != nullptr;
+            for (uint32_t s = 0; s < stage_count; ++s) {
+                const VkPipelineCreationFeedback *stage_feedback_entry =
+                    stage_feedback ? &feedback_info->pPipelineStageCreationFeedbacks[s] : nullptr;
+                const uint64_t stage_ns =
+                    stage_feedback_entry != nullptr && (stage_feedback_entry->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)
+                        ? stage_feedback_entry->duration
+                        : 0;
+                pipeline.stages.push_back({stage_infos[s].stage, profile.shaderHash(stage_infos[s]), stage_ns});
+            }
+            if (pipeline.kind == ApiDumpPipelineProfile::Kind::Linked) {
+                for (const ApiDumpPipelineProfile::Stage &stage : profile.libraryStages(*library_info)) {
+                    pipeline.stages.push_back(stage);
+                }
+            }
+            created.push_back(std::move(pipeline));
+        }
+        profile.record(call_ns, std::move(created), not_created);
+    }
+
+   private:
+    // A copy of the create infos, with a feedback of the layer's in front of the chain of those that have none.
+    void chainFeedback(uint32_t missing_stage_count) {
+        chained_create_infos.assign(create_infos, create_infos + create_info_count);
+        layer_feedback_infos.resize(create_info_count);
+        layer_feedbacks.resize(create_info_count);
+        layer_stage_feedbacks.resize(missing_stage_count);
+        uint32_t stage_offset = 0;
+        for (uint32_t i = 0; i < create_info_count; ++i) {
+            if (feedback_infos[i] != nullptr) {
+                continue;
+            }
+            const uint32_t stage_count = feedbackStageCount(create_infos[i]);
+            VkPipelineCreationFeedbackCreateInfo &feedback_info = layer_feedback_infos[i];
+            feedback_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+            feedback_info.pNext = create_infos[i].pNext;
+            feedback_info.pPipelineCreationFeedback = &layer_feedbacks[i];
+            feedback_info.pipelineStageCreationFeedbackCount = stage_count;
+            feedback_info.pPipelineStageCreationFeedbacks = stage_count > 0 ? &layer_stage_feedbacks[stage_offset] : nullptr;
+            stage_offset += stage_count;
+            chained_create_infos[i].pNext = &feedback_info;
+            feedback_infos[i] = &feedback_info;
+        }
+    }
+
+    static uint32_t stageCount(const VkGraphicsPipelineCreateInfo &create_info) { return create_info.stageCount; }
+    static uint32_t stageCount(const VkComputePipelineCreateInfo &) { return 1; }
+    static uint32_t stageCount(const VkRayTracingPipelineCreateInfoKHR &create_info) { return create_info.stageCount; }
+
+    // The number of stage feedbacks the layer chains, which must be 0 for ray tracing pipeline libraries
+    // (VUID-VkRayTracingPipelineCreateInfoKHR-pipelineStageCreationFeedbackCount-06652).
+    static uint32_t feedbackStageCount(const CreateInfo &create_info) {
+        if (std::is_same_v<CreateInfo, VkRayTracingPipelineCreateInfoKHR> && isLibrary(create_info)) {
+            return 0;
+        }
+        return stageCount(create_info);
+    }
+
+    static const VkPipelineShaderStageCreateInfo *stages(const VkGraphicsPipelineCreateInfo &create_info) {
+        return create_info.pStages;
+    }
+    static const VkPipelineShaderStageCreateInfo *stages(const VkComputePipelineCreateInfo &create_info) {
+        return &create_info.stage;
+    }
+    static const VkPipelineShaderStageCreateInfo *stages(const VkRayTracingPipelineCreateInfoKHR &create_info) {
+        return create_info.pStages;
+    }
+
+    static const VkPipelineLibraryCreateInfoKHR *libraryInfo(const VkGraphicsPipelineCreateInfo &create_info) {
+        return ApiDumpPipelineProfile::findInChain<VkPipelineLibraryCreateInfoKHR>(create_info.pNext,
+                                                                                    VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR);
+    }
+    static const VkPipelineLibraryCreateInfoKHR *libraryInfo(const VkComputePipelineCreateInfo &) { return nullptr; }
+    static const VkPipelineLibraryCreateInfoKHR *libraryInfo(const VkRayTracingPipelineCreateInfoKHR &create_info) {
+        return create_info.pLibraryInfo;
+    }
+
+    // VkPipelineCreateFlags2CreateInfoKHR replaces the flags of the create info when it is chained.
+    static bool isLibrary(const CreateInfo &create_info) {
+        const auto *flags2 = ApiDumpPipelineProfile::findInChain<VkPipelineCreateFlags2CreateInfoKHR>(
+            create_info.pNext, VK_STRUCTURE_TYPE_PIPELINE_CREATE_FLAGS_2_CREATE_INFO_KHR);
+        if (flags2 != nullptr) {
+            return (flags2->flags & VK_PIPELINE_CREATE_2_LIBRARY_BIT_KHR) != 0;
+        }
+        return (create_info.flags & VK_PIPELINE_CREATE_LIBRARY_BIT_KHR) != 0;
+    }
+
+    ApiDumpPipelineProfile &profile;
+    const char *const function;
+    const uint32_t create_info_count;
+    const CreateInfo *const create_infos;
+    const bool active;
+    std::chrono::steady_clock::time_point start;
+    // The feedback of each create info, the application's or the layer's, null if there is none
+    std::vector<const VkPipelineCreationFeedbackCreateInfo *> feedback_infos;
+    std::vector<CreateInfo> chained_create_infos;
+    std::vector<VkPipelineCreationFeedbackCreateInfo> layer_feedback_infos;
+    std::vector<VkPipelineCreationFeedback> layer_feedbacks;
+    std::vector<VkPipelineCreationFeedback> layer_stage_feedbacks;
+};
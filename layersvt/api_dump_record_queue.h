@@ -0,0 +1,96 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free queue with any number of producers and a single consumer, based on Dmitry Vyukov's bounded MPMC queue.
+// Each cell carries a sequence number that tells producers when it is free and the consumer when it is filled. Items come out
+// in the order producers claimed their cells.
+template <typename T>
+class RecordQueue {
+   public:
+    // The capacity is rounded up to a power of two.
+    explicit RecordQueue(size_t requested_capacity) {
+        size_t capacity = 2;
+        while (capacity < requested_capacity) {
+            capacity <<= 1;
+        }
+        cells = std::make_unique<Cell[]>(capacity);
+        mask = capacity - 1;
+        for (size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueue_pos.store(0, std::memory_order_relaxed);
+    }
+    RecordQueue(const RecordQueue &) = delete;
+    RecordQueue &operator=(const RecordQueue &) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Returns false without touching value if the queue is full. Safe to call from any thread.
+    bool tryPush(T &&value) {
+        Cell *cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the next item in order hasn't been published yet. Must only be called from the consumer thread.
+    bool tryPop(T &value) {
+        Cell &cell = cells[dequeue_pos & mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeue_pos + 1) < 0) {
+            return false;
+        }
+        value = std::move(cell.value);
+        cell.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+        ++dequeue_pos;
+        return true;
+    }
+
+   private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    // Producers and the consumer work on opposite ends, keep their positions on separate cache lines.
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) size_t dequeue_pos = 0;
+};
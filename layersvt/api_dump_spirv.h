@@ -0,0 +1,195 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "api_dump_format_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+
+// XXH64 of data with a seed of 0, as written by xxhsum -H1, so that the saved shaders can be checked against their name.
+inline uint64_t HashXXH64(const void *data, size_t size) {
+    static const uint64_t kPrime1 = 0x9e3779b185ebca87ull;
+    static const uint64_t kPrime2 = 0xc2b2ae3d27d4eb4full;
+    static const uint64_t kPrime3 = 0x165667b19e3779f9ull;
+    static const uint64_t kPrime4 = 0x85ebca77c2b2ae63ull;
+    static const uint64_t kPrime5 = 0x27d4eb2f165667c5ull;
+    const auto rotate = [](uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); };
+    // The hash is defined with little endian loads
+    const auto load64 = [](const uint8_t *bytes) {
+        uint64_t value;
+        memcpy(&value, bytes, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = __builtin_bswap64(value);
+#endif
+        return value;
+    };
+    const auto load32 = [](const uint8_t *bytes) {
+        uint32_t value;
+        memcpy(&value, bytes, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = __builtin_bswap32(value);
+#endif
+        return static_cast<uint64_t>(value);
+    };
+    const auto round = [&](uint64_t accumulator, uint64_t input) {
+        return rotate(accumulator + input * kPrime2, 31) * kPrime1;
+    };
+    const auto merge = [&](uint64_t hash, uint64_t accumulator) { return (hash ^ round(0, accumulator)) * kPrime1 + kPrime4; };
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    const uint8_t *const end = bytes + size;
+    uint64_t hash = 0;
+    if (size >= 32) {
+        uint64_t accumulators[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+        for (; end - bytes >= 32; bytes += 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                accumulators[lane] = round(accumulators[lane], load64(bytes + lane * 8));
+            }
+        }
+        hash = rotate(accumulators[0], 1) + rotate(accumulators[1], 7) + rotate(accumulators[2], 12) + rotate(accumulators[3], 18);
+        for (int lane = 0; lane < 4; ++lane) {
+            hash = merge(hash, accumulators[lane]);
+        }
+    } else {
+        hash = kPrime5;
+    }
+    hash += size;
+    for (; end - bytes >= 8; bytes += 8) {
+        hash = rotate(hash ^ round(0, load64(bytes)), 27) * kPrime1 + kPrime4;
+    }
+    if (end - bytes >= 4) {
+        hash = rotate(hash ^ (load32(bytes) * kPrime1), 23) * kPrime2 + kPrime3;
+        bytes += 4;
+    }
+    for (; bytes < end; ++bytes) {
+        hash = rotate(hash ^ (*bytes * kPrime5), 11) * kPrime1;
+    }
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// The two lowercase hexadecimal digits of each byte value.
+struct HexDigitPairs {
+    constexpr HexDigitPairs() : digits() {
+        const char kDigits[] = "0123456789abcdef";
+        for (int i = 0; i < 256; ++i) {
+            digits[2 * i] = kDigits[i >> 4];
+            digits[2 * i + 1] = kDigits[i & 15];
+        }
+    }
+    char digits[512];
+};
+inline constexpr HexDigitPairs kHexDigitPairs{};
+
+// Writes the dwords of a SPIR-V module as 0x followed by 8 hexadecimal digits, separated by ", ", and in quotes if quoted is set.
+// A module is often hundreds of kilobytes, so the digits are looked up a byte at a time in a table and written to a local buffer
+// that is appended to out once it is full.
+inline void WriteSpirvHex(FormatBuffer &out, const uint32_t *code, size_t dword_count, bool quoted) {
+    static const size_t kChunkDwords = 256;
+    static const size_t kMaxDwordSize = 14;  // , "0x00000000"
+    char chunk[kChunkDwords * kMaxDwordSize];
+    for (size_t chunk_start = 0; chunk_start < dword_count; chunk_start += kChunkDwords) {
+        const size_t chunk_end = std::min(dword_count, chunk_start + kChunkDwords);
+        char *written = chunk;
+        for (size_t i = chunk_start; i < chunk_end; ++i) {
+            if (i != 0) {
+                *written++ = ',';
+                *written++ = ' ';
+            }
+            if (quoted) {
+                *written++ = '"';
+            }
+            *written++ = '0';
+            *written++ = 'x';
+            const uint32_t dword = code[i];
+            memcpy(written, &kHexDigitPairs.digits[2 * (dword >> 24)], 2);
+            memcpy(written + 2, &kHexDigitPairs.digits[2 * ((dword >> 16) & 0xff)], 2);
+            memcpy(written + 4, &kHexDigitPairs.digits[2 * ((dword >> 8) & 0xff)], 2);
+            memcpy(written + 6, &kHexDigitPairs.digits[2 * (dword & 0xff)], 2);
+            written += 8;
+            if (quoted) {
+                *written++ = '"';
+            }
+        }
+        out.write(chunk, static_cast<size_t>(written - chunk));
+    }
+}
+
+// Saves each distinct SPIR-V module once, to shaders/<hash>.spv next to the output file, so that the output only needs to name
+// the file. Modules saved by an earlier run into the same directory aren't written again.
+class ApiDumpShaderStore {
+   public:
+    static constexpr const char *kDirectoryName = "shaders";
+
+    // directory is where the output file is written, or empty for the current directory.
+    void setDirectory(const std::string &directory) {
+        std::lock_guard<std::mutex> lg(mutex);
+        shader_directory = std::filesystem::path(directory) / kDirectoryName;
+    }
+
+    // Returns the name of the file holding code, relative to the directory of the output file. The name is returned even if the
+    // file couldn't be written, since it still identifies the module.
+    std::string save(const uint32_t *code, size_t size) {
+        const uint64_t hash = HashXXH64(code, size);
+        char hash_digits[17];
+        for (int i = 0; i < 8; ++i) {
+            memcpy(&hash_digits[2 * i], &kHexDigitPairs.digits[2 * ((hash >> (56 - 8 * i)) & 0xff)], 2);
+        }
+        hash_digits[16] = '\0';
+        const std::string file_name = std::string(hash_digits) + ".spv";
+
+        std::lock_guard<std::mutex> lg(mutex);
+        if (saved_hashes.insert(hash).second) {
+            write(shader_directory / file_name, code, size);
+        }
+        return std::string(kDirectoryName) + "/" + file_name;
+    }
+
+   private:
+    void write(const std::filesystem::path &path, const uint32_t *code, size_t size) {
+        std::error_code error;
+        if (std::filesystem::file_size(path, error) == size && !error) {
+            return;
+        }
+        std::filesystem::create_directories(shader_directory, error);
+        std::ofstream file(path, std::ofstream::binary | std::ofstream::trunc);
+        file.write(reinterpret_cast<const char *>(code), static_cast<std::streamsize>(size));
+        if (!file && !write_failed) {
+            std::cerr << "api_dump: could not save shaders to " << shader_directory.string() << std::endl;
+            write_failed = true;
+        }
+    }
+
+    std::mutex mutex;
+    std::filesystem::path shader_directory = kDirectoryName;
+    std::unordered_set<uint64_t> saved_hashes;
+    bool write_failed = false;  // Reported once
+};
@@ -0,0 +1,232 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Latency histogram with a bounded relative error, in the style of HdrHistogram. Values below kSubBucketCount have a bucket
+// each, and every power of two above is split into kSubBucketCount buckets, so a bucket is at most 1/8 of the values it holds
+// wide. Values that don't fit are counted in the last bucket.
+struct LatencyHistogram {
+    static const uint32_t kSubBucketBits = 3;
+    static const uint32_t kSubBucketCount = 1 << kSubBucketBits;
+    static const uint32_t kMaxValueBits = 32;
+    static const uint32_t kBucketCount = kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketCount;
+
+    static uint32_t bucketIndex(uint64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<uint32_t>(value);
+        }
+        uint32_t msb = 0;
+        while ((value >> (msb + 1)) != 0) {
+            ++msb;
+        }
+        const uint32_t shift = msb - kSubBucketBits;
+        const uint32_t index =
+            kSubBucketCount + shift * kSubBucketCount + static_cast<uint32_t>((value >> shift) & (kSubBucketCount - 1));
+        return index < kBucketCount ? index : kBucketCount - 1;
+    }
+
+    // Smallest and largest value counted in the bucket.
+    static uint64_t bucketLowest(uint32_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        const uint32_t shift = (index - kSubBucketCount) / kSubBucketCount;
+        const uint64_t mantissa = kSubBucketCount + (index - kSubBucketCount) % kSubBucketCount;
+        return mantissa << shift;
+    }
+    static uint64_t bucketHighest(uint32_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        const uint32_t shift = (index - kSubBucketCount) / kSubBucketCount;
+        return bucketLowest(index) + (uint64_t(1) << shift) - 1;
+    }
+};
+
+// Summary of the calls of one function over the frames of a statistics period. Latencies are in nanoseconds, and except for
+// the total, they are the highest value of the histogram bucket they fall in.
+struct ApiDumpFunctionStatistics {
+    uint32_t function;  // ApiDumpFunctionId
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+};
+
+// A latency in nanoseconds written as microseconds, to the nanosecond, for the summaries.
+struct ApiDumpMicroseconds {
+    explicit ApiDumpMicroseconds(uint64_t ns) { snprintf(text, sizeof(text), "%" PRIu64 ".%03" PRIu64, ns / 1000, ns % 1000); }
+    char text[32];
+};
+
+// Call counts and latency histograms of every function, for the statistics output mode. Each thread counts its calls in its
+// own counters, which only that thread writes, so that recording a call takes no lock and no atomic read-modify-write. The
+// counters are never reset: summarize() reads every thread's counters and reports the difference with the last summary.
+class ApiDumpStatistics {
+    // The number of calls is the sum of the buckets.
+    struct FunctionCounters {
+        std::atomic<uint64_t> total_ns = 0;
+        std::atomic<uint64_t> buckets[LatencyHistogram::kBucketCount] = {};
+    };
+
+    // Counters of one thread. Functions get their counters on their first call, so threads only pay for what they call.
+    struct ThreadCounters {
+        explicit ThreadCounters(uint32_t function_count)
+            : functions(std::make_unique<std::atomic<FunctionCounters *>[]>(function_count)) {}
+        ThreadCounters(const ThreadCounters &) = delete;
+        ThreadCounters &operator=(const ThreadCounters &) = delete;
+        ~ThreadCounters() {
+            for (FunctionCounters *counters : owned) {
+                delete counters;
+            }
+        }
+
+        std::unique_ptr<std::atomic<FunctionCounters *>[]> functions;
+        std::vector<FunctionCounters *> owned;
+    };
+
+    // Totals at the last summary, to report each period on its own.
+    struct FunctionTotals {
+        uint64_t total_ns = 0;
+        uint64_t buckets[LatencyHistogram::kBucketCount] = {};
+    };
+
+   public:
+    // Must be called before any call is recorded.
+    void init(uint32_t count) {
+        std::lock_guard<std::mutex> lg(threads_mutex);
+        if (function_count != 0) {
+            return;
+        }
+        function_count = count;
+        last_totals.resize(count);
+    }
+
+    // Counts a call of the function that took latency_ns in the calling thread's counters. The 32 value bits of the histogram
+    // hold latencies of up to 4 seconds, longer ones are counted in its last bucket.
+    void record(uint32_t function, uint64_t latency_ns) {
+        ThreadCounters *&thread = threadCounters();
+        if (thread == nullptr) {
+            thread = registerThread();
+        }
+        FunctionCounters *counters = thread->functions[function].load(std::memory_order_relaxed);
+        if (counters == nullptr) {
+            counters = new FunctionCounters();
+            {
+                std::lock_guard<std::mutex> lg(threads_mutex);
+                thread->owned.push_back(counters);
+            }
+            thread->functions[function].store(counters, std::memory_order_release);
+        }
+        increment(counters->total_ns, latency_ns);
+        increment(counters->buckets[LatencyHistogram::bucketIndex(latency_ns)], 1);
+    }
+
+    // Summarizes the calls recorded since the last summary, for the functions that were called.
+    std::vector<ApiDumpFunctionStatistics> summarize() {
+        std::vector<ApiDumpFunctionStatistics> summary;
+        std::lock_guard<std::mutex> lg(threads_mutex);
+        FunctionTotals totals;
+        for (uint32_t function = 0; function < function_count; ++function) {
+            bool called = false;
+            totals = FunctionTotals();
+            for (const auto &thread : threads) {
+                const FunctionCounters *counters = thread->functions[function].load(std::memory_order_acquire);
+                if (counters == nullptr) {
+                    continue;
+                }
+                called = true;
+                totals.total_ns += counters->total_ns.load(std::memory_order_relaxed);
+                for (uint32_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+                    totals.buckets[i] += counters->buckets[i].load(std::memory_order_relaxed);
+                }
+            }
+            if (!called) {
+                continue;
+            }
+
+            FunctionTotals &last = last_totals[function];
+            uint64_t period_buckets[LatencyHistogram::kBucketCount];
+            uint64_t calls = 0;
+            for (uint32_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+                period_buckets[i] = totals.buckets[i] - last.buckets[i];
+                calls += period_buckets[i];
+            }
+            const uint64_t total_ns = totals.total_ns - last.total_ns;
+            last = totals;
+            if (calls == 0) {
+                continue;
+            }
+
+            ApiDumpFunctionStatistics stats{function, calls, total_ns, 0, 0, 0, 0};
+            const uint64_t p50_rank = (calls * 50 + 99) / 100;
+            const uint64_t p99_rank = (calls * 99 + 99) / 100;
+            uint64_t seen = 0;
+            bool found_min = false;
+            for (uint32_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+                if (period_buckets[i] == 0) {
+                    continue;
+                }
+                if (!found_min) {
+                    stats.min_ns = LatencyHistogram::bucketHighest(i);
+                    found_min = true;
+                }
+                const uint64_t before = seen;
+                seen += period_buckets[i];
+                if (before < p50_rank && seen >= p50_rank) stats.p50_ns = LatencyHistogram::bucketHighest(i);
+                if (before < p99_rank && seen >= p99_rank) stats.p99_ns = LatencyHistogram::bucketHighest(i);
+                stats.max_ns = LatencyHistogram::bucketHighest(i);
+            }
+            summary.push_back(stats);
+        }
+        return summary;
+    }
+
+   private:
+    // Only the owning thread writes its counters, readers may see the old or the new value.
+    static void increment(std::atomic<uint64_t> &counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static ThreadCounters *&threadCounters() {
+        thread_local ThreadCounters *counters = nullptr;
+        return counters;
+    }
+
+    ThreadCounters *registerThread() {
+        std::lock_guard<std::mutex> lg(threads_mutex);
+        threads.push_back(std::make_unique<ThreadCounters>(function_count));
+        return threads.back().get();
+    }
+
+    std::mutex threads_mutex;
+    uint32_t function_count = 0;
+    // Counters outlive their threads, the calls of threads that exited still count.
+    std::vector<std::unique_ptr<ThreadCounters>> threads;
+    std::vector<FunctionTotals> last_totals;
+};
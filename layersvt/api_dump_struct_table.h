@@ -0,0 +1,310 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "api_dump.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+// The generator describes the members of most structures and unions with a table instead of writing a dump function for each of
+// them, so that the layer has one copy of the code walking the members per output format, rather than one per structure. The
+// tables don't depend on the format. The functions dumping the value of each member type do, and the tables refer to them by
+// their index in api_dump_value_functions<Format, Features>(). Structures with bit fields, which have no offset, keep a dump
+// function of their own.
+
+// Dumps the value object points to, the way the dump function of its type does. address is the one shown for the value, for the
+// elements of arrays and the values behind pointers.
+using ApiDumpValueFunction = void (*)(const void *object, const ApiDumpSettings &settings, const char *type_string,
+                                      const char *name, int indents, const void *address);
+
+// Generated, after the dump functions of every type.
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+const ApiDumpValueFunction *api_dump_value_functions();
+
+enum class ApiDumpMemberKind : uint8_t {
+    value,                 // The member itself
+    pNext,                 // A pNext chain, of which the text format shows the structures after the other members
+    pointer,               // A pointer to a single value, or NULL
+    pointer_array,         // A pointer to count values
+    double_pointer_array,  // A pointer to count pointers to values
+    fixed_array,           // An array member, of which the first count values are shown
+    double_fixed_array,    // A two dimensional array member, of count rows of columns values
+    spirv,                 // A pointer to count words of SPIR-V
+};
+
+// Where the number of elements of an array comes from.
+enum class ApiDumpCountSource : uint8_t {
+    constant,  // count
+    member,    // The unsigned integer member of count_size bytes at count_offset
+    hook,      // count_hook(object), for counts computed from several members or from the state of the call
+};
+
+struct ApiDumpMember {
+    const char *name;
+    const char *type_string;
+    const char *element_type_string;  // The type of the elements of arrays, and the name given to the structures of pNext chains
+    uint32_t offset;
+    ApiDumpMemberKind kind;
+    uint16_t value_function;  // Dumps the member, or its elements
+    uint32_t element_size = 0;
+    uint32_t columns = 0;
+    ApiDumpCountSource count_source = ApiDumpCountSource::constant;
+    uint32_t count_offset = 0;
+    uint32_t count_size = 0;
+    uint64_t count = 0;
+    uint64_t (*count_hook)(const void *object) = nullptr;
+    // Members only shown when is_valid(object) returns true, like the ones depending on a descriptor type. Structures show the
+    // other ones as UNUSED, unions leave them out.
+    bool (*is_valid)(const void *object) = nullptr;
+
+    constexpr ApiDumpMember withCount(uint64_t constant) const {
+        ApiDumpMember member = *this;
+        member.count_source = ApiDumpCountSource::constant;
+        member.count = constant;
+        return member;
+    }
+    constexpr ApiDumpMember withCountMember(uint32_t member_offset, uint32_t member_size) const {
+        ApiDumpMember member = *this;
+        member.count_source = ApiDumpCountSource::member;
+        member.count_offset = member_offset;
+        member.count_size = member_size;
+        return member;
+    }
+    constexpr ApiDumpMember withCountHook(uint64_t (*hook)(const void *object)) const {
+        ApiDumpMember member = *this;
+        member.count_source = ApiDumpCountSource::hook;
+        member.count_hook = hook;
+        return member;
+    }
+    constexpr ApiDumpMember withColumns(uint32_t column_count) const {
+        ApiDumpMember member = *this;
+        member.columns = column_count;
+        return member;
+    }
+    constexpr ApiDumpMember validIf(bool (*hook)(const void *object)) const {
+        ApiDumpMember member = *this;
+        member.is_valid = hook;
+        return member;
+    }
+};
+
+struct ApiDumpStructInfo {
+    const ApiDumpMember *members;
+    uint32_t member_count;
+    OutputConstruct construct;  // api_struct or api_union
+    // Stashes the state that the following members, or the structures they point to, depend on, like the descriptor type.
+    void (*set_state)(const void *object);
+};
+
+inline const void *api_dump_load_pointer(const uint8_t *member) {
+    const void *pointer = nullptr;
+    memcpy(&pointer, member, sizeof(pointer));
+    return pointer;
+}
+
+inline uint64_t api_dump_member_count(const ApiDumpMember &member, const void *object) {
+    if (member.count_source == ApiDumpCountSource::hook) {
+        return member.count_hook(object);
+    } else if (member.count_source == ApiDumpCountSource::constant) {
+        return member.count;
+    }
+    const uint8_t *count = static_cast<const uint8_t *>(object) + member.count_offset;
+    switch (member.count_size) {
+        case sizeof(uint8_t):
+            return *count;
+        case sizeof(uint16_t): {
+            uint16_t value;
+            memcpy(&value, count, sizeof(value));
+            return value;
+        }
+        case sizeof(uint32_t): {
+            uint32_t value;
+            memcpy(&value, count, sizeof(value));
+            return value;
+        }
+        default: {
+            uint64_t value;
+            memcpy(&value, count, sizeof(value));
+            return value;
+        }
+    }
+}
+
+// The arrays of pointer_array, double_pointer_array and fixed_array members, like dump_pointer_array(),
+// dump_double_pointer_array() and dump_single_array().
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+void dump_member_array(const ApiDumpMember &member, const uint8_t *array, size_t len, ApiDumpValueFunction dump_element,
+                       const ApiDumpSettings &settings, int indents) {
+    if (member.kind == ApiDumpMemberKind::fixed_array) {
+        if (len == 0) {
+            return;
+        }
+    } else if (array == nullptr || len == 0) {
+        dump_nullptr<Format, Features>(settings, member.type_string, member.name, indents);
+        return;
+    }
+    dump_array_start<Format, Features>(array, len, settings, member.type_string, member.name, indents);
+    const int element_indents = indents + (Format == ApiDumpFormat::Json ? 2 : 1);
+    std::string index_name;
+    for (size_t i = 0; i < len; ++i) {
+        set_element_name<Format>(index_name, member.name, i);
+        if (member.kind == ApiDumpMemberKind::double_pointer_array) {
+            const void *element = api_dump_load_pointer(array + i * sizeof(void *));
+            if (element == nullptr) {
+                dump_nullptr<Format, Features>(settings, member.element_type_string, index_name.c_str(), element_indents);
+            } else {
+                dump_element(element, settings, member.element_type_string, index_name.c_str(), element_indents, element);
+            }
+        } else {
+            const uint8_t *element = array + i * member.element_size;
+            dump_element(element, settings, member.element_type_string, index_name.c_str(), element_indents,
+                         member.kind == ApiDumpMemberKind::fixed_array ? nullptr : element);
+        }
+        if constexpr (Format == ApiDumpFormat::Json) {
+            if (i < len - 1) settings.stream() << ',';
+            dump_json_newline(settings);
+        }
+    }
+    dump_array_end<Format>(array, len, settings, indents);
+}
+
+// The arrays of double_fixed_array members, like dump_double_array().
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+void dump_member_double_array(const ApiDumpMember &member, const uint8_t *array, size_t len1, size_t len2,
+                              ApiDumpValueFunction dump_element, const ApiDumpSettings &settings, int indents) {
+    if (len1 == 0 || len2 == 0) {
+        return;
+    }
+    dump_array_start<Format, Features>(array, len1 * len2, settings, member.type_string, member.name, indents);
+    const int element_indents = indents + (Format == ApiDumpFormat::Json ? 2 : 1);
+    std::string row_name;
+    std::string index_name;
+    for (size_t i = 0; i < len1; ++i) {
+        set_element_name<Format>(row_name, member.name, i);
+        for (size_t j = 0; j < len2; ++j) {
+            set_element_name<ApiDumpFormat::Text>(index_name, row_name.c_str(), j);
+            dump_element(array + (i * member.columns + j) * member.element_size, settings, member.element_type_string,
+                         index_name.c_str(), element_indents, nullptr);
+            if constexpr (Format == ApiDumpFormat::Json) {
+                if (i < len1 - 1 || j < len2 - 1) settings.stream() << ',';
+                dump_json_newline(settings);
+            }
+        }
+    }
+    dump_array_end<Format>(array, len1 * len2, settings, indents);
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+void dump_member(const ApiDumpMember &member, const void *object, const ApiDumpValueFunction *value_functions,
+                 const ApiDumpSettings &settings, int indents) {
+    const uint8_t *value = static_cast<const uint8_t *>(object) + member.offset;
+    const ApiDumpValueFunction dump_element = value_functions[member.value_function];
+    switch (member.kind) {
+        case ApiDumpMemberKind::value:
+        case ApiDumpMemberKind::pNext:
+            dump_element(value, settings, member.type_string, member.name, indents, nullptr);
+            break;
+        case ApiDumpMemberKind::pointer: {
+            const void *pointer = api_dump_load_pointer(value);
+            if (pointer == nullptr) {
+                dump_nullptr<Format, Features>(settings, member.type_string, member.name, indents);
+            } else {
+                dump_element(pointer, settings, member.type_string, member.name, indents, pointer);
+            }
+            break;
+        }
+        case ApiDumpMemberKind::pointer_array:
+        case ApiDumpMemberKind::double_pointer_array: {
+            const size_t len = static_cast<size_t>(api_dump_member_count(member, object));
+            dump_member_array<Format, Features>(member, static_cast<const uint8_t *>(api_dump_load_pointer(value)), len,
+                                                dump_element, settings, indents);
+            break;
+        }
+        case ApiDumpMemberKind::fixed_array:
+            dump_member_array<Format, Features>(member, value, static_cast<size_t>(api_dump_member_count(member, object)),
+                                                dump_element, settings, indents);
+            break;
+        case ApiDumpMemberKind::double_fixed_array:
+            dump_member_double_array<Format, Features>(member, value, static_cast<size_t>(api_dump_member_count(member, object)),
+                                                       member.columns, dump_element, settings, indents);
+            break;
+        case ApiDumpMemberKind::spirv: {
+            const uint32_t *code = static_cast<const uint32_t *>(api_dump_load_pointer(value));
+            const size_t len = static_cast<size_t>(api_dump_member_count(member, object));
+            if (settings.saveShaders()) {
+                dump_saved_spirv<Format, Features>(code, len, settings, member.type_string, member.name, indents);
+            } else if (settings.showShader()) {
+                dump_spirv<Format, Features>(code, len, settings, member.type_string, member.name, indents);
+            } else {
+                dump_special<Format, Features>("SHADER DATA", settings, member.type_string, member.name, indents);
+            }
+            break;
+        }
+    }
+}
+
+// Dumps the structure or union object, which info describes, the way the generated dump_<struct>() functions do.
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+void dump_struct(const ApiDumpStructInfo &info, const void *object, const ApiDumpSettings &settings, const char *type_name,
+                 const char *var_name, int indents, const void *address) {
+    dump_start<Format, Features>(settings, info.construct, type_name, var_name, indents, address);
+    if (info.set_state != nullptr) {
+        info.set_state(object);
+    }
+
+    const ApiDumpValueFunction *value_functions = api_dump_value_functions<Format, Features>();
+    const int member_indents = indents + (Format == ApiDumpFormat::Json ? 2 : 1);
+    const ApiDumpMember *next_member = nullptr;
+    bool separate = false;
+    for (uint32_t i = 0; i < info.member_count; ++i) {
+        const ApiDumpMember &member = info.members[i];
+        const bool valid = member.is_valid == nullptr || member.is_valid(object);
+        // Unions only show their active member
+        if (!valid && info.construct == OutputConstruct::api_union) {
+            continue;
+        }
+        if (separate) {
+            dump_separate_members<Format>(settings);
+        }
+        separate = true;
+        if (!valid) {
+            if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {
+                dump_special<Format, Features>("UNUSED", settings, member.type_string, member.name, indents + 1);
+            } else if constexpr (Format == ApiDumpFormat::Json) {
+                dump_json_UNUSED(settings, member.type_string, member.name, indents + 2);
+            }
+            continue;
+        }
+        if (member.kind == ApiDumpMemberKind::pNext) {
+            next_member = &member;
+        }
+        dump_member<Format, Features>(member, object, value_functions, settings, member_indents);
+    }
+
+    // The other formats show the chained structures in place of pNext
+    if constexpr (Format == ApiDumpFormat::Text) {
+        if (next_member != nullptr) {
+            dump_pNext_trampoline<ApiDumpFormat::Text, Features>(
+                api_dump_load_pointer(static_cast<const uint8_t *>(object) + next_member->offset), settings,
+                next_member->type_string, next_member->element_type_string, indents < 2 ? indents + 1 : indents);
+        }
+    }
+    dump_end<Format>(settings, OutputConstruct::api_struct, indents);
+}
@@ -0,0 +1,157 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how the command buffer tracking of api_dump scales with the number of threads allocating, beginning and freeing
+// command buffers, each from a pool of its own, the way applications record their frames. The sharded state the layer keeps is
+// compared with the same state behind a single lock, which is how the layer used to keep it.
+
+#include "api_dump_command_buffers.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// The command buffer state of the layer behind a single lock.
+class SingleLockCommandBuffers {
+   public:
+    void add(VkDevice device, VkCommandPool cmd_pool, uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers,
+             VkCommandBufferLevel level) {
+        std::lock_guard<std::mutex> lg(mutex);
+        auto &pool_cmd_buffers = pools[std::make_pair(device, cmd_pool)];
+        for (uint32_t i = 0; i < cmd_buffer_count; ++i) {
+            pool_cmd_buffers.insert(cmd_buffers[i]);
+            levels[cmd_buffers[i]] = level;
+        }
+    }
+
+    void erase(VkDevice device, VkCommandPool cmd_pool, uint32_t cmd_buffer_count, const VkCommandBuffer *cmd_buffers) {
+        std::lock_guard<std::mutex> lg(mutex);
+        auto &pool_cmd_buffers = pools[std::make_pair(device, cmd_pool)];
+        for (uint32_t i = 0; i < cmd_buffer_count; ++i) {
+            pool_cmd_buffers.erase(cmd_buffers[i]);
+            levels.erase(cmd_buffers[i]);
+        }
+    }
+
+    VkCommandBufferLevel level(VkCommandBuffer cmd_buffer) {
+        std::lock_guard<std::mutex> lg(mutex);
+        const auto level_iter = levels.find(cmd_buffer);
+        return level_iter != levels.end() ? level_iter->second : VK_COMMAND_BUFFER_LEVEL_MAX_ENUM;
+    }
+
+   private:
+    std::mutex mutex;
+    std::unordered_map<VkCommandBuffer, VkCommandBufferLevel> levels;
+    std::map<std::pair<VkDevice, VkCommandPool>, std::unordered_set<VkCommandBuffer>> pools;
+};
+
+// Handles that look like the aligned addresses drivers return, different for every thread.
+template <typename T>
+static T make_handle(uint32_t thread_index, uint64_t index) {
+    return reinterpret_cast<T>(static_cast<uintptr_t>(((uint64_t)thread_index + 1) << 32 | (index + 1) * 64));
+}
+
+// Each iteration allocates batch_size command buffers, looks up their level as vkBeginCommandBuffer does, and frees them.
+template <typename CommandBuffers>
+static double run_benchmark(uint32_t thread_count, uint32_t iterations, uint32_t batch_size) {
+    CommandBuffers command_buffers;
+    const VkDevice device = make_handle<VkDevice>(UINT32_MAX - 1, 0);
+    uint64_t level_sum = 0;
+    std::mutex level_sum_mutex;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            const VkCommandPool cmd_pool = make_handle<VkCommandPool>(t, UINT32_MAX);
+            std::vector<VkCommandBuffer> cmd_buffers(batch_size);
+            uint64_t thread_level_sum = 0;
+            for (uint32_t i = 0; i < iterations; ++i) {
+                for (uint32_t b = 0; b < batch_size; ++b) {
+                    cmd_buffers[b] = make_handle<VkCommandBuffer>(t, (uint64_t)i * batch_size + b);
+                }
+                command_buffers.add(device, cmd_pool, batch_size, cmd_buffers.data(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+                for (const VkCommandBuffer cmd_buffer : cmd_buffers) {
+                    thread_level_sum += command_buffers.level(cmd_buffer);
+                }
+                command_buffers.erase(device, cmd_pool, batch_size, cmd_buffers.data());
+            }
+            std::lock_guard<std::mutex> lg(level_sum_mutex);
+            level_sum += thread_level_sum;
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (level_sum != 0) {
+        std::cerr << "Command buffers were not tracked as primary\n";
+    }
+    return elapsed.count() / (static_cast<double>(thread_count) * iterations * batch_size);
+}
+
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--threads <count>] [--iterations <count>] [--batch <count>]\n";
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    uint32_t iterations = 20000;
+    uint32_t batch_size = 8;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            max_threads = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch_size = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (max_threads == 0 || iterations == 0 || batch_size == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::cout << iterations << " iterations of " << batch_size
+              << " command buffers per thread, wall time per command buffer of all the threads\n";
+    // Powers of two up to the number of threads asked for, and that number
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t thread_count = 1; thread_count < max_threads; thread_count *= 2) {
+        thread_counts.push_back(thread_count);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (const uint32_t thread_count : thread_counts) {
+        const double single_lock_ns = run_benchmark<SingleLockCommandBuffers>(thread_count, iterations, batch_size);
+        const double sharded_ns = run_benchmark<ApiDumpCommandBuffers>(thread_count, iterations, batch_size);
+        std::cout << thread_count << " threads: single lock " << single_lock_ns << " ns, sharded " << sharded_ns << " ns\n";
+    }
+    return EXIT_SUCCESS;
+}
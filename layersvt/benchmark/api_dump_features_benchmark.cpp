@@ -0,0 +1,160 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the text dump functions specialized for the default settings with the ones that read the settings on every call.
+// Small calls are dumped the way the dispatch functions dump them, without calling down the chain, into a file in the
+// temporary directory, once through each instantiation with the same settings.
+
+#include "generated/api_dump_implementation.h"
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+template <typename T>
+static T fake_handle(uintptr_t value) {
+    // Non-dispatchable handles are integers on 32-bit platforms
+    return (T)value;
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+static void dump_create_buffer(const VkBufferCreateInfo &create_info) {
+    ApiDumpInstance &dump_inst = ApiDumpInstance::current();
+    ApiDumpRecordGuard lg(dump_inst);
+    VkDevice device = fake_handle<VkDevice>(0x10);
+    VkBuffer buffer = fake_handle<VkBuffer>(0x5000);
+    dump_function_head<Features>(dump_inst, "vkCreateBuffer", "device, pCreateInfo, pAllocator, pBuffer", "VkResult");
+    if (dump_inst.shouldDumpOutput()) {
+        dump_return_value<Format, Features>(dump_inst.settings(), "VkResult", VK_SUCCESS, dump_return_value_VkResult<Format>);
+        dump_pre_function_formatting<Format, Features>(dump_inst.settings());
+        dump_params_vkCreateBuffer<Format, Features>(dump_inst, device, &create_info, nullptr, &buffer);
+        dump_post_function_formatting<Format>(dump_inst.settings());
+        flush(dump_inst.settings());
+    }
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+static void dump_cmd_bind_vertex_buffers(const std::vector<VkBuffer> &buffers, const std::vector<VkDeviceSize> &offsets) {
+    ApiDumpInstance &dump_inst = ApiDumpInstance::current();
+    ApiDumpRecordGuard lg(dump_inst);
+    VkCommandBuffer command_buffer = fake_handle<VkCommandBuffer>(0x20);
+    dump_function_head<Features>(dump_inst, "vkCmdBindVertexBuffers",
+                                 "commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets", "void");
+    if (dump_inst.shouldDumpOutput()) {
+        dump_pre_function_formatting<Format, Features>(dump_inst.settings());
+        dump_params_vkCmdBindVertexBuffers<Format, Features>(dump_inst, command_buffer, 0, static_cast<uint32_t>(buffers.size()),
+                                                             buffers.data(), offsets.data());
+        dump_post_function_formatting<Format>(dump_inst.settings());
+        flush(dump_inst.settings());
+    }
+}
+
+template <ApiDumpFormat Format, ApiDumpFeatures Features>
+static double run_benchmark(uint32_t iterations) {
+    const uint32_t queue_families[] = {0, 2};
+    const VkBufferCreateInfo create_info{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                         nullptr,
+                                         0,
+                                         65536,
+                                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         VK_SHARING_MODE_CONCURRENT,
+                                         2,
+                                         queue_families};
+    std::vector<VkBuffer> buffers;
+    std::vector<VkDeviceSize> offsets;
+    for (uint32_t i = 0; i < 4; ++i) {
+        buffers.push_back(fake_handle<VkBuffer>(0x100000 + i * 0x40));
+        offsets.push_back(static_cast<VkDeviceSize>(i) * 256);
+    }
+    const auto dump = [&]() {
+        dump_create_buffer<Format, Features>(create_info);
+        dump_cmd_bind_vertex_buffers<Format, Features>(buffers, offsets);
+    };
+
+    // Warm up the caches and let the buffers reach their steady-state size
+    for (uint32_t i = 0; i < 16; ++i) {
+        dump();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        dump();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (2.0 * iterations);
+}
+
+static void run_benchmarks(uint32_t iterations) {
+    // Interleaved, so that both see the same file system and cache conditions
+    double runtime = 0.0;
+    double specialized = 0.0;
+    for (uint32_t round = 0; round < 4; ++round) {
+        runtime += run_benchmark<ApiDumpFormat::Text, kApiDumpFeaturesRuntime>(iterations) / 4;
+        specialized += run_benchmark<ApiDumpFormat::Text, kApiDumpFeaturesDefault>(iterations) / 4;
+    }
+    std::cout << "Settings read on every call: " << runtime << " ns per call\n";
+    std::cout << "Specialized for the settings: " << specialized << " ns per call (" << 100.0 * (runtime - specialized) / runtime
+              << "% faster)\n";
+}
+
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--iterations <count>]\n";
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 100000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (iterations == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The layer appends the extension matching the format
+    const std::string log_filename = (std::filesystem::temp_directory_path() / "api_dump_features_benchmark").string();
+    const char *format_value = "text";
+    const char *log_filename_value = log_filename.c_str();
+    const VkBool32 disabled = VK_FALSE;
+    const VkLayerSettingEXT layer_settings[] = {
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyOutputFormat, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &format_value},
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyLogFilename, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &log_filename_value},
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyFlush, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &disabled},
+    };
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_CREATE_INFO_EXT, nullptr,
+                                                           static_cast<uint32_t>(std::size(layer_settings)), layer_settings};
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+    ApiDumpInstance::current().initLayerSettings(&instance_create_info, nullptr);
+    if (ApiDumpInstance::current().settings().features() != kApiDumpFeaturesDefault) {
+        std::cerr << "The settings from the environment or the settings file aren't the defaults\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Dumping text to " << log_filename << ".txt\n";
+    run_benchmarks(iterations);
+    return EXIT_SUCCESS;
+}
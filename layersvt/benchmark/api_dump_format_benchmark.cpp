@@ -0,0 +1,355 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how long api_dump takes to format large calls. The calls are dumped the way the dispatch functions dump them,
+// without calling down the chain, into a file in the temporary directory. Only the entry points the dispatch functions use are
+// called, so that the benchmark can be built against other versions of api_dump to compare them.
+
+#include "generated/api_dump_implementation.h"
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+template <typename T>
+static T fake_handle(uintptr_t value) {
+    // Non-dispatchable handles are integers on 32-bit platforms
+    return (T)value;
+}
+
+// A graphics pipeline using most of the fixed function state, with every array filled.
+struct GraphicsPipelineState {
+    GraphicsPipelineState() {
+        for (uint32_t i = 0; i < 8; ++i) {
+            map_entries.push_back({i, i * 4, 4});
+            specialization_data.push_back(i);
+        }
+        specialization_info = {static_cast<uint32_t>(map_entries.size()), map_entries.data(),
+                               specialization_data.size() * sizeof(uint32_t), specialization_data.data()};
+
+        const VkShaderStageFlagBits stage_bits[] = {VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+                                                    VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, VK_SHADER_STAGE_GEOMETRY_BIT,
+                                                    VK_SHADER_STAGE_FRAGMENT_BIT};
+        for (uint32_t i = 0; i < 5; ++i) {
+            stages.push_back({VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, stage_bits[i],
+                              fake_handle<VkShaderModule>(0x1000 + i), "main", &specialization_info});
+        }
+
+        for (uint32_t i = 0; i < 16; ++i) {
+            bindings.push_back({i, 16 + i * 4, i % 2 == 0 ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE});
+            attributes.push_back({i, i, VK_FORMAT_R32G32B32A32_SFLOAT, i * 4});
+        }
+        vertex_input = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+                        nullptr,
+                        0,
+                        static_cast<uint32_t>(bindings.size()),
+                        bindings.data(),
+                        static_cast<uint32_t>(attributes.size()),
+                        attributes.data()};
+
+        input_assembly = {VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO, nullptr, 0,
+                          VK_PRIMITIVE_TOPOLOGY_PATCH_LIST, VK_FALSE};
+        tessellation = {VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO, nullptr, 0, 3};
+
+        for (uint32_t i = 0; i < 16; ++i) {
+            viewports.push_back({i * 64.0f, i * 32.0f, 1920.5f, 1080.25f, 0.0f, 1.0f});
+            scissors.push_back({{static_cast<int32_t>(i * 64), static_cast<int32_t>(i * 32)}, {1920, 1080}});
+        }
+        viewport = {VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+                    nullptr,
+                    0,
+                    static_cast<uint32_t>(viewports.size()),
+                    viewports.data(),
+                    static_cast<uint32_t>(scissors.size()),
+                    scissors.data()};
+
+        rasterization = {VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+                         nullptr,
+                         0,
+                         VK_FALSE,
+                         VK_FALSE,
+                         VK_POLYGON_MODE_FILL,
+                         VK_CULL_MODE_BACK_BIT,
+                         VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                         VK_TRUE,
+                         1.25f,
+                         0.5f,
+                         -2.75f,
+                         1.0f};
+
+        multisample = {VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+                       nullptr,
+                       0,
+                       VK_SAMPLE_COUNT_4_BIT,
+                       VK_TRUE,
+                       0.25f,
+                       &sample_mask,
+                       VK_FALSE,
+                       VK_FALSE};
+
+        const VkStencilOpState stencil = {VK_STENCIL_OP_KEEP, VK_STENCIL_OP_REPLACE, VK_STENCIL_OP_INCREMENT_AND_CLAMP,
+                                          VK_COMPARE_OP_LESS_OR_EQUAL, 0xff, 0x0f, 1};
+        depth_stencil = {VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+                         nullptr,
+                         0,
+                         VK_TRUE,
+                         VK_TRUE,
+                         VK_COMPARE_OP_GREATER,
+                         VK_TRUE,
+                         VK_TRUE,
+                         stencil,
+                         stencil,
+                         0.0f,
+                         1.0f};
+
+        for (uint32_t i = 0; i < 8; ++i) {
+            blend_attachments.push_back({VK_TRUE, VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+                                         VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+                                         VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+                                             VK_COLOR_COMPONENT_A_BIT});
+            color_formats.push_back(VK_FORMAT_R8G8B8A8_UNORM);
+        }
+        color_blend = {VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+                       nullptr,
+                       0,
+                       VK_FALSE,
+                       VK_LOGIC_OP_COPY,
+                       static_cast<uint32_t>(blend_attachments.size()),
+                       blend_attachments.data(),
+                       {0.1f, 0.2f, 0.3f, 0.4f}};
+
+        // Dynamic viewports and scissors would hide the viewport state arrays
+        dynamic_states = {VK_DYNAMIC_STATE_LINE_WIDTH,           VK_DYNAMIC_STATE_DEPTH_BIAS,
+                          VK_DYNAMIC_STATE_BLEND_CONSTANTS,      VK_DYNAMIC_STATE_DEPTH_BOUNDS,
+                          VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, VK_DYNAMIC_STATE_STENCIL_WRITE_MASK,
+                          VK_DYNAMIC_STATE_STENCIL_REFERENCE};
+        dynamic = {VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO, nullptr, 0, static_cast<uint32_t>(dynamic_states.size()),
+                   dynamic_states.data()};
+
+        rendering = {VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+                     nullptr,
+                     0,
+                     static_cast<uint32_t>(color_formats.size()),
+                     color_formats.data(),
+                     VK_FORMAT_D32_SFLOAT_S8_UINT,
+                     VK_FORMAT_D32_SFLOAT_S8_UINT};
+
+        create_info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                       &rendering,
+                       0,
+                       static_cast<uint32_t>(stages.size()),
+                       stages.data(),
+                       &vertex_input,
+                       &input_assembly,
+                       &tessellation,
+                       &viewport,
+                       &rasterization,
+                       &multisample,
+                       &depth_stencil,
+                       &color_blend,
+                       &dynamic,
+                       fake_handle<VkPipelineLayout>(0x2000),
+                       VK_NULL_HANDLE,
+                       0,
+                       VK_NULL_HANDLE,
+                       -1};
+    }
+    // The structures point into each other
+    GraphicsPipelineState(const GraphicsPipelineState &) = delete;
+    GraphicsPipelineState &operator=(const GraphicsPipelineState &) = delete;
+
+    std::vector<VkSpecializationMapEntry> map_entries;
+    std::vector<uint32_t> specialization_data;
+    VkSpecializationInfo specialization_info{};
+    std::vector<VkPipelineShaderStageCreateInfo> stages;
+    std::vector<VkVertexInputBindingDescription> bindings;
+    std::vector<VkVertexInputAttributeDescription> attributes;
+    VkPipelineVertexInputStateCreateInfo vertex_input{};
+    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    VkPipelineTessellationStateCreateInfo tessellation{};
+    std::vector<VkViewport> viewports;
+    std::vector<VkRect2D> scissors;
+    VkPipelineViewportStateCreateInfo viewport{};
+    VkPipelineRasterizationStateCreateInfo rasterization{};
+    VkSampleMask sample_mask = 0xf;
+    VkPipelineMultisampleStateCreateInfo multisample{};
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    std::vector<VkPipelineColorBlendAttachmentState> blend_attachments;
+    VkPipelineColorBlendStateCreateInfo color_blend{};
+    std::vector<VkDynamicState> dynamic_states;
+    VkPipelineDynamicStateCreateInfo dynamic{};
+    std::vector<VkFormat> color_formats;
+    VkPipelineRenderingCreateInfo rendering{};
+    VkGraphicsPipelineCreateInfo create_info{};
+};
+
+template <ApiDumpFormat Format>
+static void dump_create_graphics_pipelines(const GraphicsPipelineState &state) {
+    ApiDumpInstance &dump_inst = ApiDumpInstance::current();
+    ApiDumpRecordGuard lg(dump_inst);
+    VkDevice device = fake_handle<VkDevice>(0x10);
+    VkPipeline pipeline = fake_handle<VkPipeline>(0x3000);
+    dump_function_head(dump_inst, "vkCreateGraphicsPipelines",
+                       "device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines", "VkResult");
+    if (dump_inst.shouldDumpOutput()) {
+        dump_return_value<Format>(dump_inst.settings(), "VkResult", VK_SUCCESS, dump_return_value_VkResult<Format>);
+        dump_pre_function_formatting<Format>(dump_inst.settings());
+        dump_params_vkCreateGraphicsPipelines<Format>(dump_inst, device, VK_NULL_HANDLE, 1, &state.create_info, nullptr, &pipeline);
+        dump_post_function_formatting<Format>(dump_inst.settings());
+        flush(dump_inst.settings());
+    }
+}
+
+template <ApiDumpFormat Format>
+static void dump_cmd_bind_vertex_buffers(const std::vector<VkBuffer> &buffers, const std::vector<VkDeviceSize> &offsets) {
+    ApiDumpInstance &dump_inst = ApiDumpInstance::current();
+    ApiDumpRecordGuard lg(dump_inst);
+    VkCommandBuffer command_buffer = fake_handle<VkCommandBuffer>(0x20);
+    dump_function_head(dump_inst, "vkCmdBindVertexBuffers", "commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets",
+                       "void");
+    if (dump_inst.shouldDumpOutput()) {
+        dump_pre_function_formatting<Format>(dump_inst.settings());
+        dump_params_vkCmdBindVertexBuffers<Format>(dump_inst, command_buffer, 0, static_cast<uint32_t>(buffers.size()),
+                                                   buffers.data(), offsets.data());
+        dump_post_function_formatting<Format>(dump_inst.settings());
+        flush(dump_inst.settings());
+    }
+}
+
+template <ApiDumpFormat Format>
+static void dump_create_shader_module(const std::vector<uint32_t> &code) {
+    ApiDumpInstance &dump_inst = ApiDumpInstance::current();
+    ApiDumpRecordGuard lg(dump_inst);
+    VkDevice device = fake_handle<VkDevice>(0x10);
+    VkShaderModule shader_module = fake_handle<VkShaderModule>(0x4000);
+    const VkShaderModuleCreateInfo create_info{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0,
+                                               code.size() * sizeof(uint32_t), code.data()};
+    dump_function_head(dump_inst, "vkCreateShaderModule", "device, pCreateInfo, pAllocator, pShaderModule", "VkResult");
+    if (dump_inst.shouldDumpOutput()) {
+        dump_return_value<Format>(dump_inst.settings(), "VkResult", VK_SUCCESS, dump_return_value_VkResult<Format>);
+        dump_pre_function_formatting<Format>(dump_inst.settings());
+        dump_params_vkCreateShaderModule<Format>(dump_inst, device, &create_info, nullptr, &shader_module);
+        dump_post_function_formatting<Format>(dump_inst.settings());
+        flush(dump_inst.settings());
+    }
+}
+
+template <typename Dump>
+static void run_benchmark(const char *name, uint32_t iterations, Dump dump) {
+    // Warm up the caches and let the buffers reach their steady-state size
+    for (uint32_t i = 0; i < 4; ++i) {
+        dump();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        dump();
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << iterations << " calls, " << elapsed.count() / iterations << " us per call\n";
+}
+
+template <ApiDumpFormat Format>
+static void run_benchmarks(uint32_t iterations) {
+    GraphicsPipelineState pipeline_state;
+    run_benchmark("vkCreateGraphicsPipelines", iterations,
+                  [&pipeline_state]() { dump_create_graphics_pipelines<Format>(pipeline_state); });
+
+    std::vector<VkBuffer> buffers;
+    std::vector<VkDeviceSize> offsets;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        buffers.push_back(fake_handle<VkBuffer>(0x100000 + i * 0x40));
+        offsets.push_back(static_cast<VkDeviceSize>(i) * 256);
+    }
+    run_benchmark("vkCmdBindVertexBuffers with 10000 buffers", (iterations + 9) / 10,
+                  [&buffers, &offsets]() { dump_cmd_bind_vertex_buffers<Format>(buffers, offsets); });
+
+    // The same module over and over, like an application creating its shader modules for each pipeline
+    std::vector<uint32_t> code(64 * 1024);
+    code[0] = 0x07230203;
+    for (size_t i = 1; i < code.size(); ++i) {
+        code[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+    run_benchmark("vkCreateShaderModule of 256 KB", (iterations + 9) / 10, [&code]() { dump_create_shader_module<Format>(code); });
+}
+
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--format text|html|json] [--iterations <count>] [--save-shaders]\n";
+}
+
+int main(int argc, char **argv) {
+    std::string format = "text";
+    uint32_t iterations = 1000;
+    bool save_shaders = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--save-shaders") {
+            save_shaders = true;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((format != "text" && format != "html" && format != "json") || iterations == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The layer appends the extension matching the format
+    const std::string log_filename = (std::filesystem::temp_directory_path() / "api_dump_format_benchmark").string();
+    const char *format_value = format.c_str();
+    const char *log_filename_value = log_filename.c_str();
+    const VkBool32 disabled = VK_FALSE;
+    const VkBool32 enabled = VK_TRUE;
+    std::vector<VkLayerSettingEXT> layer_settings = {
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyOutputFormat, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &format_value},
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyLogFilename, VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &log_filename_value},
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyFlush, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &disabled},
+        {"VK_LAYER_LUNARG_api_dump", kSettingsKeyShowShader, VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &enabled},
+    };
+    if (save_shaders) {
+        // By name, so that the benchmark still builds against versions of api_dump without the setting
+        layer_settings.push_back({"VK_LAYER_LUNARG_api_dump", "save_shaders", VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &enabled});
+    }
+    VkLayerSettingsCreateInfoEXT layer_settings_create_info{VK_STRUCTURE_TYPE_LAYER_SETTINGS_CREATE_INFO_EXT, nullptr,
+                                                           static_cast<uint32_t>(layer_settings.size()), layer_settings.data()};
+    VkInstanceCreateInfo instance_create_info{};
+    instance_create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_create_info.pNext = &layer_settings_create_info;
+    ApiDumpInstance::current().initLayerSettings(&instance_create_info, nullptr);
+
+    std::cout << "Dumping " << format << " to " << log_filename << (format == "text" ? ".txt" : "." + format) << "\n";
+    switch (ApiDumpInstance::current().settings().format()) {
+        case ApiDumpFormat::Text:
+            run_benchmarks<ApiDumpFormat::Text>(iterations);
+            break;
+        case ApiDumpFormat::Html:
+            run_benchmarks<ApiDumpFormat::Html>(iterations);
+            break;
+        case ApiDumpFormat::Json:
+            run_benchmarks<ApiDumpFormat::Json>(iterations);
+            break;
+        default:
+            break;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how fast api_dump can write its output to a file, through a file stream and through a memory mapping. The output of
+// each call is written to an std::ostream the way the layer writes it, with or without flushing it after every call, which
+// the layer does by default. The time it takes to close the file is included, it is when the file stream writes what it
+// buffered.
+
+#include "api_dump_mapped_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Text that looks like the output of a call, call_size bytes long.
+static std::string make_call_output(size_t call_size) {
+    static const char *const kLines[] = {
+        "Thread 0, Frame 12:\n",
+        "vkCmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets) returns void:\n",
+        "    commandBuffer:                  VkCommandBuffer = 0x5555d0c1f2a0\n",
+        "    firstBinding:                   uint32_t = 0\n",
+        "    pBuffers:                       const VkBuffer* = 0x7ffd4c2b9e10\n",
+        "        pBuffers[0]:                VkBuffer = 0x100000\n",
+        "    pOffsets:                       const VkDeviceSize* = 0x7ffd4c2b9e50\n",
+        "        pOffsets[0]:                const VkDeviceSize = 256\n",
+    };
+    std::string output;
+    for (size_t i = 0; output.size() < call_size; ++i) {
+        output += kLines[i % (sizeof(kLines) / sizeof(kLines[0]))];
+    }
+    output.resize(call_size - 1);
+    output += '\n';
+    return output;
+}
+
+static void run_benchmark(const char *name, std::streambuf *buf, const std::string &call_output, uint64_t total_size,
+                          bool flush, const std::chrono::steady_clock::time_point &start,
+                          const std::function<void()> &close_file) {
+    std::ostream out(buf);
+    for (uint64_t written = 0; written < total_size; written += call_output.size()) {
+        out.write(call_output.data(), static_cast<std::streamsize>(call_output.size()));
+        if (flush) {
+            out.flush();
+        }
+    }
+    close_file();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double megabytes = static_cast<double>(total_size) / (1024 * 1024);
+    std::cout << name << ": " << megabytes / elapsed.count() << " MB/s, " << elapsed.count() * 1e9 * call_output.size() / total_size
+              << " ns per call\n";
+}
+
+static void print_usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--size <megabytes>] [--call-size <bytes>] [--no-flush]\n";
+}
+
+int main(int argc, char **argv) {
+    uint64_t size_mb = 1024;
+    size_t call_size = 512;
+    bool flush = true;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            size_mb = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--call-size" && i + 1 < argc) {
+            call_size = static_cast<size_t>(strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--no-flush") {
+            flush = false;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (size_mb == 0 || call_size == 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const std::string call_output = make_call_output(call_size);
+    const uint64_t total_size = size_mb * 1024 * 1024;
+    const std::string filename = (std::filesystem::temp_directory_path() / "api_dump_output_benchmark.txt").string();
+    std::cout << "Writing " << size_mb << " MB to " << filename << " in calls of " << call_size << " bytes, "
+              << (flush ? "flushing after every call" : "without flushing") << "\n";
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::ofstream file_stream(filename, std::ofstream::out | std::ofstream::trunc);
+        run_benchmark("File stream", file_stream.rdbuf(), call_output, total_size, flush, start,
+                      [&file_stream]() { file_stream.close(); });
+    }
+    remove(filename.c_str());
+
+#if !defined(_WIN32)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto mapped_buf = std::make_unique<MappedFileBuf>();
+        if (!mapped_buf->open(filename)) {
+            std::cerr << "Could not map " << filename << "\n";
+            return EXIT_FAILURE;
+        }
+        run_benchmark("Memory mapped", mapped_buf.get(), call_output, total_size, flush, start,
+                      [&mapped_buf]() { mapped_buf.reset(); });
+    }
+    remove(filename.c_str());
+#endif
+    return EXIT_SUCCESS;
+}
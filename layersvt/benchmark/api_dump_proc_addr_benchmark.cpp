@@ -0,0 +1,89 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures how long the api_dump layer takes to resolve every Vulkan command at startup, the way vkGetInstanceProcAddr and
+// vkGetDeviceProcAddr look them up before calling down the chain. Only api_dump_known_instance_functions and
+// api_dump_known_device_functions are called, so that the benchmark can be built against other versions of api_dump to
+// compare them.
+
+#include "generated/api_dump_dispatch.h"
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Stands in for the next layer, which implements every device command
+static VKAPI_ATTR void VKAPI_CALL next_layer_function() {}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL next_layer_get_device_proc_addr(VkDevice, const char *) {
+    return next_layer_function;
+}
+
+// Resolves the command like vkGetInstanceProcAddr: instance commands first, then device commands
+static PFN_vkVoidFunction get_instance_proc_addr(const char *name) {
+    PFN_vkVoidFunction function = api_dump_known_instance_functions<ApiDumpFormat::Text>(VK_NULL_HANDLE, name);
+    if (function) return function;
+    return api_dump_known_device_functions<ApiDumpFormat::Text>(VK_NULL_HANDLE, name);
+}
+
+template <typename Resolve>
+static void run_benchmark(const char *name, uint32_t iterations, Resolve resolve) {
+    // Commands api_dump doesn't know fall through to the next layer, and aren't timed here
+    uint32_t resolved = 0;
+    for (uint32_t id = 0; id < kApiDumpFunctionIdCount; ++id) {
+        resolved += resolve(kApiDumpFunctionNames[id]) != nullptr;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        for (uint32_t id = 0; id < kApiDumpFunctionIdCount; ++id) {
+            resolved += resolve(kApiDumpFunctionNames[id]) != nullptr;
+        }
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << resolved / (iterations + 1) << " of " << kApiDumpFunctionIdCount << " commands resolved, "
+              << elapsed.count() / iterations << " us per startup, "
+              << elapsed.count() * 1000.0 / (static_cast<double>(iterations) * kApiDumpFunctionIdCount) << " ns per command\n";
+}
+
+int main(int argc, char **argv) {
+    uint32_t iterations = 1000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            iterations = 0;
+            break;
+        }
+    }
+    if (iterations == 0) {
+        std::cerr << "Usage: " << argv[0] << " [--iterations <count>]\n";
+        return EXIT_FAILURE;
+    }
+
+    // Dispatchable handles start with the loader's dispatch pointer, which keys the layer's dispatch tables
+    static void *loader_dispatch = nullptr;
+    static void *device_object = &loader_dispatch;
+    VkDevice device = reinterpret_cast<VkDevice>(&device_object);
+    initDeviceTable(device, next_layer_get_device_proc_addr);
+
+    run_benchmark("vkGetInstanceProcAddr", iterations, [](const char *name) { return get_instance_proc_addr(name); });
+    run_benchmark("vkGetDeviceProcAddr", iterations, [device](const char *name) {
+        return api_dump_known_device_functions<ApiDumpFormat::Text>(device, name);
+    });
+    return EXIT_SUCCESS;
+}
@@ -81,10 +81,9 @@ static struct {
 #endif
 
 static std::unordered_map<VkPhysicalDevice, VkInstance> layer_instances;
-static std::unordered_map<void *, monitor_layer_data *> layer_data_map;
+static DispatchKeyMap<monitor_layer_data> layer_data_map;
 
-template monitor_layer_data *GetLayerDataPtr<monitor_layer_data>(void *data_key,
-                                                                 std::unordered_map<void *, monitor_layer_data *> &data_map);
+template monitor_layer_data *GetLayerDataPtr<monitor_layer_data>(void *data_key, DispatchKeyMap<monitor_layer_data> &data_map);
 
 VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice gpu, const VkDeviceCreateInfo *pCreateInfo,
                                               const VkAllocationCallbacks *pAllocator, VkDevice *pDevice) {
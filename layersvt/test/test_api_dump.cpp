@@ -19,14 +19,179 @@
 
 #include <gtest/gtest.h>
 
+#include <cctype>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
 
 #include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 static const char* kLayerName = "VK_LAYER_LUNARG_api_dump";
 
+// A JSON value parsed by ParseJson(), enough to check the structure of the JSON the layer writes.
+struct JsonValue {
+    enum Kind { Null, Bool, Number, String, Array, Object };
+    Kind kind = Null;
+    std::string text;  // Of strings, and of numbers as written
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* find(const char* name) const {
+        for (const auto& member : members) {
+            if (member.first == name) return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser {
+   public:
+    explicit JsonParser(const std::string& input) : text(input) {}
+
+    // Returns false unless the whole input is one JSON value
+    bool parse(JsonValue& value) {
+        if (!parseValue(value, 0)) return false;
+        skipSpaces();
+        return pos == text.size();
+    }
+
+   private:
+    void skipSpaces() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) ++pos;
+    }
+
+    bool consume(char c) {
+        skipSpaces();
+        if (pos < text.size() && text[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeWord(const char* word) {
+        const size_t size = std::strlen(word);
+        if (text.compare(pos, size, word) != 0) return false;
+        pos += size;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (!consume('"')) return false;
+        while (pos < text.size() && text[pos] != '"') {
+            if (static_cast<unsigned char>(text[pos]) < 0x20) return false;
+            if (text[pos] == '\\') {
+                if (++pos == text.size() || std::strchr("\"\\/bfnrtu", text[pos]) == nullptr) return false;
+                if (text[pos] == 'u') {
+                    if (pos + 4 >= text.size()) return false;
+                    for (size_t i = 1; i <= 4; ++i) {
+                        if (!isxdigit(static_cast<unsigned char>(text[pos + i]))) return false;
+                    }
+                    pos += 4;
+                }
+            }
+            out.push_back(text[pos++]);
+        }
+        return consume('"');
+    }
+
+    bool parseNumber(std::string& out) {
+        const size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') ++pos;
+        const auto digits = [&]() {
+            const size_t digits_start = pos;
+            while (pos < text.size() && isdigit(static_cast<unsigned char>(text[pos]))) ++pos;
+            return pos > digits_start;
+        };
+        if (!digits()) return false;
+        if (pos < text.size() && text[pos] == '.') {
+            ++pos;
+            if (!digits()) return false;
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) ++pos;
+            if (!digits()) return false;
+        }
+        out = text.substr(start, pos - start);
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, uint32_t depth) {
+        skipSpaces();
+        if (pos == text.size() || depth > 64) return false;
+        const char c = text[pos];
+        if (c == '{') {
+            value.kind = JsonValue::Object;
+            ++pos;
+            if (consume('}')) return true;
+            do {
+                value.members.emplace_back();
+                if (!parseString(value.members.back().first) || !consume(':') ||
+                    !parseValue(value.members.back().second, depth + 1))
+                    return false;
+            } while (consume(','));
+            return consume('}');
+        } else if (c == '[') {
+            value.kind = JsonValue::Array;
+            ++pos;
+            if (consume(']')) return true;
+            do {
+                value.elements.emplace_back();
+                if (!parseValue(value.elements.back(), depth + 1)) return false;
+            } while (consume(','));
+            return consume(']');
+        } else if (c == '"') {
+            value.kind = JsonValue::String;
+            return parseString(value.text);
+        } else if (c == 't' || c == 'f') {
+            value.kind = JsonValue::Bool;
+            return consumeWord(c == 't' ? "true" : "false");
+        } else if (c == 'n') {
+            value.kind = JsonValue::Null;
+            return consumeWord("null");
+        }
+        value.kind = JsonValue::Number;
+        return parseNumber(value.text);
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+};
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Checks that the parameters, members and elements of integer types have numbers as values, recursively
+static void CheckJsonNumbers(const JsonValue& value) {
+    if (value.kind == JsonValue::Array) {
+        for (const JsonValue& element : value.elements) CheckJsonNumbers(element);
+        return;
+    }
+    if (value.kind != JsonValue::Object) return;
+    const JsonValue* type = value.find("type");
+    const JsonValue* type_value = value.find("value");
+    if (type != nullptr && type_value != nullptr) {
+        static const char* kIntegerTypes[] = {"uint8_t", "int8_t", "uint16_t", "int16_t", "uint32_t",
+                                              "int32_t", "uint64_t", "int64_t", "size_t",  "VkDeviceSize"};
+        // Array elements have the const qualifier of the array
+        const std::string element_type = type->text.compare(0, 6, "const ") == 0 ? type->text.substr(6) : type->text;
+        for (const char* integer_type : kIntegerTypes) {
+            if (element_type == integer_type) {
+                EXPECT_EQ(type_value->kind, JsonValue::Number) << "Value of type " << type->text;
+            }
+        }
+    }
+    for (const auto& member : value.members) CheckJsonNumbers(member.second);
+}
+
 class ApiDumpTests : public VkTestFramework {
    public:
     ~ApiDumpTests(){};
@@ -66,3 +231,105 @@ TEST_F(ApiDumpTests, init_layer) {
 
     EXPECT_STREQ(file_start_content_read.c_str(), file_start_content_expected);
 }
+
+TEST_F(ApiDumpTests, output_format_jsonl) {
+    TEST_DESCRIPTION("Test that every line of the JSON Lines output is a JSON object, with numbers for the numeric fields");
+
+    VkBool32 use_file = VK_TRUE;
+    VkBool32 show_thread_and_frame = VK_TRUE;
+    VkBool32 timestamp = VK_TRUE;
+    const char* filename_string = "api_dump_output.jsonl";
+    const char* output_format = "jsonl";
+
+    const std::vector<VkLayerSettingEXT> settings = {
+        {kLayerName, "file", VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &use_file},
+        {kLayerName, "log_filename", VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &filename_string},
+        {kLayerName, "output_format", VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &output_format},
+        {kLayerName, "show_thread_and_frame", VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &show_thread_and_frame},
+        {kLayerName, "timestamp", VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &timestamp}};
+
+    {
+        layer_test::VulkanInstanceBuilder inst_builder;
+        VkResult err = inst_builder.Init(settings);
+        EXPECT_EQ(err, VK_SUCCESS);
+    }
+
+    // The layer is unloaded with the instance, which writes the rest of the output file
+    const std::filesystem::path path = std::filesystem::current_path() / std::filesystem::path(filename_string);
+    const std::string content = ReadFile(path);
+    ASSERT_FALSE(content.empty());
+    EXPECT_EQ(content.back(), '\n');
+
+    size_t call_count = 0;
+    size_t line_start = 0;
+    while (line_start < content.size()) {
+        size_t line_end = content.find('\n', line_start);
+        if (line_end == std::string::npos) line_end = content.size();
+        const std::string line = content.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+
+        JsonValue call;
+        ASSERT_TRUE(JsonParser(line).parse(call)) << line;
+        ASSERT_EQ(call.kind, JsonValue::Object) << line;
+        if (call.find("name") == nullptr) continue;
+        ++call_count;
+
+        for (const char* number_name : {"thread", "frame", "time"}) {
+            const JsonValue* number = call.find(number_name);
+            ASSERT_TRUE(number != nullptr) << number_name << " in " << line;
+            EXPECT_EQ(number->kind, JsonValue::Number) << number_name << " in " << line;
+        }
+        CheckJsonNumbers(call);
+    }
+    EXPECT_GT(call_count, 0u);
+}
+
+TEST_F(ApiDumpTests, output_format_trace) {
+    TEST_DESCRIPTION("Test that the trace output is a trace event document with complete events");
+
+    VkBool32 use_file = VK_TRUE;
+    const char* filename_string = "api_dump_output_trace.json";
+    const char* output_format = "trace";
+
+    const std::vector<VkLayerSettingEXT> settings = {
+        {kLayerName, "file", VK_LAYER_SETTING_TYPE_BOOL32_EXT, 1, &use_file},
+        {kLayerName, "log_filename", VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &filename_string},
+        {kLayerName, "output_format", VK_LAYER_SETTING_TYPE_STRING_EXT, 1, &output_format}};
+
+    {
+        layer_test::VulkanInstanceBuilder inst_builder;
+        VkResult err = inst_builder.Init(settings);
+        EXPECT_EQ(err, VK_SUCCESS);
+    }
+
+    // The layer is unloaded with the instance, which closes off the trace
+    const std::filesystem::path path = std::filesystem::current_path() / std::filesystem::path(filename_string);
+    JsonValue trace;
+    ASSERT_TRUE(JsonParser(ReadFile(path)).parse(trace));
+    ASSERT_EQ(trace.kind, JsonValue::Object);
+    const JsonValue* events = trace.find("traceEvents");
+    ASSERT_TRUE(events != nullptr);
+    ASSERT_EQ(events->kind, JsonValue::Array);
+
+    size_t complete_event_count = 0;
+    for (const JsonValue& event : events->elements) {
+        ASSERT_EQ(event.kind, JsonValue::Object);
+        const JsonValue* name = event.find("name");
+        const JsonValue* phase = event.find("ph");
+        ASSERT_TRUE(name != nullptr && name->kind == JsonValue::String);
+        ASSERT_TRUE(phase != nullptr && phase->kind == JsonValue::String);
+        for (const char* number_name : {"pid", "tid"}) {
+            const JsonValue* number = event.find(number_name);
+            ASSERT_TRUE(number != nullptr) << number_name << " in " << name->text;
+            EXPECT_EQ(number->kind, JsonValue::Number) << number_name << " in " << name->text;
+        }
+        if (phase->text != "X") continue;
+        ++complete_event_count;
+        for (const char* number_name : {"ts", "dur"}) {
+            const JsonValue* number = event.find(number_name);
+            ASSERT_TRUE(number != nullptr) << number_name << " in " << name->text;
+            EXPECT_EQ(number->kind, JsonValue::Number) << number_name << " in " << name->text;
+        }
+    }
+    EXPECT_GT(complete_event_count, 0u);
+}
@@ -0,0 +1,213 @@
+/* Copyright (c) 2026 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests of the object names of the api_dump layer, which don't need a Vulkan implementation. The concurrent tests are most
+// useful built with -fsanitize=thread or -fsanitize=address.
+
+#include "api_dump_object_names.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The readers of the names are thread local, so like in the layer there is only one of them. Each test uses handles of its own.
+static ApiDumpObjectNames& Names() {
+    static ApiDumpObjectNames names;
+    return names;
+}
+
+// The name of handle, or an empty string if it has none
+static std::string NameOf(const ApiDumpObjectNames& names, uint64_t handle) {
+    std::string name;
+    names.visit(handle, [&](const std::string& visited) { name = visited; });
+    return name;
+}
+
+// Names that tell the handle and the generation they were given for
+static std::string MakeName(uint64_t handle, uint32_t generation) {
+    return "object " + std::to_string(handle) + " generation " + std::to_string(generation);
+}
+
+static bool IsNameOf(const std::string& name, uint64_t handle) {
+    const std::string prefix = "object " + std::to_string(handle) + " generation ";
+    return name.compare(0, prefix.size(), prefix) == 0 && name.size() > prefix.size();
+}
+
+TEST(ApiDumpObjectNamesTests, rename) {
+    ApiDumpObjectNames& names = Names();
+    EXPECT_FALSE(names.visit(1, [](const std::string&) {}));
+
+    names.set(1, "buffer");
+    names.set(2, "buffer");
+    EXPECT_EQ(NameOf(names, 1), "buffer");
+
+    // The same name again
+    names.set(1, "buffer");
+    EXPECT_EQ(NameOf(names, 1), "buffer");
+
+    // A different name, while another handle keeps the previous one
+    names.set(1, "vertex buffer");
+    EXPECT_EQ(NameOf(names, 1), "vertex buffer");
+    EXPECT_EQ(NameOf(names, 2), "buffer");
+
+    names.set(2, "index buffer");
+    EXPECT_EQ(NameOf(names, 2), "index buffer");
+    EXPECT_EQ(NameOf(names, 1), "vertex buffer");
+
+    // Handles of 0 are never named
+    names.set(0, "null");
+    EXPECT_FALSE(names.visit(0, [](const std::string&) {}));
+
+    names.erase(1);
+    names.erase(2);
+}
+
+TEST(ApiDumpObjectNamesTests, name_after_erase) {
+    ApiDumpObjectNames& names = Names();
+    names.set(7, "image");
+    names.erase(7);
+    EXPECT_FALSE(names.visit(7, [](const std::string&) {}));
+
+    // Handles are reused by drivers once the object is destroyed
+    names.set(7, "depth image");
+    EXPECT_EQ(NameOf(names, 7), "depth image");
+
+    // A null name removes the name, like erase()
+    names.set(7, nullptr);
+    EXPECT_FALSE(names.visit(7, [](const std::string&) {}));
+    names.set(7, "image");
+    EXPECT_EQ(NameOf(names, 7), "image");
+
+    // Erasing a handle that has no name does nothing
+    names.erase(8);
+    EXPECT_EQ(NameOf(names, 7), "image");
+    names.erase(7);
+}
+
+TEST(ApiDumpObjectNamesTests, concurrent_set_erase_visit) {
+    const uint32_t kWriterCount = 2;
+    const uint32_t kReaderCount = 2;
+    const uint64_t kHandlesPerWriter = 64;
+    const uint32_t kGenerations = 200;
+    const uint64_t kFirstHandle = 100;
+
+    ApiDumpObjectNames& names = Names();
+    std::atomic<bool> writing{true};
+    std::atomic<uint32_t> wrong_names{0};
+
+    // Readers only ever see a name one of the writers gave to the handle, or no name
+    std::vector<std::thread> readers;
+    for (uint32_t r = 0; r < kReaderCount; ++r) {
+        readers.emplace_back([&]() {
+            do {
+                for (uint64_t handle = kFirstHandle; handle < kFirstHandle + kWriterCount * kHandlesPerWriter; ++handle) {
+                    names.visit(handle, [&](const std::string& name) {
+                        if (!IsNameOf(name, handle)) ++wrong_names;
+                    });
+                }
+            } while (writing.load());
+        });
+    }
+
+    // Each writer names, renames and erases handles of its own
+    std::vector<std::thread> writers;
+    for (uint32_t w = 0; w < kWriterCount; ++w) {
+        writers.emplace_back([&, w]() {
+            for (uint32_t generation = 0; generation < kGenerations; ++generation) {
+                for (uint64_t i = 0; i < kHandlesPerWriter; ++i) {
+                    const uint64_t handle = kFirstHandle + w * kHandlesPerWriter + i;
+                    if ((generation + i) % 3 == 2) {
+                        names.erase(handle);
+                    } else {
+                        names.set(handle, MakeName(handle, generation).c_str());
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    writing = false;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(wrong_names.load(), 0u);
+
+    // The last generation of each handle is what is left
+    for (uint32_t w = 0; w < kWriterCount; ++w) {
+        for (uint64_t i = 0; i < kHandlesPerWriter; ++i) {
+            const uint64_t handle = kFirstHandle + w * kHandlesPerWriter + i;
+            if ((kGenerations - 1 + i) % 3 == 2) {
+                EXPECT_FALSE(names.visit(handle, [](const std::string&) {}));
+            } else {
+                EXPECT_EQ(NameOf(names, handle), MakeName(handle, kGenerations - 1));
+            }
+        }
+    }
+}
+
+TEST(ApiDumpObjectNamesTests, rebuild_while_reading) {
+    const uint32_t kReaderCount = 2;
+    const uint64_t kFirstStableHandle = 1000;
+    const uint64_t kStableHandles = 16;
+    const uint64_t kFirstTransientHandle = 1000000;
+    const uint64_t kTransientHandles = 20000;
+
+    ApiDumpObjectNames& names = Names();
+    for (uint64_t handle = kFirstStableHandle; handle < kFirstStableHandle + kStableHandles; ++handle) {
+        names.set(handle, MakeName(handle, 0).c_str());
+    }
+
+    // The names of the stable handles never change, so they must always be found while the table is rebuilt
+    std::atomic<bool> writing{true};
+    std::atomic<uint32_t> missing_names{0};
+    std::vector<std::thread> readers;
+    for (uint32_t r = 0; r < kReaderCount; ++r) {
+        readers.emplace_back([&]() {
+            do {
+                for (uint64_t handle = kFirstStableHandle; handle < kFirstStableHandle + kStableHandles; ++handle) {
+                    if (NameOf(names, handle) != MakeName(handle, 0)) ++missing_names;
+                }
+            } while (writing.load());
+        });
+    }
+
+    // Enough distinct handles to fill the table many times, which rebuilds it larger and then drops the erased handles
+    for (uint64_t i = 0; i < kTransientHandles; ++i) {
+        const uint64_t handle = kFirstTransientHandle + i;
+        names.set(handle, MakeName(handle, 0).c_str());
+        if (i >= 4000) {
+            names.erase(handle - 4000);
+        }
+    }
+    writing = false;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(missing_names.load(), 0u);
+
+    for (uint64_t i = 0; i < kTransientHandles; ++i) {
+        const uint64_t handle = kFirstTransientHandle + i;
+        if (i + 4000 < kTransientHandles) {
+            EXPECT_FALSE(names.visit(handle, [](const std::string&) {}));
+        } else {
+            EXPECT_EQ(NameOf(names, handle), MakeName(handle, 0));
+        }
+    }
+}
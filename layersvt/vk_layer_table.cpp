@@ -18,7 +18,6 @@
  * Author: Tobin Ehlis <tobin@lunarg.com>
  */
 #include <assert.h>
-#include <unordered_map>
 #include "vulkan/vk_layer.h"
 #include "vk_layer_table.h"
 
@@ -27,36 +26,24 @@ static instance_table_map tableInstanceMap;
 
 dispatch_key get_dispatch_key(const void *object) { return (dispatch_key) * (VkuDeviceDispatchTable **)object; }
 
-// Map lookup must be thread safe
+// Map lookup must be thread safe, the maps can be changed by other threads creating or destroying instances and devices
 VkuDeviceDispatchTable *device_dispatch_table(void *object) {
     dispatch_key key = get_dispatch_key(object);
-    device_table_map::const_iterator it = tableMap.find((void *)key);
-    assert(it != tableMap.end() && "Not able to find device dispatch entry");
-    return it->second;
+    VkuDeviceDispatchTable *pTable = tableMap.find(key);
+    assert(pTable != nullptr && "Not able to find device dispatch entry");
+    return pTable;
 }
 
 VkuInstanceDispatchTable *instance_dispatch_table(void *object) {
     dispatch_key key = get_dispatch_key(object);
-    instance_table_map::const_iterator it = tableInstanceMap.find((void *)key);
-    assert(it != tableInstanceMap.end() && "Not able to find instance dispatch entry");
-    return it->second;
+    VkuInstanceDispatchTable *pTable = tableInstanceMap.find(key);
+    assert(pTable != nullptr && "Not able to find instance dispatch entry");
+    return pTable;
 }
 
-void destroy_dispatch_table(device_table_map &map, dispatch_key key) {
-    device_table_map::const_iterator it = map.find((void *)key);
-    if (it != map.end()) {
-        delete it->second;
-        map.erase(it);
-    }
-}
+void destroy_dispatch_table(device_table_map &map, dispatch_key key) { delete map.erase(key); }
 
-void destroy_dispatch_table(instance_table_map &map, dispatch_key key) {
-    instance_table_map::const_iterator it = map.find((void *)key);
-    if (it != map.end()) {
-        delete it->second;
-        map.erase(it);
-    }
-}
+void destroy_dispatch_table(instance_table_map &map, dispatch_key key) { delete map.erase(key); }
 
 void destroy_device_dispatch_table(dispatch_key key) { destroy_dispatch_table(tableMap, key); }
 
@@ -64,16 +51,16 @@ void destroy_instance_dispatch_table(dispatch_key key) { destroy_dispatch_table(
 
 VkuDeviceDispatchTable *get_dispatch_table(device_table_map &map, void *object) {
     dispatch_key key = get_dispatch_key(object);
-    device_table_map::const_iterator it = map.find((void *)key);
-    assert(it != map.end() && "Not able to find device dispatch entry");
-    return it->second;
+    VkuDeviceDispatchTable *pTable = map.find(key);
+    assert(pTable != nullptr && "Not able to find device dispatch entry");
+    return pTable;
 }
 
 VkuInstanceDispatchTable *get_dispatch_table(instance_table_map &map, void *object) {
     dispatch_key key = get_dispatch_key(object);
-    instance_table_map::const_iterator it = map.find((void *)key);
-    assert(it != map.end() && "Not able to find instance dispatch entry");
-    return it->second;
+    VkuInstanceDispatchTable *pTable = map.find(key);
+    assert(pTable != nullptr && "Not able to find instance dispatch entry");
+    return pTable;
 }
 
 VkLayerInstanceCreateInfo *get_chain_info(const VkInstanceCreateInfo *pCreateInfo, VkLayerFunction func) {
@@ -102,24 +89,16 @@ VkLayerDeviceCreateInfo *get_chain_info(const VkDeviceCreateInfo *pCreateInfo, V
  * If use the object themselves as key to map then implies Create entrypoints have to be intercepted
  * and a new key inserted into map */
 VkuInstanceDispatchTable *initInstanceTable(VkInstance instance, const PFN_vkGetInstanceProcAddr gpa, instance_table_map &map) {
-    VkuInstanceDispatchTable *pTable;
-    dispatch_key key = get_dispatch_key(instance);
-    instance_table_map::const_iterator it = map.find((void *)key);
-
-    if (it == map.end()) {
-        pTable = new VkuInstanceDispatchTable;
-        map[(void *)key] = pTable;
-    } else {
-        return it->second;
-    }
-
-    vkuInitInstanceDispatchTable(instance, pTable, gpa);
-
-    // Setup func pointers that are required but not externally exposed.  These won't be added to the instance dispatch table by
-    // default.
-    pTable->GetPhysicalDeviceProcAddr = (PFN_GetPhysicalDeviceProcAddr)gpa(instance, "vk_layerGetPhysicalDeviceProcAddr");
-
-    return pTable;
+    // The table is set up before other threads can find it
+    return map.findOrInsert(get_dispatch_key(instance), [instance, gpa]() {
+        VkuInstanceDispatchTable *pTable = new VkuInstanceDispatchTable;
+        vkuInitInstanceDispatchTable(instance, pTable, gpa);
+
+        // Setup func pointers that are required but not externally exposed.  These won't be added to the instance dispatch table
+        // by default.
+        pTable->GetPhysicalDeviceProcAddr = (PFN_GetPhysicalDeviceProcAddr)gpa(instance, "vk_layerGetPhysicalDeviceProcAddr");
+        return pTable;
+    });
 }
 
 VkuInstanceDispatchTable *initInstanceTable(VkInstance instance, const PFN_vkGetInstanceProcAddr gpa) {
@@ -127,20 +106,12 @@ VkuInstanceDispatchTable *initInstanceTable(VkInstance instance, const PFN_vkGet
 }
 
 VkuDeviceDispatchTable *initDeviceTable(VkDevice device, const PFN_vkGetDeviceProcAddr gpa, device_table_map &map) {
-    VkuDeviceDispatchTable *pTable;
-    dispatch_key key = get_dispatch_key(device);
-    device_table_map::const_iterator it = map.find((void *)key);
-
-    if (it == map.end()) {
-        pTable = new VkuDeviceDispatchTable;
-        map[(void *)key] = pTable;
-    } else {
-        return it->second;
-    }
-
-    vkuInitDeviceDispatchTable(device, pTable, gpa);
-
-    return pTable;
+    // The table is set up before other threads can find it
+    return map.findOrInsert(get_dispatch_key(device), [device, gpa]() {
+        VkuDeviceDispatchTable *pTable = new VkuDeviceDispatchTable;
+        vkuInitDeviceDispatchTable(device, pTable, gpa);
+        return pTable;
+    });
 }
 
 VkuDeviceDispatchTable *initDeviceTable(VkDevice device, const PFN_vkGetDeviceProcAddr gpa) {
@@ -22,11 +22,268 @@
 #include <vulkan/utility/vk_dispatch_table.h>
 #include "vulkan/vk_layer.h"
 #include "vulkan/vulkan.h"
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
 
-typedef std::unordered_map<void *, VkuDeviceDispatchTable *> device_table_map;
-typedef std::unordered_map<void *, VkuInstanceDispatchTable *> instance_table_map;
+// Epoch based reclamation of the slot arrays of every DispatchKeyMap, in the style of ApiDumpObjectNames: each probing thread
+// announces the epoch it started probing in, and an array retired in an epoch is freed once no thread probes in that epoch or
+// an earlier one. The maps share the epoch and the announcements, so a thread announces itself once whatever map it probes.
+class DispatchKeyEpochs {
+    // Announces the epoch its thread is probing in, or 0 when it isn't probing. Allocated once per thread, and reused by the
+    // threads that start after it exited. They are never freed, as threads may exit after the layer is unloaded.
+    struct Reader {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{true};
+        Reader *next = nullptr;
+    };
+
+   public:
+    // Held by a thread while it probes the slots of a map.
+    class ReadScope {
+       public:
+        ReadScope() : reader(threadReader()) {
+            reader.epoch.store(epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+            // Orders the announcement before the slots are read, see retire()
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        ReadScope(const ReadScope &) = delete;
+        ReadScope &operator=(const ReadScope &) = delete;
+        ~ReadScope() { reader.epoch.store(0, std::memory_order_release); }
+
+       private:
+        Reader &reader;
+    };
+
+    // Must be called once what is retired can no longer be reached by threads that start probing from now on. Returns the epoch
+    // it was retired in.
+    static uint64_t retire() {
+        // A thread that announces a later epoch read the epoch after it was advanced, and can't reach what was retired. The
+        // fence pairs with the one in ReadScope: either this thread sees the announcement, or the prober sees the new slots.
+        const uint64_t retire_epoch = epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return retire_epoch;
+    }
+
+    // What was retired before the returned epoch can be freed.
+    static uint64_t oldestProbed() {
+        uint64_t oldest = UINT64_MAX;
+        for (Reader *reader = readers.load(std::memory_order_acquire); reader != nullptr; reader = reader->next) {
+            const uint64_t reader_epoch = reader->epoch.load(std::memory_order_acquire);
+            if (reader_epoch != 0) {
+                oldest = std::min(oldest, reader_epoch);
+            }
+        }
+        return oldest;
+    }
+
+   private:
+    static Reader &threadReader() {
+        struct ThreadReader {
+            Reader *reader = nullptr;
+            ~ThreadReader() {
+                if (reader != nullptr) {
+                    reader->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+        thread_local ThreadReader thread_reader;
+        if (thread_reader.reader == nullptr) {
+            thread_reader.reader = acquireReader();
+        }
+        return *thread_reader.reader;
+    }
+
+    static Reader *acquireReader() {
+        for (Reader *reader = readers.load(std::memory_order_acquire); reader != nullptr; reader = reader->next) {
+            bool in_use = false;
+            if (reader->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+                return reader;
+            }
+        }
+        Reader *reader = new Reader;
+        reader->next = readers.load(std::memory_order_relaxed);
+        while (!readers.compare_exchange_weak(reader->next, reader, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return reader;
+    }
+
+    static inline std::atomic<uint64_t> epoch{1};
+    static inline std::atomic<Reader *> readers{nullptr};
+};
+
+// Maps the dispatch keys of dispatchable objects to per-instance or per-device data. Intercepted calls look up the map on every
+// call, so find() is wait-free: it doesn't lock or allocate, and only probes an open addressed array of slots. Inserting and
+// erasing happens when instances and devices are created and destroyed, possibly on other threads, and is serialized by a mutex.
+// Erased slots are left as tombstones so that concurrent probes don't stop early. When the slots fill up, with live entries or
+// tombstones, the live entries are copied to a new array. The previous array is freed through DispatchKeyEpochs once no thread
+// can still be probing it.
+template <typename T>
+class DispatchKeyMap {
+   public:
+    DispatchKeyMap() = default;
+    DispatchKeyMap(const DispatchKeyMap &) = delete;
+    DispatchKeyMap &operator=(const DispatchKeyMap &) = delete;
+
+    T *find(const void *key) const {
+        DispatchKeyEpochs::ReadScope read_scope;
+        const Slots *current = slots.load(std::memory_order_acquire);
+        if (current == nullptr) return nullptr;
+        // There is always an empty slot, so the probe ends
+        for (size_t i = hash(key) & current->mask;; i = (i + 1) & current->mask) {
+            const Entry &entry = current->entries[i];
+            const void *entry_key = entry.key.load(std::memory_order_acquire);
+            if (entry_key == key) return entry.value.load(std::memory_order_acquire);
+            if (entry_key == nullptr) return nullptr;
+        }
+    }
+
+    // Returns the value of key, or inserts the one returned by create(). create() runs with the insertion lock held, so the
+    // value is fully set up before other threads can find it.
+    template <typename Create>
+    T *findOrInsert(const void *key, Create create) {
+        T *value = find(key);
+        if (value != nullptr) return value;
+        std::lock_guard<std::mutex> lock(write_mutex);
+        value = find(key);
+        if (value != nullptr) return value;
+        value = create();
+        insert(key, value);
+        return value;
+    }
+
+    // Removes key and returns its value, or nullptr if it wasn't in the map. Deleting the value is up to the caller.
+    T *erase(const void *key) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Slots *current = slots.load(std::memory_order_relaxed);
+        if (current == nullptr) return nullptr;
+        for (size_t i = hash(key) & current->mask;; i = (i + 1) & current->mask) {
+            Entry &entry = current->entries[i];
+            const void *entry_key = entry.key.load(std::memory_order_relaxed);
+            if (entry_key == key) {
+                entry.key.store(tombstone(), std::memory_order_release);
+                --count;
+                reclaim();
+                return entry.value.exchange(nullptr, std::memory_order_relaxed);
+            }
+            if (entry_key == nullptr) return nullptr;
+        }
+    }
+
+   private:
+    static constexpr size_t kInitialCapacity = 16;
+
+    struct Entry {
+        std::atomic<const void *> key{nullptr};
+        std::atomic<T *> value{nullptr};
+    };
+
+    struct Slots {
+        explicit Slots(size_t capacity) : mask(capacity - 1), entries(new Entry[capacity]) {}
+        const size_t mask;
+        const std::unique_ptr<Entry[]> entries;
+    };
+
+    // Slots to free once no thread probes in retire_epoch or before.
+    struct Retired {
+        uint64_t retire_epoch;
+        std::unique_ptr<Slots> slots;
+    };
+
+    // Marks erased slots, it is never a dispatch key
+    static const void *tombstone() {
+        static const char marker = 0;
+        return &marker;
+    }
+
+    static size_t hash(const void *key) {
+        // Dispatch keys are pointers to the loader's dispatch tables, their low bits are always the same
+        const uint64_t bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key)) >> 4;
+        return static_cast<size_t>((bits * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    // Called with write_mutex held
+    void insert(const void *key, T *value) {
+        Slots *current = slots.load(std::memory_order_relaxed);
+        // Keep the slots at most half used, counting tombstones, so probes stay short
+        if (current == nullptr || (used + 1) * 2 > current->mask + 1) {
+            current = grow(current);
+            reclaim();
+        }
+        for (size_t i = hash(key) & current->mask;; i = (i + 1) & current->mask) {
+            Entry &entry = current->entries[i];
+            const void *entry_key = entry.key.load(std::memory_order_relaxed);
+            if (entry_key == nullptr || entry_key == tombstone()) {
+                if (entry_key == nullptr) ++used;
+                ++count;
+                // Publish the value before the key, readers load them in the opposite order
+                entry.value.store(value, std::memory_order_relaxed);
+                entry.key.store(key, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    // Called with write_mutex held. Copies the live entries to a new array, leaving the tombstones behind.
+    Slots *grow(const Slots *current) {
+        size_t capacity = kInitialCapacity;
+        while (capacity < (count + 1) * 4) {
+            capacity *= 2;
+        }
+        auto next_slots = std::make_unique<Slots>(capacity);
+        Slots *next = next_slots.get();
+        used = 0;
+        if (current != nullptr) {
+            for (size_t i = 0; i <= current->mask; ++i) {
+                const void *key = current->entries[i].key.load(std::memory_order_relaxed);
+                if (key == nullptr || key == tombstone()) continue;
+                for (size_t j = hash(key) & next->mask;; j = (j + 1) & next->mask) {
+                    if (next->entries[j].key.load(std::memory_order_relaxed) == nullptr) {
+                        next->entries[j].value.store(current->entries[i].value.load(std::memory_order_relaxed),
+                                                     std::memory_order_relaxed);
+                        next->entries[j].key.store(key, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+                ++used;
+            }
+        }
+        slots.store(next, std::memory_order_release);
+        std::unique_ptr<Slots> previous = std::move(current_slots);
+        current_slots = std::move(next_slots);
+        if (previous) {
+            retired_slots.push_back({DispatchKeyEpochs::retire(), std::move(previous)});
+        }
+        return next;
+    }
+
+    // Called with write_mutex held. Frees the retired slots no thread can still be probing.
+    void reclaim() {
+        if (retired_slots.empty()) {
+            return;
+        }
+        const uint64_t oldest = DispatchKeyEpochs::oldestProbed();
+        retired_slots.erase(std::remove_if(retired_slots.begin(), retired_slots.end(),
+                                           [oldest](const Retired &retired) { return retired.retire_epoch < oldest; }),
+                            retired_slots.end());
+    }
+
+    std::atomic<Slots *> slots{nullptr};
+    std::mutex write_mutex;
+    std::unique_ptr<Slots> current_slots;
+    // Previous arrays, until no thread can be probing them
+    std::vector<Retired> retired_slots;
+    // Live entries, and slots that are live or tombstones, in the current array
+    size_t count = 0;
+    size_t used = 0;
+};
+
+typedef DispatchKeyMap<VkuDeviceDispatchTable> device_table_map;
+typedef DispatchKeyMap<VkuInstanceDispatchTable> instance_table_map;
 VkuDeviceDispatchTable *initDeviceTable(VkDevice device, const PFN_vkGetDeviceProcAddr gpa, device_table_map &map);
 VkuDeviceDispatchTable *initDeviceTable(VkDevice device, const PFN_vkGetDeviceProcAddr gpa);
 VkuInstanceDispatchTable *initInstanceTable(VkInstance instance, const PFN_vkGetInstanceProcAddr gpa, instance_table_map &map);
@@ -52,21 +309,10 @@ void destroy_instance_dispatch_table(dispatch_key key);
 void destroy_dispatch_table(device_table_map &map, dispatch_key key);
 void destroy_dispatch_table(instance_table_map &map, dispatch_key key);
 
-// For the given data key, look up the layer_data instance from given layer_data_map
+// For the given data key, look up the layer_data instance from given layer_data_map, creating it on first use
 template <typename DATA_T>
-DATA_T *GetLayerDataPtr(void *data_key, std::unordered_map<void *, DATA_T *> &layer_data_map) {
-    DATA_T *debug_data;
-    /* TODO: We probably should lock here, or have caller lock */
-    auto got = layer_data_map.find(data_key);
-
-    if (got == layer_data_map.end()) {
-        debug_data = new DATA_T;
-        layer_data_map[(void *)data_key] = debug_data;
-    } else {
-        debug_data = got->second;
-    }
-
-    return debug_data;
+DATA_T *GetLayerDataPtr(void *data_key, DispatchKeyMap<DATA_T> &layer_data_map) {
+    return layer_data_map.findOrInsert(data_key, [] { return new DATA_T; });
 }
 
 inline VkResult util_GetExtensionProperties(const uint32_t count, const VkExtensionProperties *layer_extensions, uint32_t *pCount,
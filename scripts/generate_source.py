@@ -77,6 +77,14 @@ def RunGenerators(api: str, registry: str, video_registry: str, directory: str,
             'generator' : ApiDumpGenerator,
             'genCombined': True,
         },
+        'api_dump_capture.h' : {
+            'generator' : ApiDumpGenerator,
+            'genCombined': True,
+        },
+        'api_dump_decode.h' : {
+            'generator' : ApiDumpGenerator,
+            'genCombined': True,
+        },
     }
 
     unknownTargets = [x for x in (targetFilter if targetFilter else []) if x not in generators.keys()]
@@ -17,6 +17,8 @@
 # limitations under the License.
 #
 
+import re
+
 from base_generator import BaseGenerator
 from vulkan_object import Struct, Command
 
@@ -26,17 +28,51 @@ TRACKED_STATE = {
             'ApiDumpInstance::current().addCmdBuffers(\n' +
                 'device,\n' +
                 'pAllocateInfo->commandPool,\n' +
-                'std::vector<VkCommandBuffer>(pCommandBuffers, pCommandBuffers + pAllocateInfo->commandBufferCount),\n' +
+                'pAllocateInfo->commandBufferCount,\n' +
+                'pCommandBuffers,\n' +
                 'pAllocateInfo->level\n'
             ');',
     'vkDestroyCommandPool':
         'ApiDumpInstance::current().eraseCmdBufferPool(device, commandPool);'
     ,
     'vkFreeCommandBuffers':
-        'ApiDumpInstance::current().eraseCmdBuffers(device, commandPool, std::vector<VkCommandBuffer>(pCommandBuffers, pCommandBuffers + commandBufferCount));'
+        'ApiDumpInstance::current().eraseCmdBuffers(device, commandPool, commandBufferCount, pCommandBuffers);'
+    ,
+    'vkCreateShaderModule':
+        'if(result == VK_SUCCESS)\n' +
+            'ApiDumpInstance::current().pipelineProfile().addShaderModule(*pShaderModule, pCreateInfo);'
+    ,
+    'vkDestroyShaderModule':
+        'ApiDumpInstance::current().pipelineProfile().eraseShaderModule(shaderModule);'
+    ,
+    'vkDestroyPipeline':
+        'ApiDumpInstance::current().pipelineProfile().erasePipeline(pipeline, ApiDumpInstance::current().object_names());'
+    ,
+    'vkDestroyDevice':
+        'ApiDumpInstance::current().pipelineProfile().eraseDevice(device);'
+    ,
+    'vkDestroyInstance':
+        'ApiDumpInstance::current().pipelineProfile().eraseInstance(instance);'
     ,
 }
 
+# Functions creating pipelines, which pipeline_profile times, and the type of their create infos. The next layer is called with
+# the create infos ApiDumpPipelineCreation returns, which may have a VkPipelineCreationFeedbackCreateInfo of the layer's chained.
+# Ray tracing pipelines created with a deferred operation aren't timed.
+PIPELINE_PROFILE = {
+    'vkCreateGraphicsPipelines': ('VkGraphicsPipelineCreateInfo', ''),
+    'vkCreateComputePipelines': ('VkComputePipelineCreateInfo', ''),
+    'vkCreateRayTracingPipelinesKHR': ('VkRayTracingPipelineCreateInfoKHR', ', deferredOperation != VK_NULL_HANDLE'),
+}
+
+OUTPUT_FORMATS = ['Text', 'Html', 'Json', 'Binary', 'Trace']
+
+# Combinations of the ApiDumpFeatures settings that get wrappers of their own for each output format, where the settings are
+# constants. Every combination adds a copy of the wrappers and of the functions dumping their parameters to the layer, so none
+# are specialized until api_dump_features_benchmark shows a clear win on the full registry. The wrappers read the settings.
+SPECIALIZED_FEATURES = {
+}
+
 PARAMETER_STATE = {
     'pDynamicState': {
         'VkGraphicsPipelineCreateInfo':
@@ -212,6 +248,13 @@ NON_TEMPLATEDTED_FUNCTIONS = ['vkGetInstanceProcAddr',
                               'vkEnumerateDeviceLayerProperties',
                               'vkEnumerateDeviceExtensionProperties']
 
+# Functions vkGetInstanceProcAddr and vkGetDeviceProcAddr return even when include_functions or exclude_functions filter them out,
+# because the layer keeps state from them. Only their output is left out.
+INTERCEPTED_FUNCTIONS = HANDWRITTEN_FUNCTIONS + list(TRACKED_STATE) + list(PIPELINE_PROFILE) + [
+    'vkEnumeratePhysicalDevices', 'vkQueuePresentKHR', 'vkDebugMarkerSetObjectNameEXT',
+    'vkSetDebugUtilsObjectNameEXT', 'vkGetPhysicalDeviceToolPropertiesEXT'
+]
+
 BLOCKING_API_CALLS = [
     'vkWaitForFences', 'vkWaitSemaphores', 'vkQueuePresentKHR', 'vkDeviceWaitIdle',
     'vkQueueWaitIdle', 'vkAcquireNextImageKHR', 'vkGetQueryPoolResults', 'vkWaitSemaphoresKHR'
@@ -247,6 +290,12 @@ def command_param_declaration_text(command : Command):
 def command_param_usage_text(command : Command):
     return ', '.join(p.name for p in command.params)
 
+# The guard and the dump context of a generated function. Output of the functions intercepted despite the function filter is
+# left out here. The context holds the state PARAMETER_STATE stashes and VALIDITY_CHECKS reads back for the call.
+def record_guard_text(command : Command):
+    return (f'ApiDumpRecordGuard lg(ApiDumpInstance::current(), ApiDumpFunctionId::{command.name});\n'
+            'ApiDumpCallContext call_context;')
+
 def get_fulltype(var):
     custom_fullType = var.fullType
     if ':' in var.cDeclaration:
@@ -304,6 +353,15 @@ def get_array_length(var, parent):
     else:
         return deref + '*'.join(var.length.split(','))
 
+# The type given to dump_type, which doesn't need the const of values
+def get_value_type(type_name):
+    if type_name.startswith('const ') and '*' not in type_name:
+        return type_name[len('const '):]
+    return type_name
+
+# Count types the struct tables read straight from the structure
+TABLE_COUNT_TYPES = ['uint8_t', 'uint16_t', 'uint32_t', 'uint64_t', 'size_t', 'VkDeviceSize']
+
 def get_fixed_array_length(fixed_length, var, parent):
     lengthIsMember = False
     for local in [x for x in (parent.params if isinstance(parent, Command) else parent.members)]:
@@ -328,6 +386,9 @@ class ApiDumpGenerator(BaseGenerator):
         self.return_types = set()
         self.vulkan_defined_types = set()
         self.only_use_as_pointer_types = set()
+        self.capture_slots = {}
+        self.value_functions = {}
+        self.value_function_names = set()
 
     def generate(self):
         self.build_return_types()
@@ -339,6 +400,10 @@ class ApiDumpGenerator(BaseGenerator):
             self.generate_dispatch_codegen()
         elif self.filename == 'api_dump_implementation.h':
             self.generate_implementation()
+        elif self.filename == 'api_dump_capture.h':
+            self.generate_capture()
+        elif self.filename == 'api_dump_decode.h':
+            self.generate_decode()
 
 
     def generate_copyright(self):
@@ -378,17 +443,17 @@ class ApiDumpGenerator(BaseGenerator):
             if command.name in HANDWRITTEN_FUNCTIONS:
                 continue
             protect.add_guard(self, command.protect)
-            self.write('template<ApiDumpFormat Format>')
+            self.write('template<ApiDumpFormat Format, ApiDumpFeatures Features>')
             self.write(f'VKAPI_ATTR {command.returnType} VKAPI_CALL {command.name}({command_param_declaration_text(command)})')
             self.write('{')
             if command.name not in BLOCKING_API_CALLS:
                 self.write(f'''
-                    std::lock_guard<std::mutex> lg(ApiDumpInstance::current().outputMutex());
-                    dump_function_head(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");
+                    {record_guard_text(command)}
+                    dump_function_head<Features>(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");
                      if constexpr (Format == ApiDumpFormat::Text) {{
-                        if(ApiDumpInstance::current().settings().shouldPreDump() && ApiDumpInstance::current().shouldDumpOutput()) {{
-                            dump_before_pre_dump_formatting<Format>(ApiDumpInstance::current().settings());
-                            dump_params_{command.name}<Format>(ApiDumpInstance::current(), {command_param_usage_text(command)});
+                        if(ApiDumpInstance::current().settings().shouldPreDump<Features>() && ApiDumpInstance::current().shouldDumpOutput()) {{
+                            dump_before_pre_dump_formatting<Format, Features>(ApiDumpInstance::current().settings());
+                            dump_params_{command.name}<Format, Features>(ApiDumpInstance::current(), {command_param_usage_text(command)});
                         }}
                     }}''')
 
@@ -413,10 +478,12 @@ class ApiDumpGenerator(BaseGenerator):
                 self.write('auto dispatch_key = get_dispatch_key(instance);')
 
             return_str = f'{command.returnType} result = ' if command.returnType != 'void' else ''
+            self.write(f'ApiDumpCallTimer call_timer(ApiDumpInstance::current(), ApiDumpFunctionId::{command.name});')
             self.write(f'{return_str}instance_dispatch_table({command.params[0].name})->{command.name[2:]}({command_param_usage_text(command)});')
+            self.write('call_timer.stop();')
             if command.name in BLOCKING_API_CALLS:
-                self.write('std::lock_guard<std::mutex> lg(ApiDumpInstance::current().outputMutex());')
-                self.write(f'dump_function_head(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");')
+                self.write(record_guard_text(command))
+                self.write(f'dump_function_head<Features>(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");')
 
             if command.name in TRACKED_STATE:
                 self.write(TRACKED_STATE[command.name])
@@ -441,14 +508,19 @@ class ApiDumpGenerator(BaseGenerator):
             self.write('if (ApiDumpInstance::current().shouldDumpOutput()) {')
             if command.returnType != 'void':
                 if self.get_unaliased_type(command.returnType) in self.vulkan_defined_types:
-                    self.write(f'dump_return_value<Format>(ApiDumpInstance::current().settings(), "{command.returnType}", result, dump_return_value_{command.returnType}<Format>);')
+                    self.write(f'dump_return_value<Format, Features>(ApiDumpInstance::current().settings(), "{command.returnType}", result, dump_return_value_{command.returnType}<Format>);')
                 else:
-                    self.write(f'dump_return_value<Format>(ApiDumpInstance::current().settings(), "{command.returnType}", result);')
-            self.write(f'''dump_pre_function_formatting<Format>(ApiDumpInstance::current().settings());
-                dump_params_{command.name}<Format>(ApiDumpInstance::current(), {command_param_usage_text(command)});
+                    self.write(f'dump_return_value<Format, Features>(ApiDumpInstance::current().settings(), "{command.returnType}", result);')
+            self.write(f'''dump_pre_function_formatting<Format, Features>(ApiDumpInstance::current().settings());
+                dump_params_{command.name}<Format, Features>(ApiDumpInstance::current(), {command_param_usage_text(command)});
                 dump_post_function_formatting<Format>(ApiDumpInstance::current().settings());
                 flush(ApiDumpInstance::current().settings());
             }}''')
+            erase_object_names = self.erase_object_names_text(command, 'ApiDumpInstance::current()')
+            if erase_object_names:
+                self.write(erase_object_names)
+            if command.name == 'vkDestroyInstance':
+                self.write('ApiDumpInstance::current().drainOutput();')
             if command.returnType != 'void':
                 self.write('return result;')
             self.write('}')
@@ -462,28 +534,37 @@ class ApiDumpGenerator(BaseGenerator):
 
             protect.add_guard(self, command.protect)
 
-            self.write('template<ApiDumpFormat Format>')
+            self.write('template<ApiDumpFormat Format, ApiDumpFeatures Features>')
             self.write(f'VKAPI_ATTR {command.returnType} VKAPI_CALL {command.name}({command_param_declaration_text(command)})')
             self.write('{')
 
             if command.name not in BLOCKING_API_CALLS:
-                self.write('std::lock_guard<std::mutex> lg(ApiDumpInstance::current().outputMutex());')
+                self.write(record_guard_text(command))
                 if command.name in ['vkDebugMarkerSetObjectNameEXT', 'vkSetDebugUtilsObjectNameEXT']:
                     self.write('ApiDumpInstance::current().update_object_name_map(pNameInfo);')
                 self.write(f'''
-                    dump_function_head(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");
+                    dump_function_head<Features>(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");
                     if constexpr (Format == ApiDumpFormat::Text) {{
-                        if(ApiDumpInstance::current().settings().shouldPreDump() && ApiDumpInstance::current().shouldDumpOutput()) {{
-                            dump_before_pre_dump_formatting<Format>(ApiDumpInstance::current().settings());
-                            dump_params_{command.name}<Format>(ApiDumpInstance::current(), {command_param_usage_text(command)});
+                        if(ApiDumpInstance::current().settings().shouldPreDump<Features>() && ApiDumpInstance::current().shouldDumpOutput()) {{
+                            dump_before_pre_dump_formatting<Format, Features>(ApiDumpInstance::current().settings());
+                            dump_params_{command.name}<Format, Features>(ApiDumpInstance::current(), {command_param_usage_text(command)});
                         }}
                     }}''')
 
             return_str = f'{command.returnType} result = ' if command.returnType != 'void' else ''
-            self.write(f'{return_str}device_dispatch_table({command.params[0].name})->{command.name[2:]}({command_param_usage_text(command)});')
+            call_params = command_param_usage_text(command)
+            if command.name in PIPELINE_PROFILE:
+                create_info_type, deferred = PIPELINE_PROFILE[command.name]
+                self.write(f'ApiDumpPipelineCreation<{create_info_type}> pipeline_creation(ApiDumpInstance::current().pipelineProfile(), "{command.name}", device, createInfoCount, pCreateInfos{deferred});')
+                call_params = ', '.join('pipeline_creation.createInfos()' if p.name == 'pCreateInfos' else p.name for p in command.params)
+            self.write(f'ApiDumpCallTimer call_timer(ApiDumpInstance::current(), ApiDumpFunctionId::{command.name});')
+            self.write(f'{return_str}device_dispatch_table({command.params[0].name})->{command.name[2:]}({call_params});')
+            self.write('call_timer.stop();')
+            if command.name in PIPELINE_PROFILE:
+                self.write('pipeline_creation.end(pPipelines);')
             if command.name in BLOCKING_API_CALLS:
-                self.write('std::lock_guard<std::mutex> lg(ApiDumpInstance::current().outputMutex());')
-                self.write(f'dump_function_head(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");')
+                self.write(record_guard_text(command))
+                self.write(f'dump_function_head<Features>(ApiDumpInstance::current(), "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}");')
 
             if command.name in TRACKED_STATE:
                 self.write('' + TRACKED_STATE[command.name])
@@ -495,16 +576,21 @@ class ApiDumpGenerator(BaseGenerator):
             if command.returnType != 'void':
                 return_type = self.get_unaliased_type(command.returnType)
                 if return_type in self.vulkan_defined_types or return_type == 'VkDeviceAddress':
-                    self.write(f'dump_return_value<Format>(ApiDumpInstance::current().settings(), "{command.returnType}", result, dump_return_value_{command.returnType}<Format>);')
+                    self.write(f'dump_return_value<Format, Features>(ApiDumpInstance::current().settings(), "{command.returnType}", result, dump_return_value_{command.returnType}<Format>);')
                 else:
-                    self.write(f'dump_return_value<Format>(ApiDumpInstance::current().settings(), "{command.returnType}", result);')
+                    self.write(f'dump_return_value<Format, Features>(ApiDumpInstance::current().settings(), "{command.returnType}", result);')
 
-            self.write(f'''dump_pre_function_formatting<Format>(ApiDumpInstance::current().settings());
-                dump_params_{command.name}<Format>(ApiDumpInstance::current(), {command_param_usage_text(command)});
-                dump_post_function_formatting<Format>(ApiDumpInstance::current().settings());
-                flush(ApiDumpInstance::current().settings());
-            }}''')
+            self.write(f'''dump_pre_function_formatting<Format, Features>(ApiDumpInstance::current().settings());
+                dump_params_{command.name}<Format, Features>(ApiDumpInstance::current(), {command_param_usage_text(command)});
+                dump_post_function_formatting<Format>(ApiDumpInstance::current().settings());''')
+            if command.name == 'vkQueuePresentKHR':
+                self.write('dump_frame_end_marker<Format>(ApiDumpInstance::current());')
+            self.write('''flush(ApiDumpInstance::current().settings());
+            }''')
 
+            erase_object_names = self.erase_object_names_text(command, 'ApiDumpInstance::current()')
+            if erase_object_names:
+                self.write(erase_object_names)
             if command.name == 'vkQueuePresentKHR':
                 self.write('ApiDumpInstance::current().nextFrame();')
             if command.returnType != 'void':
@@ -512,36 +598,63 @@ class ApiDumpGenerator(BaseGenerator):
             self.write('}')
         protect.add_guard(self, None)
 
-        self.write('\ntemplate<ApiDumpFormat Format>')
-        self.write('VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL api_dump_known_instance_functions(VkInstance instance, const char* pName)')
-        self.write('{\n')
+        # Commands returned by vkGetInstanceProcAddr and vkGetDeviceProcAddr, sorted by name to be binary searched
+        lookup_commands = {}
         for command in self.vk.commands.values():
             if command.name in ['vkEnumerateDeviceExtensionProperties', 'vkEnumerateInstanceVersion'] or (command.device and 'VK_EXT_debug_utils' not in command.extensions):
                 continue
+            lookup_commands[command.name] = [command, True, False]
+        for command in [x for x in self.vk.commands.values() if x.device ]:
+            lookup_commands.setdefault(command.name, [command, False, False])[2] = True
+
+        self.write('\ntemplate<ApiDumpFormat Format, ApiDumpFeatures Features>')
+        self.write('const ApiDumpCommand* api_dump_find_command(const char* pName)')
+        self.write('{')
+        self.write('static const ApiDumpCommand commands[] = {')
+        for name in sorted(lookup_commands):
+            command, instance, device = lookup_commands[name]
             protect.add_guard(self, command.protect)
-            self.write(f'if(strcmp(pName, "{command.name}") == 0)')
-            if command.name in NON_TEMPLATEDTED_FUNCTIONS:
-                self.write(f'return reinterpret_cast<PFN_vkVoidFunction>({command.name});')
-            else:
-                self.write(f'return reinterpret_cast<PFN_vkVoidFunction>({command.name}<Format>);')
+            function = command.name if command.name in NON_TEMPLATEDTED_FUNCTIONS else f'{command.name}<Format, Features>'
+            table_offset = f'offsetof(VkuDeviceDispatchTable, {command.name[2:]})' if device else '0'
+            # Destroyed objects lose their name even when the function filter leaves the command out
+            intercepted = command.name in INTERCEPTED_FUNCTIONS or self.erase_object_names_text(command, '')
+            always_intercepted = ', true' if intercepted else ''
+            self.write(f'{{"{command.name}", reinterpret_cast<PFN_vkVoidFunction>({function}), {str(instance).lower()}, {str(device).lower()}, {table_offset}{always_intercepted}}},')
         protect.add_guard(self, None)
-        self.write('\n    return nullptr;')
+        self.write('};')
+        self.write('return find_api_dump_command(commands, pName);')
         self.write('}')
 
-        self.write('\ntemplate<ApiDumpFormat Format>')
-        self.write('VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL api_dump_known_device_functions(VkDevice device, const char* pName)')
-        self.write('{\n')
-        for command in [x for x in self.vk.commands.values() if x.device ]:
-            protect.add_guard(self, command.protect)
-            self.write(f'if(strcmp(pName, "{command.name}") == 0 && (!device || device_dispatch_table(device)->{command.name[2:]}))')
-            if command.name in NON_TEMPLATEDTED_FUNCTIONS:
-                self.write(f'return reinterpret_cast<PFN_vkVoidFunction>({command.name});')
-            else:
-                self.write(f'return reinterpret_cast<PFN_vkVoidFunction>({command.name}<Format>);')
-        protect.add_guard(self, None)
+        # The wrappers of the common combinations of settings, and the ones that read the settings for the others
+        self.write('''
+// The commands of the wrappers specialized for the format and the features of the settings, or of the ones that read the
+// features from the settings when none were.
+inline const ApiDumpCommand* api_dump_find_command(const ApiDumpSettings& settings, const char* pName)
+{
+    switch (settings.format()) {''')
+        for output_format in OUTPUT_FORMATS:
+            self.write(f'case ApiDumpFormat::{output_format}:')
+            for features in SPECIALIZED_FEATURES.get(output_format, []):
+                condition = f'({features})' if '|' in features else features
+                self.write(f'if (settings.features() == {condition}) return api_dump_find_command<ApiDumpFormat::{output_format}, {features}>(pName);')
+            self.write(f'return api_dump_find_command<ApiDumpFormat::{output_format}, kApiDumpFeaturesRuntime>(pName);')
+        self.write('''}
+    return nullptr;
+}
 
-        self.write('\n    return nullptr;')
-        self.write('}')
+template<ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL api_dump_known_instance_functions(VkInstance instance, const char* pName)
+{
+    const ApiDumpCommand* command = api_dump_find_command<Format, Features>(pName);
+    return command && command->instance && command->intercepted() ? command->function : nullptr;
+}
+
+template<ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL api_dump_known_device_functions(VkDevice device, const char* pName)
+{
+    const ApiDumpCommand* command = api_dump_find_command<Format, Features>(pName);
+    return command && command->device && (!device || command->availableOn(device)) && command->intercepted() ? command->function : nullptr;
+}''')
 
     def generate_enums(self, enums, protect):
         for enum in enums.values():
@@ -551,10 +664,10 @@ class ApiDumpGenerator(BaseGenerator):
                 self.write(f'void dump_return_value_{enum.name}(const {enum.name}& object, const ApiDumpSettings& settings) {{')
                 self.write_enum_contents(enum)
                 self.write('}')
-            self.write('template <ApiDumpFormat Format>')
+            self.write('template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>')
             self.write(f'void dump_{enum.name}(const {enum.name} object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr)')
             self.write('{')
-            self.write('dump_start<Format>(settings, OutputConstruct::value, type_name, var_name, indents, address);')
+            self.write('dump_start<Format, Features>(settings, OutputConstruct::value, type_name, var_name, indents, address);')
             if enum.name in self.return_types:
                 self.write(f'dump_return_value_{enum.name}<Format>(object, settings);')
             else:
@@ -563,14 +676,262 @@ class ApiDumpGenerator(BaseGenerator):
             self.write('}')
         protect.add_guard(self, None)
 
+    # Returns how the struct table dumps var, mirroring write_value(), or None if the structure needs a dump function of its own.
+    # The value function is a (function, type) pair, the function dumping a value of that type.
+    def get_table_member(self, var, parent):
+        custom_type = get_type(var)
+        call_type = self.get_unaliased_type(var.type)
+        # Bit fields have no offset
+        if ':' in var.cDeclaration:
+            return None
+
+        member = {'count': None, 'columns': None}
+        if self.get_is_array(var):
+            element_function = f'dump_type<Format, Features, {get_value_type(custom_type)}>'
+            element_type = custom_type if '*' in custom_type else var.type
+            if var.type == 'char':
+                element_function = 'dump_char<Format, Features>'
+            if custom_type == 'uint8_t':
+                element_function = 'dump_type<Format, Features, uint32_t>'
+            elif custom_type == 'int8_t':
+                element_function = 'dump_type<Format, Features, int32_t>'
+            elif call_type in self.vulkan_defined_types:
+                element_function = f'dump_{call_type}<Format, Features>'
+                if '*' not in custom_type:
+                    element_type = call_type
+
+            if parent.name in ['VkShaderModuleCreateInfo', 'VkShaderCreateInfoEXT'] and var.name == 'pCode':
+                member['kind'] = 'spirv'
+                member['count'] = f'object.{var.length}'
+                member['value'] = None
+                return member
+            elif len(var.fixedSizeArray) > 2:
+                raise RuntimeError("Unhandled fixed array dimentionality")
+            elif len(var.fixedSizeArray) == 2:
+                member['kind'] = 'double_fixed_array'
+                member['count'] = var.fixedSizeArray[0]
+                member['columns'] = var.fixedSizeArray[1]
+            elif len(var.fixedSizeArray) == 1:
+                member['kind'] = 'fixed_array'
+                member['count'] = get_fixed_array_length(var.fixedSizeArray[0], var, parent)
+            else:
+                member['count'] = get_array_length(var, parent)
+                if var.fullType.count('*') > 1 and var.type not in ['void', 'char'] and (call_type in self.vulkan_defined_types):
+                    member['kind'] = 'double_pointer_array'
+                    element_type = call_type
+                else:
+                    member['kind'] = 'pointer_array'
+            member['value'] = (element_function, element_type)
+            return member
+
+        if var.pointer and var.type not in self.only_use_as_pointer_types and var.type not in self.vk.funcPointers.keys() and var.type not in ['void', 'char'] and not (var.name == 'pNext' and var.fullType in ['void*', 'const void*']):
+            if var.fullType.count('*') > 1:
+                return None
+            member['kind'] = 'pointer'
+            if call_type in self.vulkan_defined_types:
+                member['value'] = (f'dump_{call_type}<Format, Features>', call_type)
+            else:
+                member['value'] = (f'dump_type<Format, Features, {get_value_type(custom_type)}>', var.type)
+            return member
+
+        # Fixed length arrays without a length are passed whole to their dump function
+        if len(var.fixedSizeArray) > 0 and var.type != 'char':
+            return None
+        member['kind'] = 'value'
+        value_type = var.fullType
+        value_function = f'dump_type<Format, Features, {get_value_type(var.fullType)}>'
+        if var.name == 'apiVersion':
+            value_function = 'dump_api_version<Format, Features>'
+        elif var.name == 'pNext' and var.fullType in ['void*', 'const void*']:
+            member['kind'] = 'pNext'
+            value_function = 'dump_pNext<Format, Features>'
+            value_type = 'const void*'
+        elif var.type == 'char':
+            value_function = 'dump_char<Format, Features>'
+            if len(var.fixedSizeArray) > 0:
+                value_type = 'char[]'
+        elif var.fullType == 'VkDeviceAddress':
+            value_function = f'dump_type_hex<Format, Features, {var.fullType}>'
+        elif var.fullType == 'uint8_t':
+            value_function = 'dump_type<Format, Features, uint32_t>'
+        elif var.fullType == 'int8_t':
+            value_function = 'dump_type<Format, Features, int32_t>'
+        elif call_type in self.vulkan_defined_types:
+            if var.pointer:
+                return None
+            value_function = f'dump_{call_type}<Format, Features>'
+            value_type = call_type
+        elif var.type in TREAT_AS_POINTERS and TREAT_AS_POINTERS[var.type] == var.name:
+            value_function = 'dump_uint64_t_as_pointer<Format, Features>'
+        member['value'] = (value_function, value_type)
+        return member
+
+    def struct_uses_table(self, struct):
+        if len(struct.members) == 0:
+            return False
+        for member in struct.members:
+            if self.get_table_member(member, struct) is None:
+                return False
+            # Only the pNext chains of void pointers are dumped after the other members
+            if member.pointer and member.name == 'pNext' and struct.name not in ['VkBaseInStructure', 'VkBaseOutStructure']:
+                if member.fullType not in ['void*', 'const void*']:
+                    return False
+        return True
+
+    # Numbers the functions dumping the values of the members of the structures described by tables, which are shared by all of
+    # them. A function is left out of the platforms without the structures using it.
+    def build_value_functions(self):
+        self.value_functions = {}
+        self.value_function_names = set()
+        for struct in list(self.vk.videoStd.structs.values()) + list(self.vk.structs.values()):
+            if not self.struct_uses_table(struct):
+                continue
+            for member in struct.members:
+                value = self.get_table_member(member, struct)['value']
+                if value is None:
+                    continue
+                if value not in self.value_functions:
+                    function, value_type = value
+                    if value_type == 'char[]':
+                        name = 'char_array'
+                    elif value_type == 'const char*':
+                        name = 'string'
+                    elif function.startswith('dump_pNext'):
+                        name = 'pNext'
+                    else:
+                        name = re.sub(r'\W', '_', value_type.replace('*', '_pointer')).strip('_')
+                        dumped_type = function[function.find('<') + len('<Format, Features'):-1].lstrip(', ')
+                        if function.startswith('dump_type_hex'):
+                            name += '_hex'
+                        elif function.startswith('dump_api_version'):
+                            name += '_api_version'
+                        elif function.startswith('dump_uint64_t_as_pointer'):
+                            name += '_as_pointer'
+                        elif function.startswith('dump_type') and dumped_type != get_value_type(value_type):
+                            name += '_as_' + re.sub(r'\W', '_', dumped_type)
+                    while name in self.value_function_names:
+                        name += '_'
+                    self.value_function_names.add(name)
+                    self.value_functions[value] = {'name': f'kApiDumpValue_{name}', 'protects': set()}
+                self.value_functions[value]['protects'].add(struct.protect)
+
+        self.write('enum ApiDumpValueFunctionId : uint16_t {')
+        for value_function in self.value_functions.values():
+            self.write(f'{value_function["name"]},')
+        self.write('};')
+
+    def generate_value_functions(self):
+        self.write('''
+            template <ApiDumpFormat Format, ApiDumpFeatures Features>
+            const ApiDumpValueFunction *api_dump_value_functions() {
+                static constexpr ApiDumpValueFunction value_functions[] = {''')
+        for (function, value_type), value_function in self.value_functions.items():
+            # Only the platforms of the structs that use a function have its types, unless a core struct uses it too
+            protects = value_function['protects']
+            protect = None if None in protects else sorted(protects)
+            if value_type == 'char[]':
+                value = 'static_cast<const char*>(object)'
+            else:
+                value = f'*static_cast<{value_type} const*>(object)'
+            has_address = not function.startswith('dump_pNext') and not function.startswith('dump_uint64_t_as_pointer')
+            if protect is not None:
+                self.write('#if ' + ' || '.join(f'defined({p})' for p in protect))
+            self.write(f'''[](const void* object, const ApiDumpSettings& settings, const char* type_string, const char* name, int indents, const void*{" address" if has_address else ""}) {{
+                    {function}({value}, settings, type_string, name, indents{", address" if has_address else ""});
+                }},''')
+            if protect is not None:
+                self.write('#else')
+                self.write('nullptr,')
+                self.write(f'#endif  // {" || ".join(protect)}')
+        self.write('''};
+                return value_functions;
+            }''')
+
+    # Writes the functions the table of struct calls for the lengths, validity checks and parameter state that depend on more
+    # than one member, or on the state of the call.
+    def write_struct_hook(self, return_type, name, struct, body):
+        if re.search(r'\bobject\b', body):
+            self.write(f'inline {return_type} {name}(const void* pointer) {{')
+            self.write(f'const {struct.name}& object = *static_cast<const {struct.name}*>(pointer);')
+        else:
+            self.write(f'inline {return_type} {name}(const void*) {{')
+        self.write(body)
+        self.write('}')
+
+    def write_struct_table(self, struct):
+        parameter_state = ''
+        for member in struct.members:
+            validity_check = self.get_validity_check(member, struct)
+            state = self.get_parameter_state(member, struct)
+            if state is not None:
+                if validity_check is not None:
+                    parameter_state += f'if ({validity_check})\n'
+                parameter_state += state + '\n'
+        set_state = 'nullptr'
+        if parameter_state != '':
+            set_state = f'api_dump_state_{struct.name}'
+            self.write_struct_hook('void', set_state, struct, parameter_state)
+
+        entries = []
+        for member in struct.members:
+            table_member = self.get_table_member(member, struct)
+            kind = table_member['kind']
+            value = table_member['value']
+            element_type = 'nullptr'
+            element_size = ''
+            if kind == 'pNext':
+                element_type = f'"{member.type}"'
+            elif kind not in ['value', 'pointer', 'spirv']:
+                element_type = f'"{get_type(member)}"'
+                if kind != 'double_pointer_array':
+                    element_size = f', sizeof({value[1]})'
+            value_function = self.value_functions[value]['name'] if value is not None else '0'
+            entry = (f'ApiDumpMember{{"{member.name}", "{get_fulltype(member)}", {element_type}, offsetof({struct.name}, {member.name}), '
+                     f'ApiDumpMemberKind::{kind}, {value_function}{element_size}}}')
+
+            count = table_member['count']
+            if count is not None:
+                count_member = next((x for x in struct.members if f'object.{x.name}' == count), None)
+                if count_member is not None and not count_member.pointer and count_member.fullType in TABLE_COUNT_TYPES:
+                    entry += f'.withCountMember(offsetof({struct.name}, {count_member.name}), sizeof({count_member.fullType}))'
+                elif re.search(r'\bobject\b', count) or 'ApiDumpInstance' in count:
+                    hook = f'api_dump_count_{struct.name}_{member.name}'
+                    self.write_struct_hook('uint64_t', hook, struct, f'return {count};')
+                    entry += f'.withCountHook({hook})'
+                else:
+                    entry += f'.withCount({count})'
+            if table_member['columns'] is not None:
+                entry += f'.withColumns({table_member["columns"]})'
+            validity_check = self.get_validity_check(member, struct)
+            if validity_check is not None:
+                hook = f'api_dump_valid_{struct.name}_{member.name}'
+                self.write_struct_hook('bool', hook, struct, f'return {validity_check};')
+                entry += f'.validIf({hook})'
+            entries.append(entry)
+
+        self.write(f'inline constexpr ApiDumpMember kApiDumpMembers{struct.name}[] = {{')
+        for entry in entries:
+            self.write(f'{entry},')
+        self.write('};')
+        self.write(f'inline constexpr ApiDumpStructInfo kApiDumpStruct{struct.name}{{kApiDumpMembers{struct.name}, {len(entries)}, '
+                   f'OutputConstruct::{"api_union" if struct.union else "api_struct"}, {set_state}}};')
+
     def generate_structs(self, structs, protect):
         for struct in structs.values():
             protect.add_guard(self, struct.protect)
 
-            self.write('template <ApiDumpFormat Format>')
+            if self.struct_uses_table(struct):
+                self.write_struct_table(struct)
+                self.write('template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>')
+                self.write(f'void dump_{struct.name}(const {struct.name}& object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr) {{')
+                self.write(f'dump_struct<Format, Features>(kApiDumpStruct{struct.name}, &object, settings, type_name, var_name, indents, address);')
+                self.write('}')
+                continue
+
+            self.write('template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>')
             self.write(f'void dump_{struct.name}(const {struct.name}& object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr)')
             self.write('{')
-            self.write(f'dump_start<Format>(settings, OutputConstruct::{"api_union" if struct.union else "api_struct"}, type_name, var_name, indents, address);')
+            self.write(f'dump_start<Format, Features>(settings, OutputConstruct::{"api_union" if struct.union else "api_struct"}, type_name, var_name, indents, address);')
 
             for member in struct.members:
                 validity_check = self.get_validity_check(member, struct)
@@ -583,13 +944,20 @@ class ApiDumpGenerator(BaseGenerator):
                         self.write('' + parameter_state)
 
             self.write('')
+            # Unions leave out their inactive members, so whether a member follows another is only known once dumped
+            union_checks = struct.union and any(self.get_validity_check(member, struct) is not None for member in struct.members)
+            if union_checks:
+                self.write('bool separate = false;')
             for member in struct.members:
                 custom_fullType = get_fulltype(member)
                 validity_check = self.get_validity_check(member, struct)
-                if member != struct.members[0]:
+                if not union_checks and member != struct.members[0]:
                     self.write('dump_separate_members<Format>(settings);')
                 if validity_check is not None:
                     self.write(f'if({validity_check}) {{')
+                if union_checks:
+                    self.write('if (separate) dump_separate_members<Format>(settings);')
+                    self.write('separate = true;')
 
                 self.write_value(member, struct)
 
@@ -598,7 +966,7 @@ class ApiDumpGenerator(BaseGenerator):
                     if not struct.union: # Union's use validity_check to only print the active element
                         self.write(f'''}} else {{
                             if constexpr (Format == ApiDumpFormat::Text || Format == ApiDumpFormat::Html) {{
-                                dump_special<Format>("UNUSED", settings, "{custom_fullType}", "{member.name}", indents + 1);
+                                dump_special<Format, Features>("UNUSED", settings, "{custom_fullType}", "{member.name}", indents + 1);
                             }} else if constexpr (Format == ApiDumpFormat::Json) {{
                                 dump_json_UNUSED(settings, "{custom_fullType}", "{member.name}", indents + 2);
                             }}''')
@@ -608,7 +976,7 @@ class ApiDumpGenerator(BaseGenerator):
             for member in struct.members:
                 if member.pointer and member.name == 'pNext' and struct.name not in ['VkBaseInStructure', 'VkBaseOutStructure']:
                     self.write('if constexpr (Format == ApiDumpFormat::Text) {')
-                    self.write(f'    dump_pNext_trampoline<ApiDumpFormat::Text>(object.pNext, settings, "{member.fullType}", "{member.type}", indents < 2 ? indents + 1 : indents);')
+                    self.write(f'    dump_pNext_trampoline<ApiDumpFormat::Text, Features>(object.pNext, settings, "{member.fullType}", "{member.type}", indents < 2 ? indents + 1 : indents);')
                     self.write('}')
 
             self.write('dump_end<Format>(settings, OutputConstruct::api_struct, indents);')
@@ -619,6 +987,8 @@ class ApiDumpGenerator(BaseGenerator):
         self.write('#pragma once\n')
 
         self.write('\n#include "api_dump.h"')
+        self.write('#include "api_dump_capture.h"')
+        self.write('#include "api_dump_struct_table.h"')
 
         protect = PlatformGuardHelper()
 
@@ -629,9 +999,9 @@ class ApiDumpGenerator(BaseGenerator):
                 type_erase_handle = 'static_cast<void*>(object)'
             protect.add_guard(self, handle.protect)
             self.write(f'''
-                template <ApiDumpFormat Format>
+                template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
                 void dump_{handle.name}(const {handle.name}& object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr) {{
-                    dump_handle<Format>({type_erase_handle}, settings, type_name, var_name, indents, address);
+                    dump_handle<Format, Features>({type_erase_handle}, settings, type_name, var_name, indents, address);
                 }}''')
         protect.add_guard(self, None)
 
@@ -645,9 +1015,9 @@ class ApiDumpGenerator(BaseGenerator):
         for bitmask in self.vk.bitmasks.values():
             protect.add_guard(self, bitmask.protect)
             self.write(f'''
-                template <ApiDumpFormat Format>
+                template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
                 void dump_{bitmask.name}(const {bitmask.name} object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr) {{
-                    dump_start<Format>(settings, OutputConstruct::value, type_name, var_name, indents, address);
+                    dump_start<Format, Features>(settings, OutputConstruct::value, type_name, var_name, indents, address);
                     dump_value_start<Format>(settings);
                     settings.stream() << object;
                     bool is_first = true;''')
@@ -667,12 +1037,12 @@ class ApiDumpGenerator(BaseGenerator):
 
         for flag in self.vk.flags.values():
             protect.add_guard(self, flag.protect)
-            self.write('template <ApiDumpFormat Format>')
+            self.write('template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>')
             self.write(f'void dump_{flag.name}(const {flag.name} object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr) {{')
             if flag.bitmaskName is not None:
-                self.write(f'dump_{flag.bitmaskName}<Format>(static_cast<{flag.bitmaskName}>(object), settings, type_name, var_name, indents, address);')
+                self.write(f'dump_{flag.bitmaskName}<Format, Features>(static_cast<{flag.bitmaskName}>(object), settings, type_name, var_name, indents, address);')
             else:
-                self.write('dump_start<Format>(settings, OutputConstruct::value, type_name, var_name, indents, address);')
+                self.write('dump_start<Format, Features>(settings, OutputConstruct::value, type_name, var_name, indents, address);')
                 self.write('dump_value<Format>(settings, object);')
                 self.write('dump_end<Format>(settings, OutputConstruct::value, indents);')
             self.write('}')
@@ -681,38 +1051,42 @@ class ApiDumpGenerator(BaseGenerator):
         self.write('\n//======================= Func Pointer Implementations ======================//\n')
 
         for funcpointer in self.vk.funcPointers.values():
-            self.write('template <ApiDumpFormat Format>')
+            self.write('template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>')
             self.write(f'''void dump_{funcpointer.name}(const {funcpointer.name} object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents, const void* address = nullptr) {{
-                dump_start<Format>(settings, OutputConstruct::value, type_name, var_name, indents, address);
-                dump_address<Format>(settings, &object);
+                dump_start<Format, Features>(settings, OutputConstruct::value, type_name, var_name, indents, address);
+                dump_address<Format, Features>(settings, &object);
                 dump_end<Format>(settings, OutputConstruct::value, indents);
             }}''')
 
+        self.write('\n//======================= Struct Table Value Functions ======================//\n')
+        self.build_value_functions()
+
         self.write('\n//=================== Video Struct and Union Implementations ==================//\n')
         self.generate_structs(self.vk.videoStd.structs, protect)
 
         self.write('\n//====================== Struct and Union Implementations =====================//\n')
         self.generate_structs(self.vk.structs, protect)
+        self.generate_value_functions()
 
         self.write('\n//======================== pNext Chain Implementation =======================//\n')
         self.write('''
-            template <ApiDumpFormat Format>
+            template <ApiDumpFormat Format, ApiDumpFeatures Features>
             void dump_pNext_struct_name(const void* object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents) {
                 if (object == nullptr) {
-                    dump_nullptr<Format>(settings, type_name, var_name, indents);
+                    dump_nullptr<Format, Features>(settings, type_name, var_name, indents);
                     return;
                 }
                 VkBaseInStructure base_struct{};
                 memcpy(&base_struct, object, sizeof(VkBaseInStructure));
                 if (base_struct.sType == VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO || base_struct.sType == VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO) {
                     if (base_struct.pNext != nullptr) {
-                        dump_pNext_struct_name<Format>(base_struct.pNext, settings, type_name, var_name, indents);
+                        dump_pNext_struct_name<Format, Features>(base_struct.pNext, settings, type_name, var_name, indents);
                     } else {
-                        dump_nullptr<Format>(settings, "const void*", "pNext", indents);
+                        dump_nullptr<Format, Features>(settings, "const void*", "pNext", indents);
                     }
                     return;
                 }
-                dump_start<Format>(settings, OutputConstruct::value, type_name, var_name, indents);
+                dump_start<Format, Features>(settings, OutputConstruct::value, type_name, var_name, indents);
                 switch(base_struct.sType) {''')
         for struct in [ x for x in self.vk.structs.values() if not x.union ]:
             protect.add_guard(self, struct.protect)
@@ -730,11 +1104,11 @@ class ApiDumpGenerator(BaseGenerator):
                 dump_end<Format>(settings, OutputConstruct::value, indents);
             }
 
-            template <ApiDumpFormat Format>
+            template <ApiDumpFormat Format, ApiDumpFeatures Features>
             void dump_pNext_trampoline(const void* object, const ApiDumpSettings& settings, const char* type_name, const char *var_name, int indents) {
                 if (object == NULL) {
                     if constexpr (Format == ApiDumpFormat::Html || Format == ApiDumpFormat::Json) {
-                        dump_nullptr<Format>(settings, type_name, var_name, indents);
+                        dump_nullptr<Format, Features>(settings, type_name, var_name, indents);
                     }
                     return;
                 }
@@ -746,20 +1120,20 @@ class ApiDumpGenerator(BaseGenerator):
             if struct.sType is not None:
                 self.write(f'''
                     case {struct.sType}:
-                        dump_{struct.name}<Format>(*reinterpret_cast<const {struct.name}*>(object), settings, (Format == ApiDumpFormat::Json ? "{struct.name}*" : "{struct.name}"), "pNext", indents, reinterpret_cast<const {struct.name}*>(object));
+                        dump_{struct.name}<Format, Features>(*reinterpret_cast<const {struct.name}*>(object), settings, (Format == ApiDumpFormat::Json ? "{struct.name}*" : "{struct.name}"), "pNext", indents, reinterpret_cast<const {struct.name}*>(object));
                         break;''')
         protect.add_guard(self, None)
         self.write('''
                 case VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO: // 47
                 case VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO: // 48
                     if (base_struct.pNext != nullptr) {
-                        dump_pNext_trampoline<Format>(reinterpret_cast<const void*>(base_struct.pNext), settings, type_name, var_name, indents);
+                        dump_pNext_trampoline<Format, Features>(reinterpret_cast<const void*>(base_struct.pNext), settings, type_name, var_name, indents);
                     } else {
-                        dump_nullptr<Format>(settings, "const void*", "pNext", indents);
+                        dump_nullptr<Format, Features>(settings, "const void*", "pNext", indents);
                     }
                     break;
                 default:
-                    dump_start<Format>(settings, OutputConstruct::value, "const void*", "pNext", indents);
+                    dump_start<Format, Features>(settings, OutputConstruct::value, "const void*", "pNext", indents);
                     dump_value<Format>(settings, "UNKNOWN (", (int64_t) (base_struct.sType), ")");
                     dump_end<Format>(settings, OutputConstruct::value, indents);
                     }
@@ -770,10 +1144,18 @@ class ApiDumpGenerator(BaseGenerator):
         for command in [x for x in self.vk.commands.values() if x.name not in FUNCTION_IMPLEMENTATION_IGNORE_LIST]:
             protect.add_guard(self, command.protect)
             self.write(f'''
-                template <ApiDumpFormat Format>
+                template <ApiDumpFormat Format, ApiDumpFeatures Features = kApiDumpFeaturesRuntime>
                 void dump_params_{command.name}(ApiDumpInstance& dump_inst, {command_param_declaration_text(command)}) {{
+                    if constexpr (Format == ApiDumpFormat::Binary) {{
+                        capture_params_{command.name}(dump_inst, {command_param_usage_text(command)});
+                    }} else if constexpr (Format == ApiDumpFormat::Trace) {{
+                        if (dump_inst.settings().showParams<Features>()) {{''')
+            for param in command.params:
+                self.write(f'dump_trace_arg(dump_inst.settings(), "{param.name}", {param.name});')
+            self.write('''}
+                    } else {
                     const ApiDumpSettings& settings(dump_inst.settings());
-                    if(settings.showParams()) {{
+                    if(settings.showParams<Features>()) {
                         dump_pre_params_formatting<Format>(settings);''')
             for param in command.params:
                 if param != command.params[0]:
@@ -788,6 +1170,7 @@ class ApiDumpGenerator(BaseGenerator):
             self.write('''dump_post_params_formatting<Format>(settings);
                     flush(settings);
                 }
+                }
             }''')
         protect.add_guard(self, None)
 
@@ -798,6 +1181,214 @@ class ApiDumpGenerator(BaseGenerator):
                 dump_value_hex<Format>(settings, static_cast<uint64_t>(address));
             }''')
 
+    def generate_capture(self):
+        self.write('#pragma once\n')
+
+        self.write('\n#include "api_dump.h"')
+
+        protect = PlatformGuardHelper()
+        commands = [x for x in self.vk.commands.values() if x.name not in FUNCTION_IMPLEMENTATION_IGNORE_LIST]
+        structs = [x for x in list(self.vk.videoStd.structs.values()) + list(self.vk.structs.values()) if self.struct_needs_capture(x)]
+
+        self.write('\n//============================== Function Ids ===============================//\n')
+        self.write('// Identifies the function of a binary capture record. Not platform guarded, so ids match across platforms.')
+        self.write('enum class ApiDumpFunctionId : uint32_t {')
+        for command in commands:
+            self.write(f'{command.name},')
+        self.write('};')
+        self.write(f'\nstatic const uint32_t kApiDumpFunctionIdCount = {len(commands)};')
+        self.write('\nstatic const char *const kApiDumpFunctionNames[kApiDumpFunctionIdCount] = {')
+        for command in commands:
+            self.write(f'"{command.name}",')
+        self.write('};')
+        self.write('\ninline uint32_t api_dump_function_count() { return kApiDumpFunctionIdCount; }')
+        self.write('inline const char *api_dump_function_name(ApiDumpFunctionId function) { return kApiDumpFunctionNames[static_cast<uint32_t>(function)]; }')
+
+        self.write('\n//========================== Struct Capture Functions ========================//\n')
+        self.write('void capture_pNext(ApiDumpBinaryWriter& writer, const void* object);')
+        for struct in structs:
+            protect.add_guard(self, struct.protect)
+            self.write(f'void capture_{struct.name}(ApiDumpBinaryWriter& writer, const {struct.name}& object);')
+        protect.add_guard(self, None)
+
+        for struct in structs:
+            protect.add_guard(self, struct.protect)
+            self.write(f'\ninline void capture_{struct.name}(ApiDumpBinaryWriter& writer, const {struct.name}& object) {{')
+            for member in struct.members:
+                validity_check = self.get_validity_check(member, struct)
+                parameter_state = self.get_parameter_state(member, struct)
+                if parameter_state is not None:
+                    if validity_check is not None:
+                        self.write(f'if ({validity_check})')
+                    self.write('' + parameter_state)
+            for member in struct.members:
+                self.write_capture_slot(member, struct)
+            self.write('}')
+        protect.add_guard(self, None)
+
+        self.write('\n//======================== pNext Chain Capture =======================//\n')
+        self.write('''
+            inline void capture_pNext(ApiDumpBinaryWriter& writer, const void* object) {
+                if (object == nullptr) {
+                    writer.writeAbsent();
+                    return;
+                }
+                VkBaseInStructure base_struct{};
+                memcpy(&base_struct, object, sizeof(VkBaseInStructure));
+                switch(base_struct.sType) {''')
+        for struct in [x for x in self.vk.structs.values() if not x.union and x.sType is not None]:
+            protect.add_guard(self, struct.protect)
+            self.write(f'''
+                case {struct.sType}:
+                    writer.writeBlock(object, sizeof({struct.name}));
+                    capture_{struct.name}(writer, *reinterpret_cast<const {struct.name}*>(object));
+                    break;''')
+        protect.add_guard(self, None)
+        self.write('''
+                case VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO: // 47
+                case VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO: // 48
+                    writer.writeBlock(object, sizeof(VkBaseInStructure));
+                    capture_pNext(writer, base_struct.pNext);
+                    break;
+                default:
+                    // The dump stops at structures it doesn't know, only its sType is printed
+                    writer.writeBlock(object, sizeof(VkBaseInStructure));
+                    writer.writeAbsent();
+                    break;
+                }
+            }''')
+
+        self.write('\n//========================== Function Capture ===============================//\n')
+        for command in commands:
+            protect.add_guard(self, command.protect)
+            self.write(f'\ninline void capture_params_{command.name}(ApiDumpInstance& dump_inst, {command_param_declaration_text(command)}) {{')
+            self.write('ApiDumpBinaryWriter& writer = binary_call().writer;')
+            for param in command.params:
+                self.write(f'writer.writeValue({param.name});')
+            for param in command.params:
+                parameter_state = self.get_parameter_state(param, command)
+                if parameter_state is not None:
+                    self.write('' + parameter_state)
+                self.write_capture_slot(param, command)
+            self.write(f'dump_binary_record(dump_inst, static_cast<uint32_t>(ApiDumpFunctionId::{command.name}));')
+            self.write('}')
+        protect.add_guard(self, None)
+
+    def generate_decode(self):
+        self.write('#pragma once\n')
+
+        self.write('\n#include "api_dump_implementation.h"')
+
+        protect = PlatformGuardHelper()
+        commands = [x for x in self.vk.commands.values() if x.name not in FUNCTION_IMPLEMENTATION_IGNORE_LIST]
+        structs = [x for x in list(self.vk.videoStd.structs.values()) + list(self.vk.structs.values()) if self.struct_has_slots(x)]
+
+        self.write('\n//========================== Struct Restore Functions ========================//\n')
+        self.write('const void* restore_pNext(ApiDumpBinaryReader& reader, const void* object);')
+        for struct in structs:
+            protect.add_guard(self, struct.protect)
+            self.write(f'void restore_{struct.name}(ApiDumpBinaryReader& reader, {struct.name}& object);')
+        protect.add_guard(self, None)
+
+        for struct in structs:
+            protect.add_guard(self, struct.protect)
+            self.write(f'\ninline void restore_{struct.name}(ApiDumpBinaryReader& reader, {struct.name}& object) {{')
+            for member in struct.members:
+                self.write_restore_slot(member, struct)
+            self.write('}')
+        protect.add_guard(self, None)
+
+        self.write('\n//======================== pNext Chain Restore =======================//\n')
+        self.write('''
+            // Returns the copy of the structure object pointed to, or object itself if it wasn't captured.
+            inline const void* restore_pNext(ApiDumpBinaryReader& reader, const void* object) {
+                size_t size = 0;
+                if (!reader.readPointer(object, &size) || size < sizeof(VkBaseInStructure)) {
+                    return object;
+                }
+                VkBaseOutStructure* base_struct = reinterpret_cast<VkBaseOutStructure*>(const_cast<void*>(object));
+                switch(base_struct->sType) {''')
+        for struct in [x for x in self.vk.structs.values() if not x.union and x.sType is not None]:
+            protect.add_guard(self, struct.protect)
+            self.write(f'''
+                case {struct.sType}:
+                    if (size >= sizeof({struct.name})) {{
+                        restore_{struct.name}(reader, *reinterpret_cast<{struct.name}*>(base_struct));
+                    }}
+                    break;''')
+        protect.add_guard(self, None)
+        self.write('''
+                default:
+                    base_struct->pNext = static_cast<VkBaseOutStructure*>(const_cast<void*>(restore_pNext(reader, base_struct->pNext)));
+                    break;
+                }
+                return object;
+            }''')
+
+        self.write('\n//========================== Function Decode ===============================//\n')
+        for command in commands:
+            protect.add_guard(self, command.protect)
+            self.write('\ntemplate <ApiDumpFormat Format>')
+            self.write(f'void decode_{command.name}(ApiDumpInstance& dump_inst, ApiDumpBinaryReader& reader, const ApiDumpBinaryRecordHeader& header) {{')
+            if command.returnType != 'void':
+                self.write(f'{command.returnType} result{{}};')
+                self.write('reader.readValue(result);')
+            for param in command.params:
+                if len(param.fixedSizeArray) > 0:
+                    self.write(f'{"const " if param.const else ""}{param.type}* {param.name}{{}};')
+                else:
+                    declaration = param.cDeclaration.strip()
+                    if not param.pointer and declaration.startswith('const '):
+                        declaration = declaration[len('const '):]
+                    self.write(f'{declaration}{{}};')
+                self.write(f'reader.readValue({param.name});')
+            for param in command.params:
+                self.write_restore_slot(param, command)
+            if command.name in ['vkDebugMarkerSetObjectNameEXT', 'vkSetDebugUtilsObjectNameEXT']:
+                self.write('dump_inst.update_object_name_map(pNameInfo);')
+            if command.name in TRACKED_STATE:
+                self.write('' + TRACKED_STATE[command.name])
+            self.write(f'dump_function_head(dump_inst, "{command.name}", "{command_param_usage_text(command)}", "{command.returnType}", &header);')
+            self.write('if (dump_inst.shouldDumpOutput()) {')
+            if command.returnType != 'void':
+                return_type = self.get_unaliased_type(command.returnType)
+                if return_type in self.vulkan_defined_types or return_type == 'VkDeviceAddress':
+                    self.write(f'dump_return_value<Format>(dump_inst.settings(), "{command.returnType}", result, dump_return_value_{command.returnType}<Format>);')
+                else:
+                    self.write(f'dump_return_value<Format>(dump_inst.settings(), "{command.returnType}", result);')
+            self.write(f'''dump_pre_function_formatting<Format>(dump_inst.settings());
+                dump_params_{command.name}<Format>(dump_inst, {command_param_usage_text(command)});
+                dump_post_function_formatting<Format>(dump_inst.settings());''')
+            if command.name == 'vkQueuePresentKHR':
+                self.write('dump_frame_end_marker<Format>(dump_inst);')
+            self.write('''flush(dump_inst.settings());
+            }''')
+            erase_object_names = self.erase_object_names_text(command, 'dump_inst')
+            if erase_object_names:
+                self.write(erase_object_names)
+            if command.name == 'vkQueuePresentKHR':
+                self.write('dump_inst.nextFrame();')
+            self.write('}')
+        protect.add_guard(self, None)
+
+        self.write('''
+            // Dumps a binary capture record in Format. Returns false if the record is of a function this decoder doesn't know.
+            template <ApiDumpFormat Format>
+            bool decode_record(ApiDumpInstance& dump_inst, ApiDumpBinaryReader& reader, const ApiDumpBinaryRecordHeader& header) {
+                switch (static_cast<ApiDumpFunctionId>(header.function_id)) {''')
+        for command in commands:
+            protect.add_guard(self, command.protect)
+            self.write(f'''
+                case ApiDumpFunctionId::{command.name}:
+                    decode_{command.name}<Format>(dump_inst, reader, header);
+                    return true;''')
+        protect.add_guard(self, None)
+        self.write('''
+                default:
+                    return false;
+                }
+            }''')
+
     def build_alias_map(self):
         for handle in self.vk.handles.values():
             for alias in handle.aliases:
@@ -861,6 +1452,25 @@ class ApiDumpGenerator(BaseGenerator):
             if command.returnType != 'void' :
                 self.return_types.add(command.returnType)
 
+    # Code removing the names of the objects a vkDestroy* or vkFree* command destroys, once the call is dumped, as their handles
+    # may be reused. Empty for other commands.
+    def erase_object_names_text(self, command, dump_inst):
+        if not command.name.startswith(('vkDestroy', 'vkFree')):
+            return ''
+        handle_params = [p for p in command.params if p.type in self.vk.handles]
+        arrays = [p for p in handle_params if p.pointer and p.length is not None]
+        if len(arrays) > 0:
+            array = arrays[0]
+            return (f'if ({array.name} != nullptr) {{\n'
+                    f'    for (uint32_t i = 0; i < {array.length}; ++i) {{\n'
+                    f'        {dump_inst}.erase_object_name((uint64_t){array.name}[i]);\n'
+                    '    }\n'
+                    '}')
+        handles = [p for p in handle_params if not p.pointer]
+        if len(handles) == 0:
+            return ''
+        return f'{dump_inst}.erase_object_name((uint64_t){handles[-1].name});'
+
     def get_unaliased_type(self, type_to_check):
         if type_to_check in self.aliases and self.aliases[type_to_check] is not None:
             return self.aliases[type_to_check]
@@ -904,6 +1514,202 @@ class ApiDumpGenerator(BaseGenerator):
 
         return True
 
+    def get_struct(self, type_name):
+        name = self.get_unaliased_type(type_name)
+        if name in self.vk.structs:
+            return self.vk.structs[name]
+        if name in self.vk.videoStd.structs:
+            return self.vk.videoStd.structs[name]
+        return None
+
+    # Returns how the dump functions follow var, mirroring write_value(), or None if they only print its value. Every kind is
+    # captured as one slot in the binary format.
+    def get_capture_kind(self, var, parent):
+        if var.name == 'pNext' and var.fullType in ['void*', 'const void*']:
+            return 'pNext'
+        # Fixed length array's passed as parameters are pointers, for members they are part of the structure
+        if isinstance(parent, Command) and len(var.fixedSizeArray) > 0:
+            return 'fixed_param'
+        element = self.get_struct(var.type)
+        if self.get_is_array(var):
+            if len(var.fixedSizeArray) > 0:
+                if len(var.fixedSizeArray) == 1 and element is not None and self.struct_needs_capture(element):
+                    return 'fixed_array'
+                return None
+            if var.name == 'pCode':
+                return 'code'
+            if var.type == 'char' and var.fullType.count('*') > 1:
+                return 'string_array'
+            if var.fullType.count('*') > 1 and var.type not in ['void', 'char'] and self.get_unaliased_type(var.type) in self.vulkan_defined_types:
+                return 'pointer_array'
+            return 'array'
+        if var.pointer:
+            if var.type == 'char':
+                return 'string'
+            if var.type not in self.only_use_as_pointer_types and var.type not in self.vk.funcPointers.keys() and var.type != 'void':
+                return 'pointer'
+            return None
+        if element is not None and self.struct_needs_capture(element):
+            return 'struct'
+        return None
+
+    def struct_has_slots(self, struct):
+        if struct.name not in self.capture_slots:
+            self.capture_slots[struct.name] = any(self.get_capture_kind(x, struct) is not None for x in struct.members)
+        return self.capture_slots[struct.name]
+
+    # Structures with parameter state need capturing too, it can change how the following members are captured
+    def struct_needs_capture(self, struct):
+        return self.struct_has_slots(struct) or any(self.get_parameter_state(x, struct) is not None for x in struct.members)
+
+    def write_capture_slot(self, var, parent):
+        kind = self.get_capture_kind(var, parent)
+        if kind is None:
+            return
+        value = f'{"object." if isinstance(parent, Struct) else ""}{var.name}'
+        element = self.get_struct(var.type)
+        nested = element is not None and self.struct_needs_capture(element)
+        validity_check = self.get_validity_check(var, parent)
+        if validity_check is not None:
+            self.write(f'if ({validity_check}) {{')
+
+        if kind == 'pNext':
+            self.write(f'capture_pNext(writer, {value});')
+        elif kind == 'struct':
+            self.write('writer.writeFlag(true);')
+            self.write(f'capture_{element.name}(writer, {value});')
+        elif kind == 'fixed_array':
+            fixed_array_len = get_fixed_array_length(var.fixedSizeArray[0], var, parent)
+            self.write(f'''writer.writeFlag(true);
+                writer.writeValue<uint64_t>({fixed_array_len});
+                for (size_t i = 0; i < static_cast<size_t>({fixed_array_len}); ++i) {{
+                    capture_{element.name}(writer, {value}[i]);
+                }}''')
+        else:
+            self.write(f'if ({value} != nullptr) {{')
+            if kind == 'string':
+                self.write(f'writer.writeString({value});')
+            elif kind == 'pointer':
+                self.write(f'writer.writeBlock({value}, sizeof(*{value}));')
+                if nested:
+                    self.write(f'capture_{element.name}(writer, *{value});')
+            elif kind == 'fixed_param':
+                self.write(f'writer.writeBlock({value}, sizeof(*{value}) * {"*".join(var.fixedSizeArray)});')
+            elif kind == 'code':
+                # The length of VkShaderModuleCreateInfo::pCode is in words, the one of VkShaderCreateInfoEXT::pCode in bytes
+                code_size = f'{"object." if isinstance(parent, Struct) else ""}{var.length}'
+                if var.type != 'void':
+                    code_size = f'({code_size}) * sizeof(*{value})'
+                self.write(f'writer.writeBlock({value}, static_cast<size_t>({code_size}));')
+            else:
+                self.write(f'''const size_t slot_count = static_cast<size_t>({get_array_length(var, parent)});
+                    writer.writeBlock({value}, slot_count * sizeof(*{value}));''')
+                if kind == 'string_array':
+                    self.write(f'''for (size_t i = 0; i < slot_count; ++i) {{
+                            if ({value}[i] != nullptr) {{
+                                writer.writeString({value}[i]);
+                            }} else {{
+                                writer.writeAbsent();
+                            }}
+                        }}''')
+                elif kind == 'pointer_array':
+                    self.write(f'''for (size_t i = 0; i < slot_count; ++i) {{
+                            if ({value}[i] != nullptr) {{
+                                writer.writeBlock({value}[i], sizeof(*{value}[i]));''')
+                    if nested:
+                        self.write(f'capture_{element.name}(writer, *{value}[i]);')
+                    self.write('''} else {
+                                writer.writeAbsent();
+                            }
+                        }''')
+                elif nested:
+                    self.write(f'''for (size_t i = 0; i < slot_count; ++i) {{
+                            capture_{element.name}(writer, {value}[i]);
+                        }}''')
+            self.write('} else {')
+            self.write('writer.writeAbsent();')
+            self.write('}')
+
+        if validity_check is not None:
+            self.write('} else {')
+            self.write('writer.writeFlag(false);')
+            self.write('}')
+
+    # Reads back the slot written by write_capture_slot(), pointing var at the copies of the captured objects.
+    def write_restore_slot(self, var, parent):
+        kind = self.get_capture_kind(var, parent)
+        if kind is None:
+            return
+        value = f'{"object." if isinstance(parent, Struct) else ""}{var.name}'
+        element = self.get_struct(var.type)
+        nested = element is not None and self.struct_has_slots(element)
+        const = 'const ' if var.const else ''
+
+        if kind == 'pNext':
+            self.write(f'{value} = const_cast<{var.fullType}>(restore_pNext(reader, {value}));')
+        elif kind == 'struct':
+            if nested:
+                self.write(f'''if (reader.readFlag()) {{
+                        restore_{element.name}(reader, {value});
+                    }}''')
+            else:
+                self.write('reader.readFlag();')
+        elif kind == 'fixed_array':
+            self.write('''if (reader.readFlag()) {
+                    uint64_t slot_count = 0;
+                    reader.readValue(slot_count);''')
+            if nested:
+                self.write(f'''for (uint64_t i = 0; i < slot_count && i < {var.fixedSizeArray[0]}; ++i) {{
+                        restore_{element.name}(reader, {value}[i]);
+                    }}''')
+            self.write('}')
+        elif kind == 'pointer':
+            if nested:
+                self.write(f'''if (reader.readPointer({value})) {{
+                        restore_{element.name}(reader, *const_cast<{element.name}*>({value}));
+                    }}''')
+            else:
+                self.write(f'reader.readPointer({value});')
+        elif kind in ['string', 'fixed_param', 'code']:
+            self.write(f'reader.readPointer({value});')
+        elif kind == 'string_array':
+            self.write(f'''{{
+                    size_t slot_size = 0;
+                    if (reader.readPointer({value}, &slot_size)) {{
+                        const char** slot_strings = const_cast<const char**>({value});
+                        for (size_t i = 0; i < slot_size / sizeof(const char*); ++i) {{
+                            reader.readPointer(slot_strings[i]);
+                        }}
+                    }}
+                }}''')
+        elif kind == 'pointer_array':
+            self.write(f'''{{
+                    size_t slot_size = 0;
+                    if (reader.readPointer({value}, &slot_size)) {{
+                        {const}{var.type}** slot_elements = const_cast<{const}{var.type}**>({value});
+                        for (size_t i = 0; i < slot_size / sizeof({const}{var.type}*); ++i) {{''')
+            if nested:
+                self.write(f'''if (reader.readPointer(slot_elements[i])) {{
+                        restore_{element.name}(reader, *const_cast<{element.name}*>(slot_elements[i]));
+                    }}''')
+            else:
+                self.write('reader.readPointer(slot_elements[i]);')
+            self.write('}')
+            self.write('}')
+            self.write('}')
+        elif nested:
+            self.write(f'''{{
+                    size_t slot_size = 0;
+                    if (reader.readPointer({value}, &slot_size)) {{
+                        {element.name}* slot_elements = const_cast<{element.name}*>({value});
+                        for (size_t i = 0; i < slot_size / sizeof({element.name}); ++i) {{
+                            restore_{element.name}(reader, slot_elements[i]);
+                        }}
+                    }}
+                }}''')
+        else:
+            self.write(f'reader.readPointer({value});')
+
     def write_value(self, var, parent):
         custom_fullType = get_fulltype(var)
         custom_type = get_type(var)
@@ -916,66 +1722,68 @@ class ApiDumpGenerator(BaseGenerator):
 
         value = f'{object_access}{var.name}'
         if self.get_is_array(var):
-            element_type = f'dump_type<Format, {custom_type}>'
+            element_type = f'dump_type<Format, Features, {custom_type}>'
             if var.type == 'char':
-                element_type = 'dump_char<Format>'
+                element_type = 'dump_char<Format, Features>'
             if custom_type == 'uint8_t': # ostream << treats uint8_t as char which we dont want
-                element_type = 'dump_type<Format, uint32_t>'
+                element_type = 'dump_type<Format, Features, uint32_t>'
             elif custom_type == 'int8_t': # ostream << treats int8_t as char which we dont want
-                element_type = 'dump_type<Format, int32_t>'
+                element_type = 'dump_type<Format, Features, int32_t>'
 
             elif call_type in self.vulkan_defined_types:
-                element_type = f'dump_{call_type}<Format>'
+                element_type = f'dump_{call_type}<Format, Features>'
 
             if parent.name in ['VkShaderModuleCreateInfo', 'VkShaderCreateInfoEXT'] and var.name == 'pCode':
                 array_len = f'{object_access}{var.length}'
                 self.write(f'''
-                    if(settings.showShader()) {{
-                        dump_spirv<Format>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", {indent});
+                    if(settings.saveShaders()) {{
+                        dump_saved_spirv<Format, Features>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", {indent});
+                    }} else if(settings.showShader()) {{
+                        dump_spirv<Format, Features>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", {indent});
                     }} else {{
-                        dump_special<Format>("SHADER DATA", settings, "{var.fullType}", "{var.name}", {indent});
+                        dump_special<Format, Features>("SHADER DATA", settings, "{var.fullType}", "{var.name}", {indent});
                     }}''')
 
             elif len(var.fixedSizeArray) > 2:
                 raise RuntimeError("Unhandled fixed array dimentionality")
             elif len(var.fixedSizeArray) == 2:
-                self.write(f'dump_double_array<Format>({value}, {var.fixedSizeArray[0]},  {var.fixedSizeArray[1]}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
+                self.write(f'dump_double_array<Format, Features>({value}, {var.fixedSizeArray[0]},  {var.fixedSizeArray[1]}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
 
             elif len(var.fixedSizeArray) == 1 and isinstance(parent, Struct): # Fixed length array's passed as parameters are treated as void*, so only match when printing members
                 fixed_array_len = get_fixed_array_length(var.fixedSizeArray[0], var, parent)
-                self.write(f'dump_single_array<Format>({value}, {fixed_array_len}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
+                self.write(f'dump_single_array<Format, Features>({value}, {fixed_array_len}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
 
             else:
                 array_len = get_array_length(var, parent)
                 if var.fullType.count('*') > 1 and var.type not in ['void', 'char'] and (call_type in self.vulkan_defined_types):
-                    self.write(f'dump_double_pointer_array<Format>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
+                    self.write(f'dump_double_pointer_array<Format, Features>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
                 else:
-                    self.write(f'dump_pointer_array<Format>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
+                    self.write(f'dump_pointer_array<Format, Features>({value}, {array_len}, settings, "{custom_fullType}", "{var.name}", "{custom_type}", {indent}, {element_type});')
         else:
             if var.pointer and var.type not in self.only_use_as_pointer_types and var.type not in self.vk.funcPointers.keys() and var.type not in ['void', 'char'] and not (var.name == 'pNext' and var.fullType in ['void*', 'const void*']):
-                pointer_type = f'dump_type<Format, {custom_type}>'
+                pointer_type = f'dump_type<Format, Features, {custom_type}>'
                 if (call_type in self.vulkan_defined_types):
-                    pointer_type = f'dump_{call_type}<Format>'
+                    pointer_type = f'dump_{call_type}<Format, Features>'
 
-                self.write(f'dump_pointer<Format>({value}, settings, "{custom_fullType}", "{var.name}", {indent}, {pointer_type});')
+                self.write(f'dump_pointer<Format, Features>({value}, settings, "{custom_fullType}", "{var.name}", {indent}, {pointer_type});')
             else:
-                value_type = f'dump_type<Format, {var.fullType}>'
+                value_type = f'dump_type<Format, Features, {var.fullType}>'
                 if var.name == 'apiVersion':
-                    value_type = 'dump_api_version<Format>'
+                    value_type = 'dump_api_version<Format, Features>'
                 elif var.name == 'pNext' and var.fullType in ['void*', 'const void*']:
-                    value_type = 'dump_pNext<Format>'
+                    value_type = 'dump_pNext<Format, Features>'
                 elif var.type == 'char':
-                    value_type = 'dump_char<Format>'
+                    value_type = 'dump_char<Format, Features>'
                 elif var.fullType == 'VkDeviceAddress':
-                    value_type = f'dump_type_hex<Format, {var.fullType}>'
+                    value_type = f'dump_type_hex<Format, Features, {var.fullType}>'
                 elif var.fullType == 'uint8_t': # ostream << treats uint8_t as char which we dont want
-                    value_type = 'dump_type<Format, uint32_t>'
+                    value_type = 'dump_type<Format, Features, uint32_t>'
                 elif var.fullType == 'int8_t': # ostream << treats int8_t as char which we dont want
-                    value_type = 'dump_type<Format, int32_t>'
+                    value_type = 'dump_type<Format, Features, int32_t>'
                 elif call_type in self.vulkan_defined_types:
-                    value_type = f'dump_{call_type}<Format>'
+                    value_type = f'dump_{call_type}<Format, Features>'
                 elif var.type in TREAT_AS_POINTERS and TREAT_AS_POINTERS[var.type] == var.name:
-                    value_type = 'dump_uint64_t_as_pointer<Format>'
+                    value_type = 'dump_uint64_t_as_pointer<Format, Features>'
                 self.write(f'{value_type}({value}, settings, "{custom_fullType}", "{var.name}", {indent});')
 
     def write_enum_contents(self, enum):
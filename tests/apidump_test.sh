@@ -7,6 +7,9 @@
 # script requires a path to the Vulkan-Tools build directory so that it can locate
 # vulkaninfo and the mock ICD. The path can be defined using the environment variable
 # VULKAN_TOOLS_BUILD_DIR or using the command-line argument -t or --tools.
+# The script then captures the same run in the binary format, decodes it with vkapidump_decode, and compares the result with
+# the text the layer writes itself. The decoder is looked for in the layersvt directory of this build, or can be given using
+# the command-line argument -d or --decoder.
 
 # Track unrecognized arguments.
 UNRECOGNIZED=()
@@ -21,6 +24,11 @@ do
       shift
       shift
       ;;
+      -d|--decoder)
+      VKAPIDUMP_DECODE="$2"
+      shift
+      shift
+      ;;
       *)
       UNRECOGNIZED+=("$1")
       shift
@@ -83,6 +91,42 @@ then
 fi
 
 rm apidump_file.tmp
+
+# Round trip of a binary capture. Addresses and dispatchable handles change from one run to the next, so they are left out of
+# the comparison.
+if [ -z ${VKAPIDUMP_DECODE+x} ]; then
+   VKAPIDUMP_DECODE="../layersvt/vkapidump_decode"
+fi
+
+printf "$GREEN[ RUN      ]$NC $0 binary round trip\n"
+VK_ICD_FILENAMES="$VULKAN_TOOLS_BUILD_DIR/icd/VkICD_mock_icd.json" \
+    VK_INSTANCE_LAYERS=VK_LAYER_LUNARG_api_dump \
+    VK_APIDUMP_NO_ADDR=true \
+    VK_APIDUMP_LOG_FILENAME=apidump_direct.txt \
+    "$VULKANINFO" --show-formats > /dev/null
+VK_ICD_FILENAMES="$VULKAN_TOOLS_BUILD_DIR/icd/VkICD_mock_icd.json" \
+    VK_INSTANCE_LAYERS=VK_LAYER_LUNARG_api_dump \
+    VK_APIDUMP_NO_ADDR=true \
+    VK_APIDUMP_OUTPUT_FORMAT=binary \
+    VK_APIDUMP_LOG_FILENAME=apidump_capture.bin \
+    "$VULKANINFO" --show-formats > /dev/null
+VK_APIDUMP_NO_ADDR=true "$VKAPIDUMP_DECODE" --format text --output apidump_decoded.txt apidump_capture.bin
+decode_result=$?
+
+sed -E 's/0x[0-9a-fA-F]+/0x0/g' apidump_direct.txt > apidump_direct.tmp 2> /dev/null
+sed -E 's/0x[0-9a-fA-F]+/0x0/g' apidump_decoded.txt > apidump_decoded.tmp 2> /dev/null
+if (( $decode_result == 0 )) && [ -s apidump_direct.tmp ] && diff -u apidump_direct.tmp apidump_decoded.tmp > apidump_diff.tmp
+then
+    printf "$GREEN[  PASSED  ]$NC $0 binary round trip\n"
+else
+    head -n 50 apidump_diff.tmp 2> /dev/null
+    printf "$RED[  FAILED  ]$NC $0 binary round trip\n"
+    rm -f apidump_direct.txt apidump_capture.bin apidump_decoded.txt apidump_direct.tmp apidump_decoded.tmp apidump_diff.tmp
+    popd
+    exit 1
+fi
+
+rm -f apidump_direct.txt apidump_capture.bin apidump_decoded.txt apidump_direct.tmp apidump_decoded.tmp apidump_diff.tmp
 popd
 
 exit 0